@@ -0,0 +1,140 @@
+#include "append_hash.h"
+#include "hash_factory.h"
+#include "hash_config.h"
+#include "hash_state.h"
+#include "file_io.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t AppendHasher::ANCHOR_SIZE;
+
+namespace {
+
+// The anchor is compared by digest so the sidecar stays small
+const char* const ANCHOR_ALGORITHM = "SHA256";
+
+struct Sidecar {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t offset;
+    std::vector<uint8_t> anchor;
+    std::vector<uint8_t> state;
+};
+
+// Digest of the bytes just before offset
+std::vector<uint8_t> anchorDigest(int fd, uint64_t offset) {
+    const size_t length = static_cast<size_t>(std::min<uint64_t>(offset, AppendHasher::ANCHOR_SIZE));
+    std::vector<uint8_t> bytes(length);
+    if (FileIO::readAt(fd, bytes.data(), length, static_cast<off_t>(offset - length)) != length) {
+        return std::vector<uint8_t>();
+    }
+
+    auto hasher = HashFactory::createHash(ANCHOR_ALGORITHM);
+    hasher->update(bytes.data(), bytes.size());
+    hasher->finalize();
+    std::vector<uint8_t> digest(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return digest;
+}
+
+// A missing or unreadable sidecar simply means a full hash
+bool loadSidecar(const std::string& path, const std::string& algorithm, Sidecar& sidecar) {
+    std::vector<uint8_t> data;
+    if (!FileIO::readFile(path, data)) {
+        return false;
+    }
+    try {
+        HashState::Reader reader(data.data(), data.size(), algorithm);
+        sidecar.device = reader.getU64();
+        sidecar.inode = reader.getU64();
+        sidecar.offset = reader.getU64();
+        sidecar.anchor = reader.getBlob();
+        sidecar.state = reader.getBlob();
+        reader.finish();
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    return true;
+}
+
+void saveSidecar(const std::string& path, const std::string& algorithm, const Sidecar& sidecar) {
+    HashState::Writer writer(algorithm);
+    writer.putU64(sidecar.device);
+    writer.putU64(sidecar.inode);
+    writer.putU64(sidecar.offset);
+    writer.putBlob(sidecar.anchor);
+    writer.putBlob(sidecar.state);
+    FileIO::replaceFile(path, writer.take());
+}
+
+} // namespace
+
+AppendHasher::AppendHasher(const std::string& algorithm, const std::string& statePath)
+    : algorithm_(algorithm), statePath_(statePath), resumedOffset_(0), bytesHashed_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    if (statePath.empty()) {
+        throw std::invalid_argument("State file path cannot be empty");
+    }
+}
+
+void AppendHasher::processFile(int fd) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        throw std::runtime_error("Append mode requires a regular file");
+    }
+
+    auto hasher = HashFactory::createHash(algorithm_);
+    const std::string name = hasher->getAlgorithmName();
+    uint64_t offset = 0;
+
+    Sidecar saved;
+    if (loadSidecar(statePath_, name, saved) &&
+        saved.device == static_cast<uint64_t>(info.st_dev) &&
+        saved.inode == static_cast<uint64_t>(info.st_ino) &&
+        saved.offset <= static_cast<uint64_t>(info.st_size) &&
+        saved.anchor == anchorDigest(fd, saved.offset)) {
+        try {
+            hasher->importState(saved.state.data(), saved.state.size());
+            offset = saved.offset;
+        } catch (const std::invalid_argument&) {
+            hasher->reset();
+        }
+    }
+    resumedOffset_ = offset;
+
+    std::vector<uint8_t> buffer(HashConfig::DEFAULT_BUFFER_SIZE);
+    uint64_t end = offset;
+    for (;;) {
+        size_t n = FileIO::readAt(fd, buffer.data(), buffer.size(), static_cast<off_t>(end));
+        if (n == 0) {
+            break;
+        }
+        hasher->update(buffer.data(), n);
+        end += n;
+    }
+    bytesHashed_ = end - offset;
+
+    // Save the state before padding so the next run can keep appending
+    Sidecar current;
+    current.device = static_cast<uint64_t>(info.st_dev);
+    current.inode = static_cast<uint64_t>(info.st_ino);
+    current.offset = end;
+    current.anchor = anchorDigest(fd, end);
+    current.state = hasher->exportState();
+    saveSidecar(statePath_, name, current);
+
+    hasher->finalize();
+    digest_ = hasher->getHash();
+}
+
+std::string AppendHasher::getHash() const {
+    if (digest_.empty()) {
+        throw std::runtime_error("Cannot get hash before processing a file");
+    }
+    return digest_;
+}
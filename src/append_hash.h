@@ -0,0 +1,62 @@
+#ifndef APPEND_HASH_H
+#define APPEND_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Incremental whole-file digests of append-only files
+ *
+ * After each run the unfinalized hasher state and the hashed length are saved
+ * to a sidecar file. The next run resumes from that state and reads only the
+ * bytes appended since, provided the file is still the same one: same device
+ * and inode, not shorter than the saved length, and with the same bytes just
+ * before the saved offset. Otherwise the file is hashed from the start.
+ */
+class AppendHasher {
+public:
+    // Bytes before the saved offset that are re-read to detect rewrites
+    static constexpr size_t ANCHOR_SIZE = 4096;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param statePath Sidecar file holding the saved state
+     * @throws std::invalid_argument on unsupported algorithm or empty path
+     */
+    AppendHasher(const std::string& algorithm, const std::string& statePath);
+
+    /**
+     * Hash a regular file, resuming from the sidecar when it matches, then
+     * save the new state to the sidecar
+     * @param fd Open, readable file descriptor
+     * @throws std::runtime_error if fd is not a regular file or on I/O errors
+     */
+    void processFile(int fd);
+
+    /**
+     * Get the digest of the whole file
+     * @throws std::runtime_error if no file has been processed
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the offset the last run resumed from (0 for a full hash)
+     */
+    uint64_t getResumedOffset() const { return resumedOffset_; }
+
+    /**
+     * Get the number of bytes read and hashed by the last run
+     */
+    uint64_t getBytesHashed() const { return bytesHashed_; }
+
+private:
+    std::string algorithm_;
+    std::string statePath_;
+    uint64_t resumedOffset_;
+    uint64_t bytesHashed_;
+    std::string digest_;
+};
+
+#endif // APPEND_HASH_H
@@ -0,0 +1,89 @@
+#include "batch_hash.h"
+#include "hash_dispatch.h"
+#include "multi_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+// Inputs are length-sorted within windows of this many messages so the
+// index array can live on the stack
+constexpr size_t SORT_WINDOW = 64;
+
+// Hash up to LANES messages from the initial state, picked out of inputs by order
+template <typename Kernel>
+void hashLanes(const typename Kernel::Word* initialState, size_t hashSize,
+               const HashSpan* inputs, const size_t* order, size_t lanes, uint8_t* digests) {
+    typename Kernel::Word finalStates[Kernel::LANES][8];
+    const uint8_t* messages[Kernel::LANES] = {};
+    size_t lengths[Kernel::LANES] = {};
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        messages[lane] = inputs[order[lane]].data;
+        lengths[lane] = inputs[order[lane]].length;
+    }
+    MultiBuffer::hashLanes<Kernel>(initialState, 0, messages, lengths, lanes, finalStates);
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        MultiBuffer::storeBigEndian(finalStates[lane], digests + order[lane] * hashSize, hashSize);
+    }
+}
+
+template <typename H>
+typename std::enable_if<!std::is_void<typename MultiBuffer::KernelFor<H>::type>::value>::type
+hashAll(const HashSpan* inputs, size_t count, uint8_t* digests) {
+    typedef typename MultiBuffer::KernelFor<H>::type Kernel;
+    const H prototype;
+    const size_t hashSize = prototype.getHashSize();
+
+    size_t order[SORT_WINDOW];
+    for (size_t base = 0; base < count; base += SORT_WINDOW) {
+        const size_t window = std::min(SORT_WINDOW, count - base);
+
+        // Insertion sort by length; windows are small and keys often arrive presorted
+        for (size_t i = 0; i < window; ++i) {
+            size_t j = i;
+            while (j > 0 && inputs[order[j - 1]].length > inputs[base + i].length) {
+                order[j] = order[j - 1];
+                --j;
+            }
+            order[j] = base + i;
+        }
+
+        for (size_t offset = 0; offset < window; offset += Kernel::LANES) {
+            const size_t lanes = std::min(static_cast<size_t>(Kernel::LANES), window - offset);
+            hashLanes<Kernel>(prototype.getInitialState(), hashSize, inputs, order + offset, lanes, digests);
+        }
+    }
+}
+
+template <typename H>
+typename std::enable_if<std::is_void<typename MultiBuffer::KernelFor<H>::type>::value>::type
+hashAll(const HashSpan* inputs, size_t count, uint8_t* digests) {
+    H hasher;
+    const size_t hashSize = hasher.getHashSize();
+    for (size_t i = 0; i < count; ++i) {
+        hasher.reset();
+        hasher.update(inputs[i].data, inputs[i].length);
+        hasher.finalize();
+        hasher.getDigest(digests + i * hashSize);
+    }
+}
+
+} // namespace
+
+void hashBatch(const std::string& algorithm, const HashSpan* inputs, size_t count, uint8_t* digests) {
+    if (count > 0 && (inputs == nullptr || digests == nullptr)) {
+        throw std::invalid_argument("Batch inputs and digest output must not be null");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (inputs[i].data == nullptr && inputs[i].length > 0) {
+            throw std::invalid_argument("Batch input data must not be null");
+        }
+    }
+
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        hashAll<H>(inputs, count, digests);
+    });
+}
@@ -0,0 +1,32 @@
+#ifndef BATCH_HASH_H
+#define BATCH_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * A view of one in-memory message
+ */
+struct HashSpan {
+    const uint8_t* data;
+    size_t length;
+};
+
+/**
+ * Hash many independent in-memory messages in one call
+ *
+ * SHA-2 family inputs are grouped by length so that similar messages share
+ * multi-buffer lanes and finish on the same block; other algorithms run one
+ * stack-allocated hasher per message. No heap memory is allocated.
+ *
+ * @param algorithm Algorithm name (as accepted by HashFactory)
+ * @param inputs Array of count messages
+ * @param count Number of messages
+ * @param digests Output of count * hash size bytes; digest i is written at
+ *                offset i * hash size, in input order
+ * @throws std::invalid_argument for unknown algorithms or null arguments
+ */
+void hashBatch(const std::string& algorithm, const HashSpan* inputs, size_t count, uint8_t* digests);
+
+#endif // BATCH_HASH_H
@@ -1,7 +1,5 @@
 #include "blake256.h"
 #include "hash_constants.h"
-#include <iomanip>
-#include <sstream>
 #include <cstring>
 
 // BLAKE256 constants - from the original BLAKE specification
@@ -251,17 +249,30 @@ void BLAKE256::addPadding() {
     processBlock(buffer);
 }
 
-std::string BLAKE256::getHash() const {
+void BLAKE256::getDigest(uint8_t* digest) const {
     if (!finalized) {
         throw std::runtime_error("Cannot get hash before finalization. Call finalize() first.");
     }
     
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
     for (int i = 0; i < 8; ++i) {
-        ss << std::setw(8) << h[i];
+        U32TO8_BIG(digest + i * 4, h[i]);
     }
-    
-    return ss.str();
+}
+
+std::unique_ptr<HashInterface> BLAKE256::clone() const {
+    return std::unique_ptr<HashInterface>(new BLAKE256(*this));
+}
+
+void BLAKE256::saveState(HashState::Writer& writer) const {
+    writer.putWords(h, 8);
+    writer.putWords(s, 4);
+    writer.putWords(t, 2);
+    writer.putU8(static_cast<uint8_t>(nullt));
+}
+
+void BLAKE256::loadState(HashState::Reader& reader) {
+    reader.getWords(h, 8);
+    reader.getWords(s, 4);
+    reader.getWords(t, 2);
+    nullt = reader.getU8();
 }
@@ -13,10 +13,11 @@ public:
     // HashBase implementation
     void reset() override;
     void update(const uint8_t* data, size_t length) override;  // Override to handle BLAKE counter
-    std::string getHash() const override;
+    void getDigest(uint8_t* digest) const override;
     size_t getBlockSize() const override { return HASH_CONSTANTS::BLAKE256_BLOCK_SIZE; }
     size_t getHashSize() const override { return HASH_CONSTANTS::BLAKE256_HASH_SIZE; }
     std::string getAlgorithmName() const override { return "BLAKE256"; }
+    std::unique_ptr<HashInterface> clone() const override;
 
 private:
     // BLAKE256 state (8 32-bit words + 4 salt words + 2 counter words)
@@ -28,6 +29,8 @@ private:
     // Internal methods
     void processBlock(const uint8_t* block) override;
     void addPadding() override;
+    void saveState(HashState::Writer& writer) const override;
+    void loadState(HashState::Reader& reader) override;
     
     // BLAKE-specific functions
     void G(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d, uint32_t x, uint32_t y) const;
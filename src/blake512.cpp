@@ -1,7 +1,5 @@
 #include "blake512.h"
 #include "hash_constants.h"
-#include <iomanip>
-#include <sstream>
 #include <cstring>
 
 // BLAKE512 constants
@@ -214,17 +212,31 @@ void BLAKE512::addPadding() {
     compress(words, true);
 }
 
-std::string BLAKE512::getHash() const {
+void BLAKE512::getDigest(uint8_t* digest) const {
     if (!finalized) {
         throw std::runtime_error("Cannot get hash before finalization. Call finalize() first.");
     }
     
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
+    // BLAKE512 output is big-endian
     for (int i = 0; i < 8; ++i) {
-        ss << std::setw(16) << h[i];
+        for (int j = 0; j < 8; ++j) {
+            digest[i * 8 + j] = static_cast<uint8_t>(h[i] >> (56 - j * 8));
+        }
     }
-    
-    return ss.str();
+}
+
+std::unique_ptr<HashInterface> BLAKE512::clone() const {
+    return std::unique_ptr<HashInterface>(new BLAKE512(*this));
+}
+
+void BLAKE512::saveState(HashState::Writer& writer) const {
+    writer.putWords(h, 8);
+    writer.putWords(s, 4);
+    writer.putWords(t, 2);
+}
+
+void BLAKE512::loadState(HashState::Reader& reader) {
+    reader.getWords(h, 8);
+    reader.getWords(s, 4);
+    reader.getWords(t, 2);
 }
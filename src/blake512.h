@@ -12,10 +12,11 @@ public:
     
     // HashBase implementation
     void reset() override;
-    std::string getHash() const override;
+    void getDigest(uint8_t* digest) const override;
     size_t getBlockSize() const override { return HASH_CONSTANTS::BLAKE512_BLOCK_SIZE; }
     size_t getHashSize() const override { return HASH_CONSTANTS::BLAKE512_HASH_SIZE; }
     std::string getAlgorithmName() const override { return "BLAKE512"; }
+    std::unique_ptr<HashInterface> clone() const override;
 
 private:
     // BLAKE512 state (8 64-bit words + 4 salt words + 2 counter words)
@@ -26,6 +27,8 @@ private:
     // Internal methods
     void processBlock(const uint8_t* block) override;
     void addPadding() override;
+    void saveState(HashState::Writer& writer) const override;
+    void loadState(HashState::Reader& reader) override;
     
     // BLAKE-specific functions
     void G(uint64_t& a, uint64_t& b, uint64_t& c, uint64_t& d, uint64_t x, uint64_t y) const;
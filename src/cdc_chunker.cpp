@@ -0,0 +1,78 @@
+#include "cdc_chunker.h"
+#include <algorithm>
+#include <stdexcept>
+
+constexpr size_t GearChunker::DEFAULT_MIN_SIZE;
+constexpr size_t GearChunker::DEFAULT_AVG_SIZE;
+constexpr size_t GearChunker::DEFAULT_MAX_SIZE;
+
+namespace {
+
+// Per-byte Gear values from a fixed splitmix64 sequence, so boundaries are
+// identical across builds and platforms
+struct GearTable {
+    uint64_t values[256];
+
+    GearTable() {
+        uint64_t seed = 0x6867656172636463ULL; // "hgearcdc"
+        for (uint64_t& value : values) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            value = z ^ (z >> 31);
+        }
+    }
+};
+
+const GearTable GEAR;
+
+// Mask of the top bits bits of the hash
+uint64_t topBits(unsigned bits) {
+    return ~0ULL << (64 - bits);
+}
+
+} // namespace
+
+GearChunker::GearChunker(size_t minSize, size_t avgSize, size_t maxSize)
+    : minSize_(minSize), avgSize_(avgSize), maxSize_(maxSize) {
+    if (minSize == 0 || minSize > avgSize || avgSize > maxSize) {
+        throw std::invalid_argument("Chunk sizes must satisfy 0 < min <= avg <= max");
+    }
+    if (avgSize < 64 || (avgSize & (avgSize - 1)) != 0) {
+        throw std::invalid_argument("Average chunk size must be a power of two of at least 64");
+    }
+
+    unsigned bits = 0;
+    while ((static_cast<size_t>(1) << bits) < avgSize) {
+        ++bits;
+    }
+    // Normalization level 2: two bits stricter / looser than the average
+    maskSmall_ = topBits(bits + 2);
+    maskLarge_ = topBits(bits - 2);
+}
+
+size_t GearChunker::findBoundary(const uint8_t* data, size_t length) const {
+    if (length <= minSize_) {
+        return length;
+    }
+
+    const size_t limit = std::min(length, maxSize_);
+    const size_t normal = std::min(avgSize_, limit);
+    uint64_t hash = 0;
+    size_t i = minSize_;
+
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + GEAR.values[data[i]];
+        if ((hash & maskSmall_) == 0) {
+            return i + 1;
+        }
+    }
+    for (; i < limit; ++i) {
+        hash = (hash << 1) + GEAR.values[data[i]];
+        if ((hash & maskLarge_) == 0) {
+            return i + 1;
+        }
+    }
+    return limit;
+}
@@ -0,0 +1,57 @@
+#ifndef CDC_CHUNKER_H
+#define CDC_CHUNKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Content-defined chunk boundaries (FastCDC with a Gear rolling hash)
+ *
+ * The Gear hash shifts left one bit per byte and adds a random 64-bit value
+ * for the byte, so its top bits depend on the last 64 bytes only. A boundary
+ * is declared where the masked top bits are all zero. Following FastCDC's
+ * normalized chunking, a stricter mask is used before the average size and a
+ * looser one after it, which concentrates chunk sizes around the average.
+ * The first minSize bytes of a chunk are skipped without hashing.
+ *
+ * Boundaries depend only on content, never on how the input is buffered.
+ */
+class GearChunker {
+public:
+    static constexpr size_t DEFAULT_MIN_SIZE = 2048;
+    static constexpr size_t DEFAULT_AVG_SIZE = 8192;
+    static constexpr size_t DEFAULT_MAX_SIZE = 65536;
+
+    /**
+     * Constructor
+     * @param minSize Minimum chunk size (except for the final chunk)
+     * @param avgSize Target average chunk size; must be a power of two
+     * @param maxSize Maximum chunk size
+     * @throws std::invalid_argument unless 0 < minSize <= avgSize <= maxSize
+     *         and avgSize is a power of two of at least 64
+     */
+    GearChunker(size_t minSize = DEFAULT_MIN_SIZE, size_t avgSize = DEFAULT_AVG_SIZE,
+                size_t maxSize = DEFAULT_MAX_SIZE);
+
+    /**
+     * Find the end of the chunk starting at data
+     * @param data Chunk start
+     * @param length Available bytes; must be at least getMaxSize() unless
+     *               this is the end of the input
+     * @return Chunk length (1..min(length, getMaxSize())), 0 for empty input
+     */
+    size_t findBoundary(const uint8_t* data, size_t length) const;
+
+    size_t getMinSize() const { return minSize_; }
+    size_t getAvgSize() const { return avgSize_; }
+    size_t getMaxSize() const { return maxSize_; }
+
+private:
+    size_t minSize_;
+    size_t avgSize_;
+    size_t maxSize_;
+    uint64_t maskSmall_;    // Before avgSize: more bits, fewer cuts
+    uint64_t maskLarge_;    // After avgSize: fewer bits, more cuts
+};
+
+#endif // CDC_CHUNKER_H
@@ -0,0 +1,66 @@
+#include "chunk_hasher.h"
+#include "hash_factory.h"
+#include "thread_pool.h"
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+ParallelChunkHasher::ParallelChunkHasher(const std::string& algorithm, size_t chunkSize, size_t threads)
+    : algorithm_(algorithm), chunkSize_(chunkSize), threads_(threads), hashSize_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    if (chunkSize == 0) {
+        throw std::invalid_argument("Chunk size must be greater than zero");
+    }
+    hashSize_ = HashFactory::createHash(algorithm)->getHashSize();
+}
+
+std::vector<std::vector<uint8_t>> ParallelChunkHasher::hashStream(std::istream& input,
+                                                                  const uint8_t* prefix,
+                                                                  size_t prefixLength) {
+    ThreadPool pool(threads_);
+
+    // Bound the number of chunks buffered in memory while workers catch up
+    const size_t maxInFlight = pool.getThreadCount() * 2;
+
+    std::vector<std::vector<uint8_t>> digests;
+    std::deque<std::future<std::vector<uint8_t>>> pending;
+    const std::string algorithm = algorithm_;
+    const std::vector<uint8_t> chunkPrefix(prefix, prefix + prefixLength);
+
+    auto collectOldest = [&]() {
+        digests.push_back(pending.front().get());
+        pending.pop_front();
+    };
+
+    while (input.good()) {
+        auto chunk = std::make_shared<std::vector<uint8_t>>(chunkSize_);
+        input.read(reinterpret_cast<char*>(chunk->data()), static_cast<std::streamsize>(chunkSize_));
+        std::streamsize bytesRead = input.gcount();
+        if (bytesRead <= 0) {
+            break;
+        }
+        chunk->resize(static_cast<size_t>(bytesRead));
+
+        if (pending.size() >= maxInFlight) {
+            collectOldest();
+        }
+        pending.push_back(pool.submit([chunk, algorithm, chunkPrefix]() {
+            auto hasher = HashFactory::createHash(algorithm);
+            hasher->update(chunkPrefix.data(), chunkPrefix.size());
+            hasher->update(chunk->data(), chunk->size());
+            hasher->finalize();
+            std::vector<uint8_t> digest(hasher->getHashSize());
+            hasher->getDigest(digest.data());
+            return digest;
+        }));
+    }
+
+    while (!pending.empty()) {
+        collectOldest();
+    }
+
+    return digests;
+}
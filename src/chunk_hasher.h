@@ -0,0 +1,49 @@
+#ifndef CHUNK_HASHER_H
+#define CHUNK_HASHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Reads a stream in fixed-size chunks and hashes each chunk on a worker pool
+ * Digests are returned in stream order; at most two chunks per worker are
+ * buffered at any time, so memory stays bounded for arbitrarily large input.
+ */
+class ParallelChunkHasher {
+public:
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm for every chunk (any HashFactory name)
+     * @param chunkSize Chunk size in bytes
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm or zero chunk size
+     */
+    ParallelChunkHasher(const std::string& algorithm, size_t chunkSize, size_t threads = 0);
+
+    /**
+     * Hash every chunk of a stream
+     * @param input Input stream to read from
+     * @param prefix Optional bytes hashed before each chunk (domain separation)
+     * @param prefixLength Prefix length in bytes
+     * @return One digest per chunk, in order; empty for empty input
+     */
+    std::vector<std::vector<uint8_t>> hashStream(std::istream& input,
+                                                 const uint8_t* prefix = nullptr,
+                                                 size_t prefixLength = 0);
+
+    /**
+     * Get the digest size of the configured algorithm
+     */
+    size_t getHashSize() const { return hashSize_; }
+
+private:
+    std::string algorithm_;
+    size_t chunkSize_;
+    size_t threads_;
+    size_t hashSize_;
+};
+
+#endif // CHUNK_HASHER_H
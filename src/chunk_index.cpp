@@ -0,0 +1,263 @@
+#include "chunk_index.h"
+#include "file_io.h"
+#include "hash_base.h"
+#include "hash_factory.h"
+#include "hash_state.h"
+#include "thread_pool.h"
+#include "tree_hash.h"
+#include <algorithm>
+#include <cerrno>
+#include <future>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr uint32_t ChunkIndex::FORMAT_VERSION;
+
+namespace {
+
+struct FileStamp {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    uint64_t mtimeSeconds;
+    uint32_t mtimeNanoseconds;
+    uint64_t ctimeSeconds;
+    uint32_t ctimeNanoseconds;
+
+    bool operator==(const FileStamp& other) const {
+        return device == other.device && inode == other.inode && size == other.size &&
+               mtimeSeconds == other.mtimeSeconds && mtimeNanoseconds == other.mtimeNanoseconds &&
+               ctimeSeconds == other.ctimeSeconds && ctimeNanoseconds == other.ctimeNanoseconds;
+    }
+};
+
+FileStamp stampOf(const struct stat& info) {
+    FileStamp stamp;
+    stamp.device = static_cast<uint64_t>(info.st_dev);
+    stamp.inode = static_cast<uint64_t>(info.st_ino);
+    stamp.size = static_cast<uint64_t>(info.st_size);
+#ifdef __APPLE__
+    stamp.mtimeSeconds = static_cast<uint64_t>(info.st_mtimespec.tv_sec);
+    stamp.mtimeNanoseconds = static_cast<uint32_t>(info.st_mtimespec.tv_nsec);
+    stamp.ctimeSeconds = static_cast<uint64_t>(info.st_ctimespec.tv_sec);
+    stamp.ctimeNanoseconds = static_cast<uint32_t>(info.st_ctimespec.tv_nsec);
+#else
+    stamp.mtimeSeconds = static_cast<uint64_t>(info.st_mtim.tv_sec);
+    stamp.mtimeNanoseconds = static_cast<uint32_t>(info.st_mtim.tv_nsec);
+    stamp.ctimeSeconds = static_cast<uint64_t>(info.st_ctim.tv_sec);
+    stamp.ctimeNanoseconds = static_cast<uint32_t>(info.st_ctim.tv_nsec);
+#endif
+    return stamp;
+}
+
+struct SavedIndex {
+    uint64_t chunkSize;
+    FileStamp stamp;
+    std::vector<std::vector<uint8_t>> leaves;
+};
+
+// Layout after the HashState header: u32 version, u64 chunk size, the stamp,
+// u64 chunk count, then the leaf digests
+bool loadIndex(const std::string& path, const std::string& algorithm, size_t hashSize, SavedIndex& index) {
+    std::vector<uint8_t> data;
+    if (!FileIO::readFile(path, data)) {
+        return false;
+    }
+    try {
+        HashState::Reader reader(data.data(), data.size(), algorithm);
+        if (reader.getU32() != ChunkIndex::FORMAT_VERSION) {
+            return false;
+        }
+        index.chunkSize = reader.getU64();
+        index.stamp.device = reader.getU64();
+        index.stamp.inode = reader.getU64();
+        index.stamp.size = reader.getU64();
+        index.stamp.mtimeSeconds = reader.getU64();
+        index.stamp.mtimeNanoseconds = reader.getU32();
+        index.stamp.ctimeSeconds = reader.getU64();
+        index.stamp.ctimeNanoseconds = reader.getU32();
+        const uint64_t count = reader.getU64();
+        if (count > data.size() / hashSize) {
+            return false;
+        }
+        index.leaves.resize(static_cast<size_t>(count));
+        for (size_t chunk = 0; chunk < index.leaves.size(); ++chunk) {
+            const uint8_t* digest = reader.getBytes(hashSize);
+            index.leaves[chunk].assign(digest, digest + hashSize);
+        }
+        reader.finish();
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+    return true;
+}
+
+void saveIndex(const std::string& path, const std::string& algorithm, const SavedIndex& index) {
+    HashState::Writer writer(algorithm);
+    writer.putU32(ChunkIndex::FORMAT_VERSION);
+    writer.putU64(index.chunkSize);
+    writer.putU64(index.stamp.device);
+    writer.putU64(index.stamp.inode);
+    writer.putU64(index.stamp.size);
+    writer.putU64(index.stamp.mtimeSeconds);
+    writer.putU32(index.stamp.mtimeNanoseconds);
+    writer.putU64(index.stamp.ctimeSeconds);
+    writer.putU32(index.stamp.ctimeNanoseconds);
+    writer.putU64(index.leaves.size());
+    for (const auto& leaf : index.leaves) {
+        writer.putBytes(leaf.data(), leaf.size());
+    }
+    FileIO::replaceFile(path, writer.take());
+}
+
+// Tracks the next data region so each chunk costs at most one SEEK_DATA call
+class HoleMap {
+public:
+    HoleMap(int fd, uint64_t size) : fd_(fd), size_(size), nextData_(0), supported_(true) {
+    }
+
+    // True if [start, end) contains no data
+    bool isHole(uint64_t start, uint64_t end) {
+        if (!supported_) {
+            return false;
+        }
+        if (nextData_ <= start) {
+            off_t data = ::lseek(fd_, static_cast<off_t>(start), SEEK_DATA);
+            if (data < 0) {
+                if (errno == ENXIO) {
+                    nextData_ = size_;   // Only a hole remains up to the end of the file
+                } else {
+                    supported_ = false;  // Filesystem without hole reporting
+                    return false;
+                }
+            } else {
+                nextData_ = static_cast<uint64_t>(data);
+            }
+        }
+        return nextData_ >= end;
+    }
+
+private:
+    int fd_;
+    uint64_t size_;
+    uint64_t nextData_;
+    bool supported_;
+};
+
+} // namespace
+
+ChunkIndex::ChunkIndex(const std::string& algorithm, size_t chunkSize, const std::string& indexPath, size_t threads)
+    : algorithm_(algorithm), chunkSize_(chunkSize), indexPath_(indexPath), threads_(threads),
+      chunksRead_(0), holeChunks_(0), chunkCount_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    if (chunkSize == 0) {
+        throw std::invalid_argument("Chunk size must be greater than zero");
+    }
+    if (indexPath.empty()) {
+        throw std::invalid_argument("Index file path cannot be empty");
+    }
+}
+
+void ChunkIndex::processFile(int fd) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        throw std::runtime_error("Chunk index mode requires a regular file");
+    }
+
+    auto prototype = HashFactory::createHash(algorithm_);
+    const std::string name = prototype->getAlgorithmName();
+    const size_t hashSize = prototype->getHashSize();
+    const FileStamp stamp = stampOf(info);
+
+    SavedIndex saved;
+    bool haveSaved = loadIndex(indexPath_, name, hashSize, saved) && saved.chunkSize == chunkSize_;
+
+    changed_.clear();
+    chunksRead_ = 0;
+    holeChunks_ = 0;
+
+    SavedIndex current;
+    current.chunkSize = chunkSize_;
+    current.stamp = stamp;
+
+    if (haveSaved && saved.stamp == stamp) {
+        current.leaves = std::move(saved.leaves);
+    } else {
+        if (!haveSaved) {
+            saved.leaves.clear();
+        }
+
+        const uint64_t chunkCount = (stamp.size + chunkSize_ - 1) / chunkSize_;
+        current.leaves.assign(static_cast<size_t>(chunkCount), std::vector<uint8_t>(hashSize));
+
+        // Holes are settled here; every chunk holding data is read
+        std::vector<uint8_t> zeroLeaf;
+        std::vector<size_t> toRead;
+        HoleMap holes(fd, stamp.size);
+        for (size_t chunk = 0; chunk < current.leaves.size(); ++chunk) {
+            const uint64_t start = static_cast<uint64_t>(chunk) * chunkSize_;
+            const size_t length = static_cast<size_t>(std::min<uint64_t>(chunkSize_, stamp.size - start));
+            std::vector<uint8_t>& leaf = current.leaves[chunk];
+            if (holes.isHole(start, start + length)) {
+                // Only the final chunk can be shorter; its zero digest is computed on its own
+                if (length != chunkSize_ || zeroLeaf.empty()) {
+                    std::vector<uint8_t> zeros(length, 0);
+                    TreeHasher::hashLeaf(algorithm_, zeros.data(), length, leaf.data());
+                    if (length == chunkSize_) {
+                        zeroLeaf = leaf;
+                    }
+                } else {
+                    leaf = zeroLeaf;
+                }
+                ++holeChunks_;
+            } else {
+                toRead.push_back(chunk);
+            }
+        }
+
+        ThreadPool pool(threads_);
+        std::vector<std::future<void>> tasks;
+        for (size_t chunk : toRead) {
+            tasks.push_back(pool.submit([this, fd, &current, &stamp, chunk]() {
+                const uint64_t start = static_cast<uint64_t>(chunk) * chunkSize_;
+                const size_t length = static_cast<size_t>(std::min<uint64_t>(chunkSize_, stamp.size - start));
+                std::vector<uint8_t> buffer(length);
+                if (FileIO::readAt(fd, buffer.data(), length, static_cast<off_t>(start)) != length) {
+                    throw std::runtime_error("File shrank while building the chunk index");
+                }
+                TreeHasher::hashLeaf(algorithm_, buffer.data(), length, current.leaves[chunk].data());
+            }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+        chunksRead_ = toRead.size();
+
+        for (size_t chunk = 0; chunk < current.leaves.size(); ++chunk) {
+            if (chunk >= saved.leaves.size() || saved.leaves[chunk] != current.leaves[chunk]) {
+                changed_.push_back(chunk);
+            }
+        }
+    }
+
+    chunkCount_ = current.leaves.size();
+    saveIndex(indexPath_, name, current);
+    // Empty file is a single empty leaf, as in --tree
+    std::vector<std::vector<uint8_t>> leaves = current.leaves;
+    if (leaves.empty()) {
+        std::vector<uint8_t> leaf(hashSize);
+        TreeHasher::hashLeaf(algorithm_, nullptr, 0, leaf.data());
+        leaves.push_back(std::move(leaf));
+    }
+    root_ = TreeHasher::combine(algorithm_, std::move(leaves), hashSize);
+}
+
+std::string ChunkIndex::getHash() const {
+    if (root_.empty()) {
+        throw std::runtime_error("Cannot get index root before processing a file");
+    }
+    return HashBase::toHex(root_.data(), root_.size());
+}
@@ -0,0 +1,88 @@
+#ifndef CHUNK_INDEX_H
+#define CHUNK_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Per-chunk digest index kept in a sidecar file for fast rehashing
+ *
+ * The file is split into fixed-size chunks laid out exactly like --tree
+ * leaves, so the root equals the --tree digest with the same leaf size.
+ * The sidecar records every leaf digest together with the file's identity,
+ * size, mtime and ctime:
+ *
+ *   - stamp unchanged: the stored leaves are reused and nothing is read
+ *   - otherwise chunks that lie entirely in a hole (SEEK_DATA) take the
+ *     precomputed zero-chunk digest; every other chunk is read and rehashed
+ *     in parallel, then compared with its stored digest
+ *
+ * Block mappings (FIEMAP) are not trusted to skip reads: freed blocks can
+ * return to the same chunk with new data, and a reflinked extent can be
+ * unshared, rewritten and shared again at the same physical address.
+ *
+ * The root is then recombined from the leaf digests.
+ */
+class ChunkIndex {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 3;   // Sidecar layout after the HashState header
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param chunkSize Chunk size in bytes
+     * @param indexPath Sidecar file holding the index
+     * @param threads Worker threads for rehashing (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm, zero chunk size or empty path
+     */
+    ChunkIndex(const std::string& algorithm, size_t chunkSize, const std::string& indexPath, size_t threads = 0);
+
+    /**
+     * Bring the index up to date with a regular file and save it
+     * @param fd Open, readable file descriptor
+     * @throws std::runtime_error if fd is not a regular file or on I/O errors
+     */
+    void processFile(int fd);
+
+    /**
+     * Get the root digest as a hex string
+     * @throws std::runtime_error if no file has been processed
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the indices of chunks whose digest differs from the saved index
+     * (every chunk when there was no usable index)
+     */
+    const std::vector<size_t>& getChangedChunks() const { return changed_; }
+
+    /**
+     * Get the number of chunks read by the last run
+     */
+    size_t getChunksRead() const { return chunksRead_; }
+
+    /**
+     * Get the number of chunks resolved as holes by the last run
+     */
+    size_t getHoleChunks() const { return holeChunks_; }
+
+    /**
+     * Get the number of chunks in the file
+     */
+    size_t getChunkCount() const { return chunkCount_; }
+
+private:
+    std::string algorithm_;
+    size_t chunkSize_;
+    std::string indexPath_;
+    size_t threads_;
+    std::vector<size_t> changed_;
+    size_t chunksRead_;
+    size_t holeChunks_;
+    size_t chunkCount_;
+    std::vector<uint8_t> root_;
+};
+
+#endif // CHUNK_INDEX_H
@@ -0,0 +1,84 @@
+#ifndef COMPOSITE_HASH_H
+#define COMPOSITE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Object-store compatible composite digests computed in one parallel pass
+ *
+ * The input is split into fixed-size parts that are hashed on a worker pool;
+ * the ordered part digests are then combined by the outer hash:
+ *
+ *   s3-etag     MD5 parts (default 8MiB), MD5 of the concatenated part MD5s, "-N" suffix
+ *   dropbox     SHA256 blocks (default 4MiB), SHA256 of the concatenated block SHA256s
+ *   bittorrent  SHA1 pieces (default 256KiB); the composite is the concatenated
+ *               piece list, i.e. the torrent "pieces" field in hex
+ */
+class CompositeHasher {
+public:
+    enum class Format {
+        S3_ETAG,
+        DROPBOX,
+        BITTORRENT
+    };
+
+    /**
+     * Constructor
+     * @param format Composite format
+     * @param partSize Part size in bytes (0 selects the format's default)
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     */
+    CompositeHasher(Format format, size_t partSize = 0, size_t threads = 0);
+
+    /**
+     * Hash every part of a stream and combine them
+     * @param input Input stream to read from
+     */
+    void processStream(std::istream& input);
+
+    /**
+     * Get the composite digest in the format's conventional text form
+     * @throws std::runtime_error if no stream has been processed
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the per-part digests of the last processed stream as hex strings
+     */
+    std::vector<std::string> getPartHashes() const;
+
+    /**
+     * Get the part size in use
+     */
+    size_t getPartSize() const { return partSize_; }
+
+    /**
+     * Parse a format name (s3-etag, dropbox, bittorrent)
+     * @throws std::invalid_argument for unknown names
+     */
+    static Format parseFormat(const std::string& name);
+
+    /**
+     * Get the list of supported format names
+     */
+    static std::vector<std::string> getSupportedFormats();
+
+    /**
+     * Get the conventional part size of a format
+     */
+    static size_t defaultPartSize(Format format);
+
+private:
+    Format format_;
+    size_t partSize_;
+    size_t threads_;
+    bool processed_;
+    std::vector<std::vector<uint8_t>> parts_;
+    std::string composite_;
+};
+
+#endif // COMPOSITE_HASH_H
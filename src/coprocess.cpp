@@ -0,0 +1,267 @@
+#include "coprocess.h"
+#include "batch_hash.h"
+#include "file_io.h"
+#include "hash_base.h"
+#include "hash_factory.h"
+#include "hash_protocol.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+constexpr size_t CoprocessHasher::INPUT_BUFFER_SIZE;
+constexpr size_t CoprocessHasher::OUTPUT_BUFFER_SIZE;
+constexpr size_t CoprocessHasher::FILE_BUFFER_SIZE;
+constexpr size_t CoprocessHasher::MAX_REQUEST_SIZE;
+constexpr size_t CoprocessHasher::BATCH_SIZE;
+
+// Per-thread hasher and read buffer, reused for every path that worker hashes
+struct CoprocessHasher::Worker {
+    std::unique_ptr<HashInterface> hasher;
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> digest;
+
+    explicit Worker(const std::string& algorithm)
+        : hasher(HashFactory::createHash(algorithm)), buffer(FILE_BUFFER_SIZE), digest(hasher->getHashSize()) {
+    }
+
+    // Returns the answer line, or an empty string if the filter drops it
+    std::string hashPath(const std::string& path, const std::function<bool(const uint8_t*)>& filter) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return "error  " + path + ": " + std::strerror(errno);
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        try {
+            hasher->reset();
+            for (;;) {
+                const size_t got = FileIO::readSome(fd, buffer.data(), buffer.size());
+                if (got == 0) {
+                    break;
+                }
+                hasher->update(buffer.data(), got);
+            }
+            hasher->finalize();
+        } catch (const std::exception& e) {
+            ::close(fd);
+            return "error  " + path + ": " + e.what();
+        }
+        ::close(fd);
+        hasher->getDigest(digest.data());
+        if (filter && !filter(digest.data())) {
+            return std::string();
+        }
+        return HashBase::toHex(digest.data(), digest.size()) + "  " + path;
+    }
+};
+
+namespace {
+
+// True if a read would return without blocking (data, end of input or an error)
+bool inputReady(int fd) {
+    pollfd entry;
+    entry.fd = fd;
+    entry.events = POLLIN;
+    entry.revents = 0;
+    int n;
+    do {
+        n = ::poll(&entry, 1, 0);
+    } while (n < 0 && errno == EINTR);
+    return n != 0;
+}
+
+} // namespace
+
+CoprocessHasher::CoprocessHasher(const std::string& algorithm, size_t threads)
+    : algorithm_(algorithm), hashSize_(0), requests_(0), flushes_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    hashSize_ = HashFactory::createHash(algorithm)->getHashSize();
+    pool_.reset(new ThreadPool(threads));
+    for (size_t i = 0; i < pool_->getThreadCount(); ++i) {
+        workers_.emplace_back(new Worker(algorithm));
+    }
+}
+
+CoprocessHasher::~CoprocessHasher() {
+}
+
+CoprocessHasher::Format CoprocessHasher::parseFormat(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    if (lower == "paths") {
+        return Format::PATHS;
+    } else if (lower == "frames") {
+        return Format::FRAMES;
+    }
+    throw std::invalid_argument("Unsupported batch format: " + name);
+}
+
+size_t CoprocessHasher::nextRequest(Format format, const uint8_t* data, size_t length, size_t& bodyOffset) const {
+    if (format == Format::PATHS) {
+        bodyOffset = 0;
+        const void* newline = std::memchr(data, '\n', length);
+        if (newline) {
+            return static_cast<size_t>(static_cast<const uint8_t*>(newline) - data) + 1;
+        }
+        if (length > MAX_REQUEST_SIZE) {
+            throw std::runtime_error("Batch request line too long");
+        }
+        return 0;
+    }
+
+    bodyOffset = 4;
+    if (length < 4) {
+        return 0;
+    }
+    const size_t frameLength = HashProtocol::getU32(data);
+    if (frameLength > MAX_REQUEST_SIZE) {
+        throw std::runtime_error("Batch request frame too large: " + std::to_string(frameLength) + " bytes");
+    }
+    return length - 4 >= frameLength ? 4 + frameLength : 0;
+}
+
+void CoprocessHasher::answerPaths(const std::vector<std::string>& paths) {
+    std::vector<std::string> lines(paths.size());
+
+    // A lone request is answered inline so an interactive caller pays no hand-off
+    if (paths.size() == 1 || workers_.size() == 1) {
+        for (size_t i = 0; i < paths.size(); ++i) {
+            lines[i] = workers_[0]->hashPath(paths[i], filter_);
+        }
+    } else {
+        std::atomic<size_t> next(0);
+        std::vector<std::future<void>> tasks;
+        for (size_t t = 0; t < std::min(workers_.size(), paths.size()); ++t) {
+            Worker* worker = workers_[t].get();
+            const std::function<bool(const uint8_t*)>& filter = filter_;
+            tasks.push_back(pool_->submit([worker, &paths, &lines, &next, &filter]() {
+                for (size_t i = next++; i < paths.size(); i = next++) {
+                    lines[i] = worker->hashPath(paths[i], filter);
+                }
+            }));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+    }
+
+    for (const auto& line : lines) {
+        if (line.empty()) {
+            continue;
+        }
+        output_.insert(output_.end(), line.begin(), line.end());
+        output_.push_back('\n');
+    }
+}
+
+void CoprocessHasher::answerFrames(const std::vector<std::pair<const uint8_t*, size_t>>& frames) {
+    std::vector<HashSpan> inputs;
+    inputs.reserve(frames.size());
+    for (const auto& frame : frames) {
+        inputs.push_back(HashSpan{frame.first, frame.second});
+    }
+    std::vector<uint8_t> digests(frames.size() * hashSize_);
+    hashBatch(algorithm_, inputs.data(), inputs.size(), digests.data());
+
+    for (size_t i = 0; i < frames.size(); ++i) {
+        output_.push_back(HashProtocol::OK);
+        HashProtocol::putU32(output_, static_cast<uint32_t>(hashSize_));
+        output_.insert(output_.end(), digests.begin() + i * hashSize_, digests.begin() + (i + 1) * hashSize_);
+    }
+}
+
+void CoprocessHasher::flush(int outFd) {
+    if (!output_.empty()) {
+        FileIO::writeAll(outFd, output_.data(), output_.size());
+        output_.clear();
+        ++flushes_;
+    }
+}
+
+void CoprocessHasher::run(int inFd, int outFd, Format format) {
+    if (format == Format::FRAMES && filter_) {
+        throw std::invalid_argument("A digest filter applies to path requests only");
+    }
+    std::vector<uint8_t> input(INPUT_BUFFER_SIZE);
+    size_t start = 0;
+    size_t end = 0;
+    bool atEnd = false;
+    requests_ = 0;
+    flushes_ = 0;
+    output_.clear();
+
+    std::vector<std::string> paths;
+    std::vector<std::pair<const uint8_t*, size_t>> frames;
+    for (;;) {
+        // Answer every complete request already buffered
+        paths.clear();
+        frames.clear();
+        while (paths.size() + frames.size() < BATCH_SIZE) {
+            size_t bodyOffset;
+            const size_t size = nextRequest(format, input.data() + start, end - start, bodyOffset);
+            if (size == 0) {
+                break;
+            }
+            const uint8_t* body = input.data() + start + bodyOffset;
+            if (format == Format::PATHS) {
+                paths.emplace_back(reinterpret_cast<const char*>(body), size - 1);
+            } else {
+                frames.emplace_back(body, size - bodyOffset);
+            }
+            start += size;
+        }
+
+        // At end of input a final path may lack its newline; a partial frame is an error
+        if (paths.empty() && frames.empty() && atEnd && start != end) {
+            if (format == Format::FRAMES) {
+                throw std::runtime_error("Truncated batch request frame at end of input");
+            }
+            paths.emplace_back(reinterpret_cast<const char*>(input.data() + start), end - start);
+            start = end;
+        }
+
+        if (!paths.empty() || !frames.empty()) {
+            if (format == Format::PATHS) {
+                answerPaths(paths);
+            } else {
+                answerFrames(frames);
+            }
+            requests_ += paths.size() + frames.size();
+            if (output_.size() >= OUTPUT_BUFFER_SIZE) {
+                flush(outFd);
+            }
+            continue;
+        }
+        if (atEnd) {
+            break;
+        }
+
+        // Out of complete requests: hold responses back only while more input is waiting
+        if (!output_.empty() && !inputReady(inFd)) {
+            flush(outFd);
+        }
+        if (start > 0) {
+            std::memmove(input.data(), input.data() + start, end - start);
+            end -= start;
+            start = 0;
+        }
+        if (end == input.size()) {
+            input.resize(input.size() * 2);
+        }
+        const size_t got = FileIO::readSome(inFd, input.data() + end, input.size() - end);
+        atEnd = got == 0;
+        end += got;
+    }
+    flush(outFd);
+}
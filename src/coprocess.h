@@ -0,0 +1,106 @@
+#ifndef COPROCESS_H
+#define COPROCESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Resident request/response hashing over a pair of descriptors, for scripts
+ * that would otherwise start one hashgen process per object
+ *
+ * Request formats:
+ *
+ *   paths   one file path per line; each response is a line
+ *           "<hex digest>  <path>" or "error  <path>: <reason>"
+ *   frames  u32 big-endian length followed by the message; each response is
+ *           u8 status (0 ok, 1 error), u32 big-endian length and the binary
+ *           digest or error text (the daemon's response framing)
+ *
+ * Responses come back in request order. Every complete request already
+ * buffered is handled together: paths are hashed on the worker pool, each
+ * worker reusing its own hasher and read buffer, and frames go through
+ * hashBatch. Output is flushed only when the input has nothing more ready,
+ * so a caller that pipelines requests gets large writes while one that
+ * waits for each answer still gets it straight away.
+ */
+class CoprocessHasher {
+public:
+    enum class Format {
+        PATHS,
+        FRAMES
+    };
+
+    static constexpr size_t INPUT_BUFFER_SIZE = 1024 * 1024;
+    static constexpr size_t OUTPUT_BUFFER_SIZE = 1024 * 1024;   // Flushed early beyond this
+    static constexpr size_t FILE_BUFFER_SIZE = 256 * 1024;
+    static constexpr size_t MAX_REQUEST_SIZE = 64 * 1024 * 1024;
+    static constexpr size_t BATCH_SIZE = 1024;                  // Requests per dispatch
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param threads Worker threads for path requests (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    CoprocessHasher(const std::string& algorithm, size_t threads = 0);
+    ~CoprocessHasher();
+
+    CoprocessHasher(const CoprocessHasher&) = delete;
+    CoprocessHasher& operator=(const CoprocessHasher&) = delete;
+
+    /**
+     * Answer only the paths whose binary digest passes keep, e.g. a
+     * DigestIndex lookup; failed paths are still answered. keep is called
+     * from the worker threads, possibly at the same time.
+     */
+    void setFilter(const std::function<bool(const uint8_t* digest)>& keep) { filter_ = keep; }
+
+    /**
+     * Answer requests from inFd on outFd until end of input
+     * @throws std::runtime_error on I/O errors, a truncated or oversized request
+     * @throws std::invalid_argument for frames when a filter is set
+     */
+    void run(int inFd, int outFd, Format format);
+
+    /**
+     * Get the number of requests answered by the last run
+     */
+    uint64_t getRequestCount() const { return requests_; }
+
+    /**
+     * Get the number of output writes made by the last run
+     */
+    uint64_t getFlushCount() const { return flushes_; }
+
+    /**
+     * Parse a format name (paths, frames)
+     * @throws std::invalid_argument for unknown names
+     */
+    static Format parseFormat(const std::string& name);
+
+private:
+    struct Worker;
+
+    size_t nextRequest(Format format, const uint8_t* data, size_t length, size_t& bodyOffset) const;
+    void answerPaths(const std::vector<std::string>& paths);
+    void answerFrames(const std::vector<std::pair<const uint8_t*, size_t>>& frames);
+    void flush(int outFd);
+
+    std::string algorithm_;
+    size_t hashSize_;
+    std::unique_ptr<ThreadPool> pool_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::function<bool(const uint8_t*)> filter_;
+    std::vector<uint8_t> output_;
+    uint64_t requests_;
+    uint64_t flushes_;
+};
+
+#endif // COPROCESS_H
@@ -0,0 +1,173 @@
+#include "copy_hash.h"
+#include "file_io.h"
+#include "hash_factory.h"
+#include "thread_pool.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t CopyHasher::BUFFER_SIZE;
+constexpr size_t CopyHasher::DIRECT_ALIGNMENT;
+
+namespace {
+
+struct AlignedFree {
+    void operator()(uint8_t* p) const { std::free(p); }
+};
+
+std::unique_ptr<uint8_t, AlignedFree> alignedBuffer(size_t size) {
+    void* memory = nullptr;
+    if (::posix_memalign(&memory, CopyHasher::DIRECT_ALIGNMENT, size) != 0) {
+        throw std::bad_alloc();
+    }
+    return std::unique_ptr<uint8_t, AlignedFree>(static_cast<uint8_t*>(memory));
+}
+
+// Opened without O_TRUNC: the caller truncates once it knows the destination is not the source
+int openDestination(const std::string& path, mode_t mode, bool direct, bool& usedDirect) {
+    const int flags = O_WRONLY | O_CREAT;
+    usedDirect = false;
+#ifdef O_DIRECT
+    if (direct) {
+        int fd = ::open(path.c_str(), flags | O_DIRECT, mode);
+        if (fd >= 0) {
+            usedDirect = true;
+            return fd;
+        }
+        if (errno != EINVAL) {
+            throw std::runtime_error("Cannot open destination " + path + ": " + std::strerror(errno));
+        }
+        // The file system does not support O_DIRECT; fall through to buffered writes
+    }
+#else
+    (void)direct;
+#endif
+    int fd = ::open(path.c_str(), flags, mode);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open destination " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+} // namespace
+
+CopyHasher::CopyHasher(const std::string& algorithm, bool direct, bool verify)
+    : algorithm_(algorithm), direct_(direct), verify_(verify), usedDirect_(false), bytesCopied_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+}
+
+void CopyHasher::copy(const std::string& source, const std::string& destination) {
+    FileIO::Descriptor in(::open(source.c_str(), O_RDONLY));
+    if (in.get() < 0) {
+        throw std::runtime_error("Cannot open source " + source + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (::fstat(in.get(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        throw std::runtime_error("Copy source must be a regular file: " + source);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(in.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    FileIO::Descriptor out(openDestination(destination, info.st_mode & 07777, direct_, usedDirect_));
+    // A second name, hard link or bind mount of the source must not be truncated under it
+    struct stat target;
+    if (::fstat(out.get(), &target) != 0) {
+        throw std::runtime_error("Cannot stat destination " + destination + ": " + std::strerror(errno));
+    }
+    if (target.st_dev == info.st_dev && target.st_ino == info.st_ino) {
+        throw std::runtime_error("Source and destination are the same file: " + source + ", " + destination);
+    }
+    if (::ftruncate(out.get(), 0) != 0) {
+        throw std::runtime_error("Cannot truncate destination " + destination + ": " + std::strerror(errno));
+    }
+    auto hasher = HashFactory::createHash(algorithm_);
+    bytesCopied_ = 0;
+    digest_.clear();
+
+    // Two buffers: one being filled by the read-ahead thread, one being hashed and written.
+    // The pool is declared after the buffers so its workers are joined first.
+    std::unique_ptr<uint8_t, AlignedFree> buffers[2] = {alignedBuffer(BUFFER_SIZE), alignedBuffer(BUFFER_SIZE)};
+    ThreadPool reader(1);
+    const int inFd = in.get();
+    auto readAhead = [&](uint8_t* buffer, uint64_t offset) {
+        return reader.submit([inFd, buffer, offset]() {
+            return FileIO::readAt(inFd, buffer, BUFFER_SIZE, static_cast<off_t>(offset));
+        });
+    };
+
+    std::future<size_t> pending = readAhead(buffers[0].get(), 0);
+    for (size_t current = 0;; current ^= 1) {
+        const size_t got = pending.get();
+        if (got == BUFFER_SIZE) {
+            pending = readAhead(buffers[current ^ 1].get(), bytesCopied_ + got);
+        }
+        if (got == 0) {
+            break;
+        }
+
+        uint8_t* data = buffers[current].get();
+        hasher->update(data, got);
+#ifdef O_DIRECT
+        // O_DIRECT needs aligned lengths; the short tail is written buffered
+        if (usedDirect_ && got % DIRECT_ALIGNMENT != 0) {
+            const int flags = ::fcntl(out.get(), F_GETFL);
+            if (flags < 0 || ::fcntl(out.get(), F_SETFL, flags & ~O_DIRECT) != 0) {
+                throw std::runtime_error(std::string("Cannot leave direct I/O: ") + std::strerror(errno));
+            }
+        }
+#endif
+        FileIO::writeAll(out.get(), data, got);
+        bytesCopied_ += got;
+        if (got < BUFFER_SIZE) {
+            break;
+        }
+    }
+
+    hasher->finalize();
+    const std::string digest = hasher->getHash();
+
+    if (verify_) {
+        // Force the copy to storage and drop it from the cache so the re-read checks the device
+        if (::fsync(out.get()) != 0) {
+            throw std::runtime_error(std::string("fsync failed: ") + std::strerror(errno));
+        }
+        FileIO::Descriptor check(::open(destination.c_str(), O_RDONLY));
+        if (check.get() < 0) {
+            throw std::runtime_error("Cannot reopen destination " + destination + ": " + std::strerror(errno));
+        }
+#ifdef POSIX_FADV_DONTNEED
+        ::posix_fadvise(check.get(), 0, 0, POSIX_FADV_DONTNEED);
+#endif
+        auto checker = HashFactory::createHash(algorithm_);
+        uint8_t* data = buffers[0].get();
+        uint64_t offset = 0;
+        size_t got;
+        while ((got = FileIO::readAt(check.get(), data, BUFFER_SIZE, static_cast<off_t>(offset))) > 0) {
+            checker->update(data, got);
+            offset += got;
+        }
+        checker->finalize();
+        if (offset != bytesCopied_ || checker->getHash() != digest) {
+            throw std::runtime_error("Verification failed: " + destination + " does not match " + source);
+        }
+    }
+
+    out.close();
+    digest_ = digest;
+}
+
+std::string CopyHasher::getHash() const {
+    if (digest_.empty()) {
+        throw std::runtime_error("Cannot get hash before copying a file");
+    }
+    return digest_;
+}
@@ -0,0 +1,68 @@
+#ifndef COPY_HASH_H
+#define COPY_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Copy a file and compute its digest from a single read of the source
+ *
+ * The source is read in large buffers by a read-ahead thread while the
+ * previous buffer is hashed and written, so reading, hashing and writing
+ * overlap. Writes are whole aligned buffers; with direct I/O the destination
+ * is opened with O_DIRECT so the copy does not evict the page cache. After
+ * the copy the destination can be re-read from storage and its digest
+ * compared with the source digest.
+ */
+class CopyHasher {
+public:
+    // Bytes per read and write
+    static constexpr size_t BUFFER_SIZE = 4 * 1024 * 1024;
+
+    // Buffer address and length alignment required for O_DIRECT writes
+    static constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param direct Write the destination with O_DIRECT where supported
+     * @param verify Re-read the destination after copying and compare digests
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    CopyHasher(const std::string& algorithm, bool direct = false, bool verify = false);
+
+    /**
+     * Copy source to destination (created or truncated, with the source's
+     * permission bits) and hash the copied bytes
+     * @throws std::runtime_error on I/O errors or a verification mismatch
+     */
+    void copy(const std::string& source, const std::string& destination);
+
+    /**
+     * Get the digest of the copied data
+     * @throws std::runtime_error if nothing has been copied
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the number of bytes copied by the last run
+     */
+    uint64_t getBytesCopied() const { return bytesCopied_; }
+
+    /**
+     * Check whether the last run wrote with O_DIRECT (false if the file
+     * system refused it and buffered writes were used instead)
+     */
+    bool isDirect() const { return usedDirect_; }
+
+private:
+    std::string algorithm_;
+    bool direct_;
+    bool verify_;
+    bool usedDirect_;
+    uint64_t bytesCopied_;
+    std::string digest_;
+};
+
+#endif // COPY_HASH_H
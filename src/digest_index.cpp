@@ -0,0 +1,260 @@
+#include "digest_index.h"
+#include "file_io.h"
+#include "hash_factory.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t DigestIndex::HEADER_SIZE;
+constexpr size_t DigestIndex::BLOOM_BLOCK_SIZE;
+constexpr size_t DigestIndex::DEFAULT_BLOOM_BITS;
+
+namespace {
+
+const uint32_t FORMAT_VERSION = 1;
+const size_t ALGORITHM_FIELD_SIZE = 32;
+const size_t BLOOM_BLOCK_BITS = DigestIndex::BLOOM_BLOCK_SIZE * 8;
+const size_t INTERPOLATION_STEPS = 8;     // Then bisect, bounding skewed inputs to O(log n)
+
+uint64_t loadU64(const uint8_t* in) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+uint32_t loadU32(const uint8_t* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | in[3];
+}
+
+void storeU64(uint8_t* out, uint64_t value) {
+    for (size_t i = 0; i < 8; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (56 - 8 * i));
+    }
+}
+
+void storeU32(uint8_t* out, uint32_t value) {
+    for (size_t i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (24 - 8 * i));
+    }
+}
+
+// The block comes from digest bytes 8..15 and the probe positions from bytes 0..7
+size_t bloomBlock(const uint8_t* digest, uint64_t blocks) {
+    return static_cast<size_t>(loadU64(digest + 8) % blocks);
+}
+
+template <typename Visit>
+void bloomProbes(const uint8_t* digest, uint32_t probes, Visit visit) {
+    const uint64_t key = loadU64(digest);
+    const uint32_t start = static_cast<uint32_t>(key);
+    const uint32_t step = static_cast<uint32_t>(key >> 32) | 1;
+    for (uint32_t i = 0; i < probes; ++i) {
+        visit((start + i * step) % BLOOM_BLOCK_BITS);
+    }
+}
+
+template <size_t N>
+size_t sortUniqueRecords(uint8_t* data, size_t count) {
+    typedef std::array<uint8_t, N> Record;
+    static_assert(sizeof(Record) == N, "Digest records must be packed");
+    Record* records = reinterpret_cast<Record*>(data);
+    std::sort(records, records + count);
+    return static_cast<size_t>(std::unique(records, records + count) - records);
+}
+
+// Sort fixed-size binary digests in place and drop duplicates
+size_t sortUnique(uint8_t* data, size_t count, size_t digestSize) {
+    switch (digestSize) {
+        case 16: return sortUniqueRecords<16>(data, count);
+        case 20: return sortUniqueRecords<20>(data, count);
+        case 28: return sortUniqueRecords<28>(data, count);
+        case 32: return sortUniqueRecords<32>(data, count);
+        case 48: return sortUniqueRecords<48>(data, count);
+        case 64: return sortUniqueRecords<64>(data, count);
+    }
+    throw std::invalid_argument("Unsupported digest size: " + std::to_string(digestSize));
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+} // namespace
+
+DigestIndex::DigestIndex(const std::string& path)
+    : base_(nullptr), size_(0), digestSize_(0), bloomProbes_(0), count_(0), bloomBlocks_(0),
+      bloom_(nullptr), digests_(nullptr) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open digest index " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < HEADER_SIZE) {
+        ::close(fd);
+        throw std::runtime_error("Malformed digest index: " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* base = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    const int error = errno;
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Cannot map digest index " + path + ": " + std::strerror(error));
+    }
+    base_ = static_cast<const uint8_t*>(base);
+
+    // Probes land anywhere in the file; readahead would only waste I/O
+    ::madvise(base, size_, MADV_RANDOM);
+
+    const uint8_t* header = base_;
+    digestSize_ = loadU32(header + 8);
+    bloomProbes_ = loadU32(header + 12);
+    count_ = loadU64(header + 16);
+    bloomBlocks_ = loadU64(header + 24);
+    const char* name = reinterpret_cast<const char*>(header + 32);
+    algorithm_.assign(name, strnlen(name, ALGORITHM_FIELD_SIZE));
+
+    const bool sizesValid = digestSize_ >= 16 && digestSize_ <= 64 &&
+                            bloomBlocks_ <= (size_ - HEADER_SIZE) / BLOOM_BLOCK_SIZE &&
+                            count_ <= (size_ - HEADER_SIZE - bloomBlocks_ * BLOOM_BLOCK_SIZE) / digestSize_ &&
+                            HEADER_SIZE + bloomBlocks_ * BLOOM_BLOCK_SIZE + count_ * digestSize_ == size_;
+    if (std::memcmp(header, "HGDX", 4) != 0 || loadU32(header + 4) != FORMAT_VERSION || !sizesValid ||
+        (bloomBlocks_ > 0) != (bloomProbes_ > 0)) {
+        ::munmap(base, size_);
+        throw std::runtime_error("Malformed digest index: " + path);
+    }
+    bloom_ = base_ + HEADER_SIZE;
+    digests_ = bloom_ + bloomBlocks_ * BLOOM_BLOCK_SIZE;
+}
+
+DigestIndex::~DigestIndex() {
+    ::munmap(const_cast<uint8_t*>(base_), size_);
+}
+
+bool DigestIndex::bloomContains(const uint8_t* digest) const {
+    const uint8_t* block = bloom_ + bloomBlock(digest, bloomBlocks_) * BLOOM_BLOCK_SIZE;
+    bool present = true;
+    bloomProbes(digest, bloomProbes_, [&](size_t bit) {
+        present = present && (block[bit / 8] & (1u << (bit % 8))) != 0;
+    });
+    return present;
+}
+
+bool DigestIndex::contains(const uint8_t* digest) const {
+    if (count_ == 0 || (bloomBlocks_ > 0 && !bloomContains(digest))) {
+        return false;
+    }
+
+    auto record = [this](uint64_t i) { return digests_ + i * digestSize_; };
+    const uint64_t target = loadU64(digest);
+    uint64_t low = 0;
+    uint64_t high = count_ - 1;
+    for (size_t step = 0; low <= high; ++step) {
+        const uint64_t lowKey = loadU64(record(low));
+        const uint64_t highKey = loadU64(record(high));
+        if (target < lowKey || target > highKey) {
+            return false;
+        }
+
+        // Guess the position from the key's place between the ends, then fall back to bisection
+        uint64_t middle = low + (high - low) / 2;
+        if (step < INTERPOLATION_STEPS && highKey > lowKey) {
+            const double fraction = static_cast<double>(target - lowKey) / static_cast<double>(highKey - lowKey);
+            middle = low + std::min(high - low, static_cast<uint64_t>(fraction * static_cast<double>(high - low)));
+        }
+
+        const int order = std::memcmp(record(middle), digest, digestSize_);
+        if (order == 0) {
+            return true;
+        } else if (order < 0) {
+            low = middle + 1;
+        } else if (middle == 0) {
+            return false;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return false;
+}
+
+uint64_t DigestIndex::build(const std::string& path, const std::string& algorithm, std::istream& input,
+                            size_t bloomBitsPerKey) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    const std::string name = HashFactory::createHash(algorithm)->getAlgorithmName();
+    const size_t digestSize = HashFactory::createHash(algorithm)->getHashSize();
+
+    std::vector<uint8_t> digests;
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(input, line); ++lineNumber) {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        size_t end = line.find_first_of(" \t\r,", start);
+        std::string field = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+            field = field.substr(1, field.size() - 2);
+        }
+        if (field.size() != digestSize * 2) {
+            throw std::runtime_error("Malformed digest on line " + std::to_string(lineNumber));
+        }
+        for (size_t i = 0; i < digestSize; ++i) {
+            const int high = hexValue(field[2 * i]);
+            const int low = hexValue(field[2 * i + 1]);
+            if (high < 0 || low < 0) {
+                throw std::runtime_error("Malformed digest on line " + std::to_string(lineNumber));
+            }
+            digests.push_back(static_cast<uint8_t>(high << 4 | low));
+        }
+    }
+
+    const size_t count = sortUnique(digests.data(), digests.size() / digestSize, digestSize);
+    digests.resize(count * digestSize);
+
+    uint64_t bloomBlocks = 0;
+    uint32_t probes = 0;
+    if (bloomBitsPerKey > 0 && count > 0) {
+        bloomBlocks = (static_cast<uint64_t>(count) * bloomBitsPerKey + BLOOM_BLOCK_BITS - 1) / BLOOM_BLOCK_BITS;
+        probes = static_cast<uint32_t>(std::max(1.0, std::min(16.0, std::round(bloomBitsPerKey * std::log(2.0)))));
+    }
+    std::vector<uint8_t> bloom(static_cast<size_t>(bloomBlocks) * BLOOM_BLOCK_SIZE);
+    for (size_t i = 0; i < count && bloomBlocks > 0; ++i) {
+        const uint8_t* digest = digests.data() + i * digestSize;
+        uint8_t* block = bloom.data() + bloomBlock(digest, bloomBlocks) * BLOOM_BLOCK_SIZE;
+        bloomProbes(digest, probes, [block](size_t bit) { block[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8)); });
+    }
+
+    std::vector<uint8_t> header(HEADER_SIZE);
+    std::memcpy(header.data(), "HGDX", 4);
+    storeU32(header.data() + 4, FORMAT_VERSION);
+    storeU32(header.data() + 8, static_cast<uint32_t>(digestSize));
+    storeU32(header.data() + 12, probes);
+    storeU64(header.data() + 16, count);
+    storeU64(header.data() + 24, bloomBlocks);
+    std::memcpy(header.data() + 32, name.data(), std::min(name.size(), ALGORITHM_FIELD_SIZE - 1));
+
+    FileIO::replaceFile(path, {&header, &bloom, &digests});
+    return count;
+}
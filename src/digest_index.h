@@ -0,0 +1,90 @@
+#ifndef DIGEST_INDEX_H
+#define DIGEST_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/**
+ * Memory-mapped set of known digests (allow/deny lists) for membership tests
+ *
+ * Layout (integers big-endian):
+ *   "HGDX"  magic
+ *   u32     format version (1)
+ *   u32     digest size in bytes
+ *   u32     Bloom probes per key (0 without a filter)
+ *   u64     digest count
+ *   u64     Bloom filter blocks
+ *   char    algorithm name, NUL-padded to 32 bytes
+ *   ...     Bloom filter: blocks of 64 bytes (one cache line each)
+ *   ...     digests, binary, sorted and unique
+ *
+ * Digests are uniformly distributed, so lookups use interpolation search on
+ * their leading 64 bits and usually touch two or three pages, finishing
+ * with a bounded binary search. The blocked Bloom filter in front sends
+ * each key to a single cache line, so most misses are rejected without
+ * reaching the sorted array. Key bits come from the digest itself; no
+ * further hashing is needed. Nothing is copied to the heap: the file is
+ * mapped read-only and probed in place.
+ */
+class DigestIndex {
+public:
+    static constexpr size_t HEADER_SIZE = 64;
+    static constexpr size_t BLOOM_BLOCK_SIZE = 64;
+    static constexpr size_t DEFAULT_BLOOM_BITS = 10;    // Bits per key; about 1% false positives
+
+    /**
+     * Map an index file
+     * @throws std::runtime_error if it cannot be mapped or is malformed
+     */
+    explicit DigestIndex(const std::string& path);
+    ~DigestIndex();
+
+    DigestIndex(const DigestIndex&) = delete;
+    DigestIndex& operator=(const DigestIndex&) = delete;
+
+    /**
+     * Check whether a binary digest of getDigestSize() bytes is in the set
+     * Safe to call from several threads at once.
+     */
+    bool contains(const uint8_t* digest) const;
+
+    uint64_t getCount() const { return count_; }
+    size_t getDigestSize() const { return digestSize_; }
+    const std::string& getAlgorithm() const { return algorithm_; }
+    bool hasBloomFilter() const { return bloomBlocks_ > 0; }
+
+    /**
+     * Build an index from hex digests, one per line
+     *
+     * The digest is the first field of each line (up to whitespace or a
+     * comma, quotes stripped), so sha256sum output can be fed directly.
+     * Blank lines and lines starting with '#' are skipped; duplicates are
+     * removed.
+     * @param path Index file to write (replaced atomically)
+     * @param algorithm Algorithm the digests were made with
+     * @param input Text input
+     * @param bloomBitsPerKey Bloom filter size (0 for no filter)
+     * @return Number of distinct digests written
+     * @throws std::invalid_argument on unsupported algorithm
+     * @throws std::runtime_error on a malformed line or I/O errors
+     */
+    static uint64_t build(const std::string& path, const std::string& algorithm, std::istream& input,
+                          size_t bloomBitsPerKey = DEFAULT_BLOOM_BITS);
+
+private:
+    bool bloomContains(const uint8_t* digest) const;
+
+    const uint8_t* base_;
+    size_t size_;
+    std::string algorithm_;
+    size_t digestSize_;
+    uint32_t bloomProbes_;
+    uint64_t count_;
+    uint64_t bloomBlocks_;
+    const uint8_t* bloom_;
+    const uint8_t* digests_;
+};
+
+#endif // DIGEST_INDEX_H
@@ -0,0 +1,362 @@
+#include "dir_digest.h"
+#include "file_io.h"
+#include "hash_base.h"
+#include "hash_factory.h"
+#include "hash_state.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <future>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t DirectoryDigest::READ_BUFFER_SIZE;
+constexpr int64_t DirectoryDigest::CACHE_SETTLE_SECONDS;
+
+struct DirectoryDigest::Node {
+    std::string name;
+    std::string path;                   // For opening
+    std::string key;                    // Path relative to the root, the cache key
+    size_t parent;
+    char type;                          // 'd', 'f' or 'l'
+    uint32_t mode;
+    uint64_t size;
+    std::vector<uint8_t> stamp;         // Identity, size, mtime and ctime, encoded
+    bool stable;                        // Old enough to be cached (for a directory: everything below)
+    std::vector<size_t> children;       // Sorted by name
+    std::vector<uint8_t> signature;     // Directories: hash of every stamp below
+    std::vector<uint8_t> digest;
+    bool known;                         // Digest taken from the cache
+    bool covered;                       // Below a directory taken from the cache
+    std::string error;
+};
+
+namespace {
+
+using HashState::appendU32;
+using HashState::appendU64;
+
+std::vector<uint8_t> stampOf(const struct stat& info) {
+    std::vector<uint8_t> stamp;
+    appendU64(stamp, static_cast<uint64_t>(info.st_dev));
+    appendU64(stamp, static_cast<uint64_t>(info.st_ino));
+    appendU64(stamp, static_cast<uint64_t>(info.st_size));
+#ifdef __APPLE__
+    appendU64(stamp, static_cast<uint64_t>(info.st_mtimespec.tv_sec));
+    appendU32(stamp, static_cast<uint32_t>(info.st_mtimespec.tv_nsec));
+    appendU64(stamp, static_cast<uint64_t>(info.st_ctimespec.tv_sec));
+    appendU32(stamp, static_cast<uint32_t>(info.st_ctimespec.tv_nsec));
+#else
+    appendU64(stamp, static_cast<uint64_t>(info.st_mtim.tv_sec));
+    appendU32(stamp, static_cast<uint32_t>(info.st_mtim.tv_nsec));
+    appendU64(stamp, static_cast<uint64_t>(info.st_ctim.tv_sec));
+    appendU32(stamp, static_cast<uint32_t>(info.st_ctim.tv_nsec));
+#endif
+    return stamp;
+}
+
+// Whether both timestamps are far enough behind the scan to trust the stamp
+bool settled(const struct stat& info, time_t scanStart) {
+#ifdef __APPLE__
+    const time_t newest = std::max(info.st_mtimespec.tv_sec, info.st_ctimespec.tv_sec);
+#else
+    const time_t newest = std::max(info.st_mtim.tv_sec, info.st_ctim.tv_sec);
+#endif
+    return newest + DirectoryDigest::CACHE_SETTLE_SECONDS < scanStart;
+}
+
+struct CacheEntry {
+    char type;
+    std::vector<uint8_t> check;         // Stamp for a file, subtree signature for a directory
+    std::vector<uint8_t> digest;
+};
+
+typedef std::map<std::string, CacheEntry> Cache;
+
+// Layout after the HashState header: u64 count, then per entry u8 type,
+// blob key, blob check and the digest. A damaged cache is simply ignored.
+Cache loadCache(const std::string& path, const std::string& algorithm, size_t hashSize) {
+    Cache cache;
+    std::vector<uint8_t> data;
+    if (path.empty() || !FileIO::readFile(path, data)) {
+        return cache;
+    }
+    try {
+        HashState::Reader reader(data.data(), data.size(), algorithm);
+        const uint64_t count = reader.getU64();
+        for (uint64_t i = 0; i < count; ++i) {
+            CacheEntry entry;
+            entry.type = static_cast<char>(reader.getU8());
+            const std::vector<uint8_t> key = reader.getBlob();
+            entry.check = reader.getBlob();
+            const uint8_t* digest = reader.getBytes(hashSize);
+            entry.digest.assign(digest, digest + hashSize);
+            cache[std::string(key.begin(), key.end())] = std::move(entry);
+        }
+        reader.finish();
+    } catch (const std::invalid_argument&) {
+        cache.clear();
+    }
+    return cache;
+}
+
+void saveCache(const std::string& path, const std::string& algorithm, const Cache& cache) {
+    HashState::Writer writer(algorithm);
+    writer.putU64(cache.size());
+    for (const auto& entry : cache) {
+        writer.putU8(static_cast<uint8_t>(entry.second.type));
+        writer.putBlob(std::vector<uint8_t>(entry.first.begin(), entry.first.end()));
+        writer.putBlob(entry.second.check);
+        writer.putBytes(entry.second.digest.data(), entry.second.digest.size());
+    }
+    FileIO::replaceFile(path, writer.take());
+}
+
+const CacheEntry* lookup(const Cache& cache, const std::string& key, char type, const std::vector<uint8_t>& check) {
+    auto found = cache.find(key);
+    if (found == cache.end() || found->second.type != type || found->second.check != check) {
+        return nullptr;
+    }
+    return &found->second;
+}
+
+} // namespace
+
+DirectoryDigest::DirectoryDigest(const std::string& algorithm, size_t threads, const std::string& cachePath)
+    : algorithm_(algorithm), threads_(threads), cachePath_(cachePath), hashSize_(0), fileCount_(0),
+      filesHashed_(0), bytesRead_(0), directoriesReused_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    hashSize_ = HashFactory::createHash(algorithm)->getHashSize();
+}
+
+void DirectoryDigest::walk(const std::string& root, std::vector<Node>& nodes) {
+    struct stat info;
+    if (::stat(root.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        throw std::runtime_error("Not a directory: " + root);
+    }
+    const time_t scanStart = ::time(nullptr);
+
+    Node top;
+    top.path = root;
+    top.parent = 0;
+    top.type = 'd';
+    top.mode = static_cast<uint32_t>(info.st_mode & 07777);
+    top.size = 0;
+    top.stable = true;
+    top.known = false;
+    top.covered = false;
+    nodes.push_back(std::move(top));
+
+    std::vector<size_t> directories(1, 0);
+    while (!directories.empty()) {
+        const size_t index = directories.back();
+        directories.pop_back();
+        const std::string directory = nodes[index].path;
+        DIR* stream = ::opendir(directory.c_str());
+        if (!stream) {
+            throw std::runtime_error(directory + ": " + std::strerror(errno));
+        }
+        std::vector<std::string> names;
+        errno = 0;
+        while (dirent* entry = ::readdir(stream)) {
+            if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+                names.push_back(entry->d_name);
+            }
+        }
+        const int readError = errno;
+        ::closedir(stream);
+        if (readError != 0) {
+            throw std::runtime_error(directory + ": " + std::strerror(readError));
+        }
+        std::sort(names.begin(), names.end());
+
+        const std::string prefix = directory.back() == '/' ? directory : directory + "/";
+        for (const auto& name : names) {
+            Node node;
+            node.name = name;
+            node.path = prefix + name;
+            node.key = nodes[index].key.empty() ? name : nodes[index].key + "/" + name;
+            node.parent = index;
+            node.known = false;
+            node.covered = false;
+            if (::lstat(node.path.c_str(), &info) != 0) {
+                throw std::runtime_error(node.path + ": " + std::strerror(errno));
+            }
+            if (S_ISDIR(info.st_mode)) {
+                node.type = 'd';
+                node.size = 0;
+            } else if (S_ISREG(info.st_mode)) {
+                node.type = 'f';
+                node.size = static_cast<uint64_t>(info.st_size);
+            } else if (S_ISLNK(info.st_mode)) {
+                // The target itself is the content; it is short, so hash it now
+                std::vector<char> target(static_cast<size_t>(info.st_size) + 1);
+                const ssize_t length = ::readlink(node.path.c_str(), target.data(), target.size());
+                if (length < 0) {
+                    throw std::runtime_error(node.path + ": " + std::strerror(errno));
+                }
+                node.type = 'l';
+                node.size = static_cast<uint64_t>(length);
+                auto hasher = HashFactory::createHash(algorithm_);
+                hasher->update(reinterpret_cast<const uint8_t*>(target.data()), static_cast<size_t>(length));
+                hasher->finalize();
+                node.digest.resize(hashSize_);
+                hasher->getDigest(node.digest.data());
+            } else {
+                continue;
+            }
+            node.mode = static_cast<uint32_t>(info.st_mode & 07777);
+            node.stamp = stampOf(info);
+            node.stable = settled(info, scanStart);
+            nodes[index].children.push_back(nodes.size());
+            if (node.type == 'd') {
+                directories.push_back(nodes.size());
+            }
+            nodes.push_back(std::move(node));
+        }
+    }
+}
+
+void DirectoryDigest::hashFiles(std::vector<Node>& nodes, const std::vector<size_t>& indices) {
+    ThreadPool pool(threads_);
+    std::atomic<uint64_t> bytesRead(0);
+    std::vector<std::future<void>> tasks;
+    for (size_t index : indices) {
+        Node* file = &nodes[index];
+        tasks.push_back(pool.submit([this, file, &bytesRead]() {
+            try {
+                const FileIO::Descriptor input = FileIO::openRead(file->path, O_NOFOLLOW);
+                // One byte more than the file, so a small file takes a single read
+                const size_t bufferSize = static_cast<size_t>(std::min<uint64_t>(READ_BUFFER_SIZE, file->size + 1));
+                const uint64_t hashed = FileIO::hashFile(input.get(), algorithm_, file->digest, bufferSize);
+                bytesRead += hashed;
+                if (hashed != file->size) {
+                    throw std::runtime_error("File changed while hashing");
+                }
+            } catch (const std::exception& e) {
+                file->error = e.what();
+            }
+        }));
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    bytesRead_ += bytesRead.load();
+    filesHashed_ += indices.size();
+}
+
+std::string DirectoryDigest::hashTree(const std::string& root) {
+    fileCount_ = 0;
+    filesHashed_ = 0;
+    bytesRead_ = 0;
+    directoriesReused_ = 0;
+
+    std::vector<Node> nodes;
+    walk(root, nodes);
+    const std::string name = HashFactory::createHash(algorithm_)->getAlgorithmName();
+    const Cache cache = loadCache(cachePath_, name, hashSize_);
+
+    // Children always follow their parent, so a reverse pass is bottom-up
+    if (!cachePath_.empty()) {
+        for (size_t i = nodes.size(); i-- > 0;) {
+            Node& node = nodes[i];
+            if (node.type != 'd') {
+                continue;
+            }
+            auto hasher = HashFactory::createHash(algorithm_);
+            for (size_t child : node.children) {
+                const Node& entry = nodes[child];
+                std::vector<uint8_t> record(1, static_cast<uint8_t>(entry.type));
+                appendU32(record, entry.mode);
+                appendU32(record, static_cast<uint32_t>(entry.name.size()));
+                record.insert(record.end(), entry.name.begin(), entry.name.end());
+                record.insert(record.end(), entry.stamp.begin(), entry.stamp.end());
+                record.insert(record.end(), entry.signature.begin(), entry.signature.end());
+                hasher->update(record.data(), record.size());
+                node.stable = node.stable && entry.stable;
+            }
+            hasher->finalize();
+            node.signature.resize(hashSize_);
+            hasher->getDigest(node.signature.data());
+        }
+    }
+
+    // Top-down: a cached directory covers its whole subtree
+    std::vector<size_t> toHash;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        Node& node = nodes[i];
+        node.covered = i > 0 && (nodes[node.parent].covered || nodes[node.parent].known);
+        if (node.type == 'f') {
+            ++fileCount_;
+        }
+        if (node.covered || node.type == 'l') {
+            continue;
+        }
+        const CacheEntry* hit = lookup(cache, node.key, node.type, node.type == 'd' ? node.signature : node.stamp);
+        if (hit) {
+            node.digest = hit->digest;
+            node.known = true;
+            directoriesReused_ += node.type == 'd' ? 1 : 0;
+        } else if (node.type == 'f') {
+            toHash.push_back(i);
+        }
+    }
+    hashFiles(nodes, toHash);
+    for (size_t index : toHash) {
+        if (!nodes[index].error.empty()) {
+            throw std::runtime_error(nodes[index].path + ": " + nodes[index].error);
+        }
+    }
+
+    // Bottom-up: each directory hashes its sorted entry records
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Node& node = nodes[i];
+        if (node.type != 'd' || node.covered || node.known) {
+            continue;
+        }
+        auto hasher = HashFactory::createHash(algorithm_);
+        for (size_t child : node.children) {
+            const Node& entry = nodes[child];
+            std::vector<uint8_t> record(1, static_cast<uint8_t>(entry.type));
+            appendU32(record, entry.mode);
+            appendU64(record, entry.size);
+            appendU32(record, static_cast<uint32_t>(entry.name.size()));
+            record.insert(record.end(), entry.name.begin(), entry.name.end());
+            record.insert(record.end(), entry.digest.begin(), entry.digest.end());
+            hasher->update(record.data(), record.size());
+        }
+        hasher->finalize();
+        node.digest.resize(hashSize_);
+        hasher->getDigest(node.digest.data());
+    }
+
+    if (!cachePath_.empty()) {
+        // Covered entries are unchanged since they were stored, so they carry over
+        Cache updated;
+        for (const auto& node : nodes) {
+            if (node.type == 'l' || !node.stable) {
+                continue;
+            }
+            if (node.covered) {
+                auto found = cache.find(node.key);
+                if (found != cache.end()) {
+                    updated.insert(*found);
+                }
+            } else {
+                updated[node.key] = CacheEntry{node.type, node.type == 'd' ? node.signature : node.stamp, node.digest};
+            }
+        }
+        saveCache(cachePath_, name, updated);
+    }
+    return HashBase::toHex(nodes[0].digest.data(), nodes[0].digest.size());
+}
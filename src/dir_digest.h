@@ -0,0 +1,96 @@
+#ifndef DIR_DIGEST_H
+#define DIR_DIGEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Deterministic Merkle digest of a directory tree
+ *
+ * Every entry of a directory is encoded as (integers big-endian):
+ *
+ *   u8      type: 'd' directory, 'f' regular file, 'l' symbolic link
+ *   u32     permission bits (st_mode & 07777)
+ *   u64     size: file length, link target length, 0 for directories
+ *   u32     name length, then the name bytes
+ *   ...     digest: file content, link target or subdirectory digest
+ *
+ * A directory's digest is the hash of its entries' encodings, sorted
+ * bytewise by name, so it depends only on names, types, permissions and
+ * contents, never on readdir order, timestamps or ownership. A regular
+ * file's digest is the plain digest of its content. Symbolic links are not
+ * followed; sockets, FIFOs and device nodes are skipped.
+ *
+ * The tree is walked first (lstat only), then file contents are hashed in
+ * parallel and the directory digests combined bottom-up.
+ *
+ * With a cache file, the digests of the last run are kept together with
+ * each entry's identity, size, mtime and ctime. A file whose stamp is
+ * unchanged takes its stored digest without being read, and a directory
+ * whose whole subtree is unchanged (the stamps of everything below hash to
+ * the stored subtree signature) takes its stored digest without its
+ * entries being encoded and hashed again. The whole tree is still listed
+ * and lstat'ed on every run: the subtree signature needs every stamp, and
+ * a directory's own stamp does not change when a file below it is
+ * rewritten. Entries modified within CACHE_SETTLE_SECONDS of the scan are
+ * not stored, as a later write within the same timestamp tick could go
+ * unnoticed.
+ */
+class DirectoryDigest {
+public:
+    static constexpr size_t READ_BUFFER_SIZE = 1024 * 1024;
+    static constexpr int64_t CACHE_SETTLE_SECONDS = 2;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @param cachePath Digest cache file, loaded and replaced by each run (empty for none)
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    DirectoryDigest(const std::string& algorithm, size_t threads = 0, const std::string& cachePath = "");
+
+    /**
+     * Compute the digest of a directory tree
+     * @return Root directory digest as a hex string
+     * @throws std::runtime_error if root is not a directory, an entry cannot
+     *         be read or a file changes while it is hashed
+     */
+    std::string hashTree(const std::string& root);
+
+    /**
+     * Get the number of regular files in the last tree
+     */
+    uint64_t getFileCount() const { return fileCount_; }
+
+    /**
+     * Get the number of files actually read and the bytes read from them
+     */
+    uint64_t getFilesHashed() const { return filesHashed_; }
+    uint64_t getBytesRead() const { return bytesRead_; }
+
+    /**
+     * Get the number of directories whose digest came from the cache
+     * (subtrees below them are not counted)
+     */
+    uint64_t getDirectoriesReused() const { return directoriesReused_; }
+
+private:
+    struct Node;
+
+    void walk(const std::string& root, std::vector<Node>& nodes);
+    void hashFiles(std::vector<Node>& nodes, const std::vector<size_t>& indices);
+
+    std::string algorithm_;
+    size_t threads_;
+    std::string cachePath_;
+    size_t hashSize_;
+    uint64_t fileCount_;
+    uint64_t filesHashed_;
+    uint64_t bytesRead_;
+    uint64_t directoriesReused_;
+};
+
+#endif // DIR_DIGEST_H
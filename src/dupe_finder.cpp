@@ -0,0 +1,237 @@
+#include "dupe_finder.h"
+#include "batch_hash.h"
+#include "file_io.h"
+#include "hash_factory.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr size_t DuplicateFinder::SAMPLE_SIZE;
+constexpr size_t DuplicateFinder::SAMPLE_BATCH;
+constexpr size_t DuplicateFinder::READ_BUFFER_SIZE;
+
+struct DuplicateFinder::Candidate {
+    std::string path;
+    uint64_t size;
+    std::vector<uint8_t> sample;    // Digest of the head and tail, or of the whole small file
+    std::vector<uint8_t> full;
+    std::string error;
+};
+
+namespace {
+
+// Files no larger than this are sampled whole
+constexpr uint64_t WHOLE_SAMPLE_LIMIT = 2 * DuplicateFinder::SAMPLE_SIZE;
+
+} // namespace
+
+DuplicateFinder::DuplicateFinder(const std::string& algorithm, size_t threads)
+    : algorithm_(algorithm), threads_(threads), hashSize_(0), filesScanned_(0), bytesScanned_(0), bytesRead_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    hashSize_ = HashFactory::createHash(algorithm)->getHashSize();
+}
+
+void DuplicateFinder::walk(const std::string& root, std::vector<Candidate>& files) {
+    struct stat info;
+    if (::stat(root.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        throw std::runtime_error("Not a directory: " + root);
+    }
+
+    std::set<std::pair<dev_t, ino_t>> seen;
+    std::vector<std::string> directories(1, root);
+    while (!directories.empty()) {
+        const std::string directory = directories.back();
+        directories.pop_back();
+        DIR* stream = ::opendir(directory.c_str());
+        if (!stream) {
+            errors_.push_back(directory + ": " + std::strerror(errno));
+            continue;
+        }
+        const std::string prefix = directory.back() == '/' ? directory : directory + "/";
+        while (dirent* entry = ::readdir(stream)) {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0) {
+                continue;
+            }
+            const std::string path = prefix + entry->d_name;
+            if (::lstat(path.c_str(), &info) != 0) {
+                errors_.push_back(path + ": " + std::strerror(errno));
+            } else if (S_ISDIR(info.st_mode)) {
+                directories.push_back(path);
+            } else if (S_ISREG(info.st_mode) && info.st_size > 0 &&
+                       seen.insert(std::make_pair(info.st_dev, info.st_ino)).second) {
+                files.push_back(Candidate{path, static_cast<uint64_t>(info.st_size), {}, {}, std::string()});
+            }
+        }
+        ::closedir(stream);
+    }
+}
+
+void DuplicateFinder::hashSamples(std::vector<Candidate>& files, const std::vector<size_t>& indices) {
+    ThreadPool pool(threads_);
+    std::atomic<uint64_t> bytesRead(0);
+    std::vector<std::future<void>> tasks;
+    for (size_t start = 0; start < indices.size(); start += SAMPLE_BATCH) {
+        const size_t count = std::min(SAMPLE_BATCH, indices.size() - start);
+        const size_t* slice = indices.data() + start;
+        tasks.push_back(pool.submit([this, &files, &bytesRead, slice, count]() {
+            // Head and tail of each file side by side, then one hashBatch call for the slice
+            std::vector<uint8_t> samples(count * WHOLE_SAMPLE_LIMIT);
+            std::vector<HashSpan> inputs;
+            std::vector<Candidate*> hashed;
+            for (size_t i = 0; i < count; ++i) {
+                Candidate& file = files[slice[i]];
+                uint8_t* sample = samples.data() + i * WHOLE_SAMPLE_LIMIT;
+                try {
+                    const FileIO::Descriptor input = FileIO::openRead(file.path);
+                    size_t length;
+                    if (file.size <= WHOLE_SAMPLE_LIMIT) {
+                        length = FileIO::readAt(input.get(), sample, static_cast<size_t>(file.size), 0);
+                    } else {
+                        length = FileIO::readAt(input.get(), sample, SAMPLE_SIZE, 0) +
+                                 FileIO::readAt(input.get(), sample + SAMPLE_SIZE, SAMPLE_SIZE,
+                                                static_cast<off_t>(file.size - SAMPLE_SIZE));
+                    }
+                    bytesRead += length;
+                    if (length != std::min<uint64_t>(file.size, WHOLE_SAMPLE_LIMIT)) {
+                        throw std::runtime_error("File changed while scanning");
+                    }
+                    inputs.push_back(HashSpan{sample, length});
+                    hashed.push_back(&file);
+                } catch (const std::exception& e) {
+                    file.error = e.what();
+                }
+            }
+
+            std::vector<uint8_t> digests(inputs.size() * hashSize_);
+            hashBatch(algorithm_, inputs.data(), inputs.size(), digests.data());
+            for (size_t i = 0; i < hashed.size(); ++i) {
+                hashed[i]->sample.assign(digests.begin() + i * hashSize_, digests.begin() + (i + 1) * hashSize_);
+            }
+        }));
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    bytesRead_ += bytesRead.load();
+}
+
+void DuplicateFinder::hashFull(std::vector<Candidate>& files, const std::vector<size_t>& indices) {
+    ThreadPool pool(threads_);
+    std::atomic<uint64_t> bytesRead(0);
+    std::vector<std::future<void>> tasks;
+    for (size_t index : indices) {
+        Candidate* file = &files[index];
+        tasks.push_back(pool.submit([this, file, &bytesRead]() {
+            try {
+                const FileIO::Descriptor input = FileIO::openRead(file->path);
+                const uint64_t hashed = FileIO::hashFile(input.get(), algorithm_, file->full, READ_BUFFER_SIZE);
+                bytesRead += hashed;
+                if (hashed != file->size) {
+                    throw std::runtime_error("File changed while scanning");
+                }
+            } catch (const std::exception& e) {
+                file->error = e.what();
+            }
+        }));
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    bytesRead_ += bytesRead.load();
+}
+
+std::vector<DuplicateGroup> DuplicateFinder::find(const std::string& root) {
+    filesScanned_ = 0;
+    bytesScanned_ = 0;
+    bytesRead_ = 0;
+    errors_.clear();
+
+    std::vector<Candidate> files;
+    walk(root, files);
+    filesScanned_ = files.size();
+    for (const auto& file : files) {
+        bytesScanned_ += file.size;
+    }
+
+    // Stage 1: only sizes shared by two or more files go on
+    std::map<uint64_t, std::vector<size_t>> bySize;
+    for (size_t i = 0; i < files.size(); ++i) {
+        bySize[files[i].size].push_back(i);
+    }
+    std::vector<size_t> sampled;
+    for (const auto& group : bySize) {
+        if (group.second.size() > 1) {
+            sampled.insert(sampled.end(), group.second.begin(), group.second.end());
+        }
+    }
+
+    // Stage 2: head and tail digests; small files are already hashed whole
+    hashSamples(files, sampled);
+    std::map<std::pair<uint64_t, std::vector<uint8_t>>, std::vector<size_t>> bySample;
+    for (size_t index : sampled) {
+        if (files[index].error.empty()) {
+            bySample[std::make_pair(files[index].size, files[index].sample)].push_back(index);
+        }
+    }
+
+    // Stage 3: full digests only where size and sample both collide
+    std::vector<size_t> fullyHashed;
+    for (auto& group : bySample) {
+        if (group.second.size() < 2) {
+            continue;
+        }
+        for (size_t index : group.second) {
+            if (files[index].size <= WHOLE_SAMPLE_LIMIT) {
+                files[index].full = files[index].sample;
+            } else {
+                fullyHashed.push_back(index);
+            }
+        }
+    }
+    hashFull(files, fullyHashed);
+
+    std::map<std::pair<uint64_t, std::vector<uint8_t>>, std::vector<size_t>> byContent;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (files[i].error.empty() && !files[i].full.empty()) {
+            byContent[std::make_pair(files[i].size, files[i].full)].push_back(i);
+        }
+    }
+
+    std::vector<DuplicateGroup> groups;
+    for (const auto& entry : byContent) {
+        if (entry.second.size() < 2) {
+            continue;
+        }
+        DuplicateGroup group;
+        group.size = entry.first.first;
+        group.digest = entry.first.second;
+        for (size_t index : entry.second) {
+            group.paths.push_back(files[index].path);
+        }
+        std::sort(group.paths.begin(), group.paths.end());
+        groups.push_back(std::move(group));
+    }
+    std::sort(groups.begin(), groups.end(), [](const DuplicateGroup& a, const DuplicateGroup& b) {
+        return a.size != b.size ? a.size > b.size : a.paths.front() < b.paths.front();
+    });
+
+    for (const auto& file : files) {
+        if (!file.error.empty()) {
+            errors_.push_back(file.path + ": " + file.error);
+        }
+    }
+    return groups;
+}
@@ -0,0 +1,89 @@
+#ifndef DUPE_FINDER_H
+#define DUPE_FINDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Files with identical content
+ */
+struct DuplicateGroup {
+    uint64_t size;
+    std::vector<uint8_t> digest;
+    std::vector<std::string> paths;     // Sorted
+};
+
+/**
+ * Staged duplicate-file finder
+ *
+ * Full hashing is the last resort:
+ *
+ *   1. Walk the tree and group regular files by size; a file with a unique
+ *      size cannot have a duplicate and is never opened.
+ *   2. Hash a sample of every remaining file (its first and last SAMPLE_SIZE
+ *      bytes) through hashBatch, so the small reads share multi-buffer lanes.
+ *      A file no larger than two samples is hashed whole here, so its
+ *      sample digest is its full digest.
+ *   3. Hash in full, in parallel, only the files whose size and sample
+ *      digest both collide with another file's.
+ *
+ * Symbolic links are not followed, extra hard links to an already seen file
+ * are skipped (they share storage) and empty files are ignored.
+ */
+class DuplicateFinder {
+public:
+    static constexpr size_t SAMPLE_SIZE = 4096;
+    static constexpr size_t SAMPLE_BATCH = 256;             // Files per hashBatch call
+    static constexpr size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    DuplicateFinder(const std::string& algorithm, size_t threads = 0);
+
+    /**
+     * Find duplicate files below a directory
+     * Files that cannot be read are skipped and listed in getErrors().
+     * @return Groups of two or more files, largest files first
+     * @throws std::runtime_error if root cannot be opened
+     */
+    std::vector<DuplicateGroup> find(const std::string& root);
+
+    /**
+     * Get the number of regular files seen by the last search
+     */
+    uint64_t getFilesScanned() const { return filesScanned_; }
+
+    /**
+     * Get the total size of the files seen and the bytes actually read
+     */
+    uint64_t getBytesScanned() const { return bytesScanned_; }
+    uint64_t getBytesRead() const { return bytesRead_; }
+
+    /**
+     * Get the files or directories skipped by the last search, with reasons
+     */
+    const std::vector<std::string>& getErrors() const { return errors_; }
+
+private:
+    struct Candidate;
+
+    void walk(const std::string& root, std::vector<Candidate>& files);
+    void hashSamples(std::vector<Candidate>& files, const std::vector<size_t>& indices);
+    void hashFull(std::vector<Candidate>& files, const std::vector<size_t>& indices);
+
+    std::string algorithm_;
+    size_t threads_;
+    size_t hashSize_;
+    uint64_t filesScanned_;
+    uint64_t bytesScanned_;
+    uint64_t bytesRead_;
+    std::vector<std::string> errors_;
+};
+
+#endif // DUPE_FINDER_H
@@ -0,0 +1,156 @@
+#include "file_io.h"
+#include "hash_factory.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+FileIO::Descriptor::~Descriptor() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+FileIO::Descriptor& FileIO::Descriptor::operator=(Descriptor&& other) {
+    if (this != &other) {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = other.release();
+    }
+    return *this;
+}
+
+int FileIO::Descriptor::release() {
+    const int fd = fd_;
+    fd_ = -1;
+    return fd;
+}
+
+void FileIO::Descriptor::close() {
+    if (::close(release()) != 0) {
+        throw std::runtime_error(std::string("Close failed: ") + std::strerror(errno));
+    }
+}
+
+FileIO::Descriptor FileIO::openRead(const std::string& path, int flags) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | flags);
+    if (fd < 0) {
+        throw std::runtime_error(std::strerror(errno));
+    }
+    return Descriptor(fd);
+}
+
+size_t FileIO::readAt(int fd, uint8_t* buffer, size_t length, off_t offset) {
+    size_t total = 0;
+    while (total < length) {
+        ssize_t n = ::pread(fd, buffer + total, length - total, offset + static_cast<off_t>(total));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Read failed: ") + std::strerror(errno));
+        }
+        if (n == 0) {
+            break;
+        }
+        total += static_cast<size_t>(n);
+    }
+    return total;
+}
+
+size_t FileIO::readSome(int fd, uint8_t* buffer, size_t length) {
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, length);
+        if (n >= 0) {
+            return static_cast<size_t>(n);
+        }
+        if (errno != EINTR) {
+            throw std::runtime_error(std::string("Read failed: ") + std::strerror(errno));
+        }
+    }
+}
+
+void FileIO::writeAll(int fd, const uint8_t* data, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+        ssize_t n = ::write(fd, data + total, length - total);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Write failed: ") + std::strerror(errno));
+        }
+        total += static_cast<size_t>(n);
+    }
+}
+
+uint64_t FileIO::hashFile(int fd, const std::string& algorithm, std::vector<uint8_t>& digest, size_t bufferSize) {
+    auto hasher = HashFactory::createHash(algorithm);
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    std::vector<uint8_t> buffer(bufferSize > 0 ? bufferSize : 1);
+    uint64_t offset = 0;
+    for (;;) {
+        const size_t got = readAt(fd, buffer.data(), buffer.size(), static_cast<off_t>(offset));
+        hasher->update(buffer.data(), got);
+        offset += got;
+        if (got < buffer.size()) {
+            break;
+        }
+    }
+    hasher->finalize();
+    digest.resize(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return offset;
+}
+
+bool FileIO::readFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+void FileIO::replaceFile(const std::string& path, const std::vector<uint8_t>& data) {
+    replaceFile(path, std::vector<const std::vector<uint8_t>*>{&data});
+}
+
+void FileIO::replaceFile(const std::string& path, const std::vector<const std::vector<uint8_t>*>& parts) {
+    const std::string temporary = path + ".tmp";
+    try {
+        Descriptor out(::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+        if (out.get() < 0) {
+            throw std::runtime_error(std::strerror(errno));
+        }
+        for (const std::vector<uint8_t>* part : parts) {
+            writeAll(out.get(), part->data(), part->size());
+        }
+        if (::fsync(out.get()) != 0) {
+            throw std::runtime_error(std::string("Sync failed: ") + std::strerror(errno));
+        }
+        out.close();
+    } catch (const std::exception& e) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot write state file " + temporary + ": " + e.what());
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("Cannot replace state file: " + path);
+    }
+
+    // Make the rename itself durable; best effort where directories cannot be synced
+    const size_t slash = path.find_last_of('/');
+    const std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    const Descriptor parent(::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (parent.get() >= 0) {
+        ::fsync(parent.get());
+    }
+}
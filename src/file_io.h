@@ -0,0 +1,109 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/**
+ * POSIX file helpers for the modes that hash files by descriptor and keep
+ * small state files next to the data
+ */
+namespace FileIO {
+
+    /**
+     * Owns a file descriptor and closes it on every exit path
+     */
+    class Descriptor {
+    public:
+        explicit Descriptor(int fd = -1) : fd_(fd) {}
+        ~Descriptor();
+
+        Descriptor(Descriptor&& other) : fd_(other.release()) {}
+        Descriptor& operator=(Descriptor&& other);
+        Descriptor(const Descriptor&) = delete;
+        Descriptor& operator=(const Descriptor&) = delete;
+
+        int get() const { return fd_; }
+
+        /**
+         * Give up ownership without closing
+         */
+        int release();
+
+        /**
+         * Close now, reporting the error a deferred close would swallow
+         * @throws std::runtime_error if close fails
+         */
+        void close();
+
+    private:
+        int fd_;
+    };
+
+    /**
+     * Open a file read-only (close-on-exec)
+     * @param flags Extra open flags, such as O_NOFOLLOW
+     * @throws std::runtime_error with the system error message if it cannot be opened
+     */
+    Descriptor openRead(const std::string& path, int flags = 0);
+
+    /**
+     * Read up to length bytes at offset, retrying short reads and EINTR
+     * @return Bytes read; less than length only at end of file
+     * @throws std::runtime_error on read errors
+     */
+    size_t readAt(int fd, uint8_t* buffer, size_t length, off_t offset);
+
+    /**
+     * Read up to length bytes from the current position, retrying EINTR
+     * @return Bytes read; 0 only at end of input
+     * @throws std::runtime_error on read errors
+     */
+    size_t readSome(int fd, uint8_t* buffer, size_t length);
+
+    /**
+     * Write all length bytes, retrying short writes and EINTR
+     * @throws std::runtime_error on write errors
+     */
+    void writeAll(int fd, const uint8_t* data, size_t length);
+
+    /**
+     * Hash a whole file from offset 0 with positioned reads
+     * @param fd Readable descriptor (its file position is not used)
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param digest Receives the binary digest
+     * @param bufferSize Bytes per read
+     * @return Bytes hashed
+     * @throws std::invalid_argument on unsupported algorithm
+     * @throws std::runtime_error on read errors
+     */
+    uint64_t hashFile(int fd, const std::string& algorithm, std::vector<uint8_t>& digest,
+                      size_t bufferSize = 1024 * 1024);
+
+    /**
+     * Read a whole state file
+     * @param path File to read
+     * @param data Receives the file contents
+     * @return False if the file does not exist or cannot be read
+     */
+    bool readFile(const std::string& path, std::vector<uint8_t>& data);
+
+    /**
+     * Replace a state file atomically (write a temporary file, sync it, then
+     * rename and sync the directory) so neither an interrupted run nor a
+     * crash leaves a torn state behind
+     * @throws std::runtime_error on I/O errors
+     */
+    void replaceFile(const std::string& path, const std::vector<uint8_t>& data);
+
+    /**
+     * Replace a state file with the concatenation of several buffers
+     * @throws std::runtime_error on I/O errors
+     */
+    void replaceFile(const std::string& path, const std::vector<const std::vector<uint8_t>*>& parts);
+}
+
+#endif // FILE_IO_H
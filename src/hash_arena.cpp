@@ -0,0 +1,288 @@
+#include "hash_arena.h"
+#include "hash_dispatch.h"
+#include "multi_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+constexpr size_t HashArena::CACHE_LINE_SIZE;
+
+class HashArena::Engine {
+public:
+    virtual ~Engine() = default;
+    virtual size_t contextSize() const = 0;
+    virtual size_t hashSize() const = 0;
+    virtual void construct(void* slot) const = 0;
+    virtual void destroy(void* slot) const = 0;
+    virtual void update(void* slot, const uint8_t* data, size_t length) const = 0;
+    virtual void finalize(void* slot, uint8_t* digest) const = 0;
+};
+
+namespace {
+
+// Compression parameters for algorithms with a static compression function;
+// the primary template marks algorithms that keep their full object instead
+template <typename H, typename Enable = void>
+struct CompactTraits {
+    static constexpr bool COMPACT = false;
+};
+
+template <>
+struct CompactTraits<MD5> {
+    static constexpr bool COMPACT = true;
+    typedef uint32_t Word;
+    static constexpr size_t STATE_WORDS = 4;
+    static constexpr size_t BLOCK_SIZE = HASH_CONSTANTS::MD5_BLOCK_SIZE;
+    static constexpr bool LITTLE_ENDIAN_ORDER = true;
+    static void compress(Word* state, const uint8_t* block) { MD5::compress(state, block); }
+    static const Word* initialState() {
+        static const Word iv[4] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+        return iv;
+    }
+};
+
+template <>
+struct CompactTraits<SHA1> {
+    static constexpr bool COMPACT = true;
+    typedef uint32_t Word;
+    static constexpr size_t STATE_WORDS = 5;
+    static constexpr size_t BLOCK_SIZE = HASH_CONSTANTS::SHA1_BLOCK_SIZE;
+    static constexpr bool LITTLE_ENDIAN_ORDER = false;
+    static void compress(Word* state, const uint8_t* block) { SHA1::compress(state, block); }
+    static const Word* initialState() {
+        static const Word iv[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+        return iv;
+    }
+};
+
+template <typename H>
+struct CompactTraits<H, typename std::enable_if<!std::is_void<typename MultiBuffer::KernelFor<H>::type>::value>::type> {
+    typedef typename MultiBuffer::KernelFor<H>::type Kernel;
+    static constexpr bool COMPACT = true;
+    typedef typename Kernel::Word Word;
+    static constexpr size_t STATE_WORDS = 8;
+    static constexpr size_t BLOCK_SIZE = Kernel::BLOCK_SIZE;
+    static constexpr bool LITTLE_ENDIAN_ORDER = false;
+    static void compress(Word* state, const uint8_t* block) { Kernel::compress(state, block); }
+    static const Word* initialState() {
+        static const H prototype;
+        return prototype.getInitialState();
+    }
+};
+
+template <typename H>
+class CompactEngine : public HashArena::Engine {
+public:
+    typedef CompactTraits<H> Traits;
+    typedef typename Traits::Word Word;
+
+    struct State {
+        Word chaining[Traits::STATE_WORDS];
+        uint64_t totalLength;
+        uint32_t bufferLength;
+        uint8_t buffer[Traits::BLOCK_SIZE];
+    };
+
+    CompactEngine() : hashSize_(H().getHashSize()) {
+    }
+
+    size_t contextSize() const override { return sizeof(State); }
+    size_t hashSize() const override { return hashSize_; }
+
+    void construct(void* slot) const override {
+        State* state = static_cast<State*>(slot);
+        std::memcpy(state->chaining, Traits::initialState(), sizeof(state->chaining));
+        state->totalLength = 0;
+        state->bufferLength = 0;
+    }
+
+    void destroy(void*) const override {
+    }
+
+    void update(void* slot, const uint8_t* data, size_t length) const override {
+        State* state = static_cast<State*>(slot);
+        if (length > UINT64_MAX / 8 - state->totalLength) {
+            throw std::overflow_error("Input too large - would cause totalLength overflow");
+        }
+        state->totalLength += length;
+
+        if (state->bufferLength > 0) {
+            size_t take = std::min(length, Traits::BLOCK_SIZE - state->bufferLength);
+            std::memcpy(state->buffer + state->bufferLength, data, take);
+            state->bufferLength += static_cast<uint32_t>(take);
+            data += take;
+            length -= take;
+            if (state->bufferLength < Traits::BLOCK_SIZE) {
+                return;
+            }
+            Traits::compress(state->chaining, state->buffer);
+            state->bufferLength = 0;
+        }
+
+        // Whole blocks are compressed straight from the caller's data
+        while (length >= Traits::BLOCK_SIZE) {
+            Traits::compress(state->chaining, data);
+            data += Traits::BLOCK_SIZE;
+            length -= Traits::BLOCK_SIZE;
+        }
+        if (length > 0) {
+            std::memcpy(state->buffer, data, length);
+            state->bufferLength = static_cast<uint32_t>(length);
+        }
+    }
+
+    void finalize(void* slot, uint8_t* digest) const override {
+        State* state = static_cast<State*>(slot);
+        // MD5, SHA1 and SHA-256 use a 64-bit length field; SHA-512 a 128-bit one
+        const size_t lengthField = Traits::BLOCK_SIZE / 8;
+        size_t used = state->bufferLength;
+
+        state->buffer[used++] = 0x80;
+        if (used > Traits::BLOCK_SIZE - lengthField) {
+            std::memset(state->buffer + used, 0, Traits::BLOCK_SIZE - used);
+            Traits::compress(state->chaining, state->buffer);
+            used = 0;
+        }
+        std::memset(state->buffer + used, 0, Traits::BLOCK_SIZE - used);
+
+        const uint64_t bitLength = state->totalLength * 8;
+        for (size_t i = 0; i < 8; ++i) {
+            const uint8_t byte = static_cast<uint8_t>(bitLength >> (8 * i));
+            if (Traits::LITTLE_ENDIAN_ORDER) {
+                state->buffer[Traits::BLOCK_SIZE - lengthField + i] = byte;
+            } else {
+                state->buffer[Traits::BLOCK_SIZE - 1 - i] = byte;
+            }
+        }
+        Traits::compress(state->chaining, state->buffer);
+
+        if (Traits::LITTLE_ENDIAN_ORDER) {
+            for (size_t i = 0; i < hashSize_; ++i) {
+                digest[i] = static_cast<uint8_t>(state->chaining[i / sizeof(Word)] >> (8 * (i % sizeof(Word))));
+            }
+        } else {
+            MultiBuffer::storeBigEndian(state->chaining, digest, hashSize_);
+        }
+        construct(slot);
+    }
+
+private:
+    size_t hashSize_;
+};
+
+// Algorithms without a static compression function keep their hasher object in the slot
+template <typename H>
+class ObjectEngine : public HashArena::Engine {
+public:
+    size_t contextSize() const override { return sizeof(H); }
+    size_t hashSize() const override { return H().getHashSize(); }
+
+    void construct(void* slot) const override {
+        new (slot) H();
+    }
+
+    void destroy(void* slot) const override {
+        static_cast<H*>(slot)->~H();
+    }
+
+    void update(void* slot, const uint8_t* data, size_t length) const override {
+        static_cast<H*>(slot)->update(data, length);
+    }
+
+    void finalize(void* slot, uint8_t* digest) const override {
+        H* hasher = static_cast<H*>(slot);
+        hasher->finalize();
+        hasher->getDigest(digest);
+        hasher->reset();
+    }
+};
+
+template <typename H>
+typename std::enable_if<CompactTraits<H>::COMPACT, std::unique_ptr<HashArena::Engine>>::type
+makeEngine() {
+    return std::unique_ptr<HashArena::Engine>(new CompactEngine<H>());
+}
+
+template <typename H>
+typename std::enable_if<!CompactTraits<H>::COMPACT, std::unique_ptr<HashArena::Engine>>::type
+makeEngine() {
+    static_assert(alignof(H) <= HashArena::CACHE_LINE_SIZE, "Hasher alignment exceeds slot alignment");
+    return std::unique_ptr<HashArena::Engine>(new ObjectEngine<H>());
+}
+
+} // namespace
+
+HashArena::HashArena(const std::string& algorithm, size_t contextsPerSlab)
+    : contextsPerSlab_(contextsPerSlab), slotSize_(0), nextUnused_(0), freeList_(nullptr), liveCount_(0) {
+    if (contextsPerSlab == 0) {
+        throw std::invalid_argument("Arena slab must hold at least one context");
+    }
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        engine_ = makeEngine<H>();
+    });
+
+    // Round up to whole cache lines; a slot must also fit the free-list link
+    size_t size = std::max(engine_->contextSize(), sizeof(void*));
+    slotSize_ = (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+
+// Contexts still acquired are abandoned with their slabs; none of them own heap memory
+HashArena::~HashArena() = default;
+
+void HashArena::addSlab() {
+    Slab slab;
+    slab.storage.reset(new uint8_t[slotSize_ * contextsPerSlab_ + CACHE_LINE_SIZE]);
+    uintptr_t address = reinterpret_cast<uintptr_t>(slab.storage.get());
+    uintptr_t aligned = (address + CACHE_LINE_SIZE - 1) & ~static_cast<uintptr_t>(CACHE_LINE_SIZE - 1);
+    slab.base = slab.storage.get() + (aligned - address);
+    slabs_.push_back(std::move(slab));
+    nextUnused_ = 0;
+}
+
+HashArena::Context* HashArena::acquire() {
+    void* slot;
+    if (freeList_ != nullptr) {
+        slot = freeList_;
+        std::memcpy(&freeList_, slot, sizeof(void*));
+    } else {
+        if (slabs_.empty() || nextUnused_ == contextsPerSlab_) {
+            addSlab();
+        }
+        slot = slabs_.back().base + nextUnused_ * slotSize_;
+        ++nextUnused_;
+    }
+    engine_->construct(slot);
+    ++liveCount_;
+    return static_cast<Context*>(slot);
+}
+
+void HashArena::release(Context* context) {
+    if (context == nullptr) {
+        throw std::invalid_argument("Cannot release a null context");
+    }
+    engine_->destroy(context);
+    std::memcpy(context, &freeList_, sizeof(void*));
+    freeList_ = context;
+    --liveCount_;
+}
+
+void HashArena::update(Context* context, const uint8_t* data, size_t length) {
+    if (context == nullptr || (data == nullptr && length > 0)) {
+        throw std::invalid_argument("Context and data must not be null");
+    }
+    engine_->update(context, data, length);
+}
+
+void HashArena::finalize(Context* context, uint8_t* digest) {
+    if (context == nullptr || digest == nullptr) {
+        throw std::invalid_argument("Context and digest must not be null");
+    }
+    engine_->finalize(context, digest);
+}
+
+size_t HashArena::getHashSize() const {
+    return engine_->hashSize();
+}
@@ -0,0 +1,104 @@
+#ifndef HASH_ARENA_H
+#define HASH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Slab allocator for compact hashing contexts of one algorithm
+ *
+ * Contexts hold only the chaining state, length counter and a buffer of
+ * exactly one block (64 bytes for MD5, SHA1 and SHA-224/256, 128 bytes for
+ * the SHA-384/512 family), with no vtable pointer. Each context occupies a
+ * whole number of 64-byte cache lines inside a slab; released contexts go on
+ * an intrusive free list and are reused in O(1). BLAKE contexts are the
+ * regular hasher objects placed in the same slabs.
+ *
+ * Not thread-safe; use one arena per thread or guard it externally.
+ */
+class HashArena {
+public:
+    // Opaque handle to a context inside the arena
+    struct Context;
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm for every context (any HashFactory name)
+     * @param contextsPerSlab Contexts allocated together when the free list is empty
+     * @throws std::invalid_argument on unsupported algorithm or zero slab size
+     */
+    explicit HashArena(const std::string& algorithm, size_t contextsPerSlab = 1024);
+
+    ~HashArena();
+
+    HashArena(const HashArena&) = delete;
+    HashArena& operator=(const HashArena&) = delete;
+
+    /**
+     * Take a freshly initialized context from the arena
+     */
+    Context* acquire();
+
+    /**
+     * Return a context to the free list
+     * @param context Context obtained from this arena's acquire()
+     */
+    void release(Context* context);
+
+    /**
+     * Add data to a context
+     * @throws std::overflow_error if the total length would overflow
+     */
+    void update(Context* context, const uint8_t* data, size_t length);
+
+    /**
+     * Finish the message, write its digest and reset the context for reuse
+     * @param digest Output buffer of getHashSize() bytes
+     */
+    void finalize(Context* context, uint8_t* digest);
+
+    /**
+     * Get the digest size of the configured algorithm
+     */
+    size_t getHashSize() const;
+
+    /**
+     * Get the bytes occupied by one context, including cache-line padding
+     */
+    size_t getContextSize() const { return slotSize_; }
+
+    /**
+     * Get the number of contexts currently acquired
+     */
+    size_t getLiveCount() const { return liveCount_; }
+
+    /**
+     * Get the number of contexts the allocated slabs can hold
+     */
+    size_t getCapacity() const { return slabs_.size() * contextsPerSlab_; }
+
+    class Engine;
+
+private:
+    struct Slab {
+        std::unique_ptr<uint8_t[]> storage;
+        uint8_t* base;               // First cache-line aligned slot
+    };
+
+    void addSlab();
+
+    std::unique_ptr<Engine> engine_;
+    size_t contextsPerSlab_;
+    size_t slotSize_;
+    std::vector<Slab> slabs_;
+    size_t nextUnused_;              // Never-used slots remaining in the last slab start here
+    void* freeList_;                 // Released slots, linked through their first bytes
+    size_t liveCount_;
+};
+
+#endif // HASH_ARENA_H
@@ -2,6 +2,8 @@
 #define HASH_BASE_H
 
 #include "hash_interface.h"
+#include "hash_constants.h"
+#include "hash_state.h"
 #include <cstdint>
 #include <cstring>
 #include <stdexcept>
@@ -90,6 +92,16 @@ protected:
      * Each algorithm implements its own padding logic
      */
     virtual void addPadding() = 0;
+    
+    /**
+     * Write the algorithm-specific state (chaining values, counters)
+     */
+    virtual void saveState(HashState::Writer& writer) const = 0;
+    
+    /**
+     * Read the fields written by saveState()
+     */
+    virtual void loadState(HashState::Reader& reader) = 0;
 
 public:
     // HashInterface implementation - delegate to subclass-specific reset
@@ -106,6 +118,63 @@ public:
     }
     
     bool isFinalized() const override { return finalized; }
+    
+    // Common hex formatting of the binary digest
+    std::string getHash() const override {
+        uint8_t digest[HASH_CONSTANTS::MAX_HASH_SIZE];
+        getDigest(digest);
+        return toHex(digest, getHashSize());
+    }
+    
+    // Common fields first, then the algorithm's own
+    std::vector<uint8_t> exportState() const override {
+        HashState::Writer writer(getAlgorithmName());
+        writer.putU8(finalized ? 1 : 0);
+        writer.putU64(totalLength);
+        writer.putU32(static_cast<uint32_t>(bufferLength));
+        writer.putBytes(buffer, bufferLength);
+        saveState(writer);
+        return writer.take();
+    }
+    
+    void importState(const uint8_t* data, size_t length) override {
+        HashState::Reader reader(data, length, getAlgorithmName());
+        const bool stateFinalized = reader.getU8() != 0;
+        const uint64_t stateTotalLength = reader.getU64();
+        const size_t stateBufferLength = reader.getU32();
+        // Padding may leave a full block buffered, but only once finalized
+        if (stateBufferLength > blockSize || (!stateFinalized && stateBufferLength == blockSize)) {
+            throw std::invalid_argument("Invalid buffered length in hash state");
+        }
+        const uint8_t* stateBuffer = reader.getBytes(stateBufferLength);
+        
+        try {
+            loadState(reader);
+            reader.finish();
+        } catch (...) {
+            reset(); // Never leave a half-imported state behind
+            throw;
+        }
+        
+        finalized = stateFinalized;
+        totalLength = stateTotalLength;
+        bufferLength = stateBufferLength;
+        std::memset(buffer, 0, sizeof(buffer));
+        std::memcpy(buffer, stateBuffer, stateBufferLength);
+    }
+    
+    /**
+     * Format raw bytes as a lowercase hexadecimal string
+     */
+    static std::string toHex(const uint8_t* data, size_t length) {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex(length * 2, '0');
+        for (size_t i = 0; i < length; ++i) {
+            hex[i * 2] = digits[data[i] >> 4];
+            hex[i * 2 + 1] = digits[data[i] & 0x0f];
+        }
+        return hex;
+    }
 };
 
 #endif // HASH_BASE_H
@@ -0,0 +1,266 @@
+#include "hash_client.h"
+#include "file_io.h"
+#include "hash_protocol.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+constexpr size_t HashClient::MAX_PIPELINED;
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+const int SEND_FLAGS = 0;
+#endif
+
+// A daemon that went away is reported as an error rather than SIGPIPE
+void sendAll(int fd, const uint8_t* data, size_t length) {
+    size_t total = 0;
+    while (total < length) {
+        const ssize_t n = ::send(fd, data + total, length - total, SEND_FLAGS);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("Send to hash daemon failed: ") + std::strerror(errno));
+        }
+        total += static_cast<size_t>(n);
+    }
+}
+
+} // namespace
+
+HashClient::HashClient(const std::string& socketPath) : fd_(-1), unacknowledged_(0), sqTail_(0), cqHead_(0) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    }
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        const int error = errno;
+        ::close(fd_);
+        throw std::runtime_error("Cannot connect to " + socketPath + ": " + std::strerror(error));
+    }
+}
+
+HashClient::~HashClient() {
+    ::close(fd_);
+}
+
+void HashClient::send(uint8_t opcode, uint32_t stream, const uint8_t* payload, size_t length) {
+    if (length > HashProtocol::MAX_PAYLOAD_SIZE) {
+        throw std::invalid_argument("Request payload too large");
+    }
+    std::vector<uint8_t> header;
+    header.push_back(opcode);
+    HashProtocol::putU32(header, stream);
+    HashProtocol::putU32(header, static_cast<uint32_t>(length));
+    sendAll(fd_, header.data(), header.size());
+    sendAll(fd_, payload, length);
+}
+
+std::vector<uint8_t> HashClient::receive() {
+    auto readExact = [this](uint8_t* buffer, size_t length) {
+        size_t total = 0;
+        while (total < length) {
+            const size_t got = FileIO::readSome(fd_, buffer + total, length - total);
+            if (got == 0) {
+                throw std::runtime_error("Hash daemon closed the connection");
+            }
+            total += got;
+        }
+    };
+
+    uint8_t header[HashProtocol::RESPONSE_HEADER_SIZE];
+    readExact(header, sizeof(header));
+    std::vector<uint8_t> payload(HashProtocol::getU32(header + 1));
+    readExact(payload.data(), payload.size());
+    if (header[0] != HashProtocol::OK) {
+        throw std::runtime_error("Hash daemon error: " + std::string(payload.begin(), payload.end()));
+    }
+    return payload;
+}
+
+void HashClient::drainAcknowledgements() {
+    // Read every outstanding acknowledgement before reporting the first error
+    std::string error;
+    for (; unacknowledged_ > 0; --unacknowledged_) {
+        try {
+            receive();
+        } catch (const std::runtime_error& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+std::vector<uint8_t> HashClient::call(uint8_t opcode, uint32_t stream, const std::vector<uint8_t>& payload) {
+    drainAcknowledgements();
+    send(opcode, stream, payload.data(), payload.size());
+    return receive();
+}
+
+uint32_t HashClient::open(const std::string& algorithm) {
+    std::vector<uint8_t> response = call(HashProtocol::OPEN, 0, std::vector<uint8_t>(algorithm.begin(), algorithm.end()));
+    if (response.size() != 4) {
+        throw std::runtime_error("Malformed OPEN response");
+    }
+    return HashProtocol::getU32(response.data());
+}
+
+void HashClient::update(uint32_t stream, const uint8_t* data, size_t length) {
+    if (unacknowledged_ >= MAX_PIPELINED) {
+        drainAcknowledgements();
+    }
+    send(HashProtocol::UPDATE, stream, data, length);
+    ++unacknowledged_;
+}
+
+std::vector<uint8_t> HashClient::finalize(uint32_t stream) {
+    return call(HashProtocol::FINALIZE, stream, std::vector<uint8_t>());
+}
+
+std::vector<uint8_t> HashClient::hash(const std::string& algorithm, const uint8_t* data, size_t length) {
+    std::vector<uint8_t> payload;
+    HashProtocol::putName(payload, algorithm);
+    payload.insert(payload.end(), data, data + length);
+    return call(HashProtocol::HASH, 0, payload);
+}
+
+std::vector<std::vector<uint8_t>> HashClient::hashBatch(const std::string& algorithm, const HashSpan* inputs,
+                                                        size_t count) {
+    std::vector<uint8_t> payload;
+    HashProtocol::putName(payload, algorithm);
+    HashProtocol::putU32(payload, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        HashProtocol::putU32(payload, static_cast<uint32_t>(inputs[i].length));
+        payload.insert(payload.end(), inputs[i].data, inputs[i].data + inputs[i].length);
+    }
+    std::vector<uint8_t> response = call(HashProtocol::BATCH, 0, payload);
+    if (count == 0 || response.size() % count != 0) {
+        if (count == 0 && response.empty()) {
+            return {};
+        }
+        throw std::runtime_error("Malformed BATCH response");
+    }
+    const size_t hashSize = response.size() / count;
+    std::vector<std::vector<uint8_t>> digests(count);
+    for (size_t i = 0; i < count; ++i) {
+        digests[i].assign(response.begin() + i * hashSize, response.begin() + (i + 1) * hashSize);
+    }
+    return digests;
+}
+
+void HashClient::attachRing(uint32_t entries, size_t dataSize) {
+    if (ring_) {
+        throw std::runtime_error("A ring is already attached");
+    }
+    std::unique_ptr<HashRing::Region> ring = HashRing::Region::create(entries, dataSize);
+    drainAcknowledgements();
+
+    // The header travels with the descriptor so the daemon sees both together
+    std::vector<uint8_t> header;
+    header.push_back(HashProtocol::ATTACH);
+    HashProtocol::putU32(header, 0);
+    HashProtocol::putU32(header, 0);
+    iovec vector;
+    vector.iov_base = header.data();
+    vector.iov_len = header.size();
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    std::memset(control, 0, sizeof(control));
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* rights = CMSG_FIRSTHDR(&message);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(int));
+    const int regionFd = ring->getFd();
+    std::memcpy(CMSG_DATA(rights), &regionFd, sizeof(int));
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(fd_, &message, SEND_FLAGS);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        throw std::runtime_error(std::string("Send to hash daemon failed: ") + std::strerror(errno));
+    }
+    // The descriptor went with the first byte; finish any short write normally
+    sendAll(fd_, header.data() + sent, header.size() - static_cast<size_t>(sent));
+
+    receive();
+    ring_ = std::move(ring);
+    sqTail_ = 0;
+    cqHead_ = 0;
+}
+
+uint8_t* HashClient::getRingData() const {
+    return ring_ ? ring_->data() : nullptr;
+}
+
+size_t HashClient::getRingDataSize() const {
+    return ring_ ? ring_->getDataSize() : 0;
+}
+
+bool HashClient::submit(const std::string& algorithm, uint64_t offset, uint64_t length, uint64_t userData) {
+    if (!ring_) {
+        throw std::runtime_error("No ring attached");
+    }
+    if (algorithm.size() > HashRing::MAX_ALGORITHM_NAME) {
+        throw std::invalid_argument("Algorithm name too long: " + algorithm);
+    }
+    HashRing::Header& header = ring_->header();
+    const uint32_t entries = ring_->getEntries();
+    if (sqTail_ - header.sqHead.load(std::memory_order_acquire) >= entries) {
+        return false;
+    }
+
+    HashRing::Submission& submission = ring_->submissions()[sqTail_ & (entries - 1)];
+    submission.userData = userData;
+    submission.offset = offset;
+    submission.length = length;
+    submission.algorithmLength = static_cast<uint8_t>(algorithm.size());
+    std::memcpy(submission.algorithm, algorithm.data(), algorithm.size());
+    header.sqTail.store(++sqTail_, std::memory_order_release);
+    return true;
+}
+
+uint32_t HashClient::enter() {
+    std::vector<uint8_t> response = call(HashProtocol::ENTER, 0, std::vector<uint8_t>());
+    if (response.size() != 4) {
+        throw std::runtime_error("Malformed ENTER response");
+    }
+    return HashProtocol::getU32(response.data());
+}
+
+bool HashClient::reap(HashRing::Completion& completion) {
+    if (!ring_) {
+        throw std::runtime_error("No ring attached");
+    }
+    HashRing::Header& header = ring_->header();
+    if (header.cqTail.load(std::memory_order_acquire) == cqHead_) {
+        return false;
+    }
+    completion = ring_->completions()[cqHead_ & (ring_->getEntries() - 1)];
+    header.cqHead.store(++cqHead_, std::memory_order_release);
+    return true;
+}
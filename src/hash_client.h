@@ -0,0 +1,109 @@
+#ifndef HASH_CLIENT_H
+#define HASH_CLIENT_H
+
+#include "batch_hash.h"
+#include "hash_ring.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Blocking client for the --serve daemon (see hash_protocol.h)
+ *
+ * UPDATE requests are pipelined: their acknowledgements are collected by the
+ * next call that needs a result, or once too many are outstanding, and any
+ * error they carry is thrown from there.
+ * Not thread-safe; use one client per thread.
+ *
+ * After attachRing, messages can instead be written into the shared data
+ * area and submitted through the ring: submit() queues them, enter() asks
+ * the daemon to hash everything pending and reap() collects the digests.
+ */
+class HashClient {
+public:
+    // Unacknowledged UPDATE requests allowed in flight
+    static constexpr size_t MAX_PIPELINED = 64;
+
+    /**
+     * Connect to a daemon
+     * @throws std::runtime_error if the socket cannot be reached
+     */
+    explicit HashClient(const std::string& socketPath);
+    ~HashClient();
+
+    HashClient(const HashClient&) = delete;
+    HashClient& operator=(const HashClient&) = delete;
+
+    /**
+     * Open an incremental stream
+     * @return Stream id, valid on this connection only
+     */
+    uint32_t open(const std::string& algorithm);
+
+    void update(uint32_t stream, const uint8_t* data, size_t length);
+
+    /**
+     * Finish a stream and close it
+     * @return Binary digest
+     */
+    std::vector<uint8_t> finalize(uint32_t stream);
+
+    /**
+     * Hash one message
+     * @return Binary digest
+     */
+    std::vector<uint8_t> hash(const std::string& algorithm, const uint8_t* data, size_t length);
+
+    /**
+     * Hash many messages in one request
+     * @return One binary digest per input, in order
+     */
+    std::vector<std::vector<uint8_t>> hashBatch(const std::string& algorithm, const HashSpan* inputs, size_t count);
+
+    /**
+     * Create a shared ring region and hand it to the daemon
+     * @param entries Ring size, a power of two
+     * @param dataSize Bytes of payload space
+     */
+    void attachRing(uint32_t entries, size_t dataSize);
+
+    /**
+     * Get the shared payload area (nullptr before attachRing)
+     */
+    uint8_t* getRingData() const;
+    size_t getRingDataSize() const;
+
+    /**
+     * Queue one message already written at offset in the payload area
+     * @return False if the submission ring is full
+     */
+    bool submit(const std::string& algorithm, uint64_t offset, uint64_t length, uint64_t userData);
+
+    /**
+     * Ask the daemon to consume the submission ring
+     * @return Number of completions it posted
+     */
+    uint32_t enter();
+
+    /**
+     * Take the next completion, if any
+     * @return False if the completion ring is empty
+     */
+    bool reap(HashRing::Completion& completion);
+
+private:
+    void send(uint8_t opcode, uint32_t stream, const uint8_t* payload, size_t length);
+    std::vector<uint8_t> receive();
+    void drainAcknowledgements();
+    std::vector<uint8_t> call(uint8_t opcode, uint32_t stream, const std::vector<uint8_t>& payload);
+
+    int fd_;
+    size_t unacknowledged_;
+    std::unique_ptr<HashRing::Region> ring_;
+    uint32_t sqTail_;
+    uint32_t cqHead_;
+};
+
+#endif // HASH_CLIENT_H
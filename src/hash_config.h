@@ -14,6 +14,7 @@ namespace HashConfig {
     static constexpr size_t DEFAULT_BUFFER_SIZE = 32768;  // 32KB
     static constexpr size_t MIN_BUFFER_SIZE = 1024;       // 1KB
     static constexpr size_t MAX_BUFFER_SIZE = 1048576;    // 1MB
+    static constexpr size_t DEFAULT_TREE_LEAF_SIZE = 1048576; // 1MiB Merkle leaves
     
     // Security configuration
     static constexpr bool CLEAR_SENSITIVE_DATA = true;
@@ -12,10 +12,15 @@ namespace HASH_CONSTANTS {
     // Hash output sizes
     static constexpr size_t MD5_HASH_SIZE = 16;     // 128 bits
     static constexpr size_t SHA1_HASH_SIZE = 20;    // 160 bits
+    static constexpr size_t SHA224_HASH_SIZE = 28;  // 224 bits
     static constexpr size_t SHA256_HASH_SIZE = 32;  // 256 bits
+    static constexpr size_t SHA384_HASH_SIZE = 48;  // 384 bits
     static constexpr size_t SHA512_HASH_SIZE = 64;  // 512 bits
+    static constexpr size_t SHA512_224_HASH_SIZE = 28; // 224 bits (SHA-512/224)
+    static constexpr size_t SHA512_256_HASH_SIZE = 32; // 256 bits (SHA-512/256)
     static constexpr size_t BLAKE256_HASH_SIZE = 32; // 256 bits
     static constexpr size_t BLAKE512_HASH_SIZE = 64; // 512 bits
+    static constexpr size_t MAX_HASH_SIZE = 64;      // Largest digest of any supported algorithm
     
     // Algorithm-specific block sizes  
     static constexpr size_t MD5_BLOCK_SIZE = BLOCK_SIZE_512;
@@ -24,6 +29,7 @@ namespace HASH_CONSTANTS {
     static constexpr size_t SHA512_BLOCK_SIZE = BLOCK_SIZE_1024;
     static constexpr size_t BLAKE256_BLOCK_SIZE = BLOCK_SIZE_512;
     static constexpr size_t BLAKE512_BLOCK_SIZE = BLOCK_SIZE_1024;
+    static constexpr size_t MAX_BLOCK_SIZE = BLOCK_SIZE_1024; // Largest block of any supported algorithm
     
     // Padding constants
     static constexpr uint8_t PADDING_BIT = 0x80;
@@ -0,0 +1,59 @@
+#ifndef HASH_DISPATCH_H
+#define HASH_DISPATCH_H
+
+#include "md5.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "sha512.h"
+#include "blake256.h"
+#include "blake512.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Compile-time algorithm selection for code templated on the concrete hash class
+ * (HMAC<H>, KDFs, batch kernels). The visitor is called with an AlgorithmTag<H>.
+ */
+template <typename H>
+struct AlgorithmTag {
+    typedef H type;
+};
+
+/**
+ * Invoke visitor with the tag of the named algorithm
+ * @param algorithm Algorithm name (case-insensitive)
+ * @param visitor Callable taking an AlgorithmTag<H>
+ * @throws std::invalid_argument if algorithm is not supported
+ */
+template <typename Visitor>
+void dispatchAlgorithm(const std::string& algorithm, Visitor&& visitor) {
+    std::string algo = algorithm;
+    std::transform(algo.begin(), algo.end(), algo.begin(), ::tolower);
+
+    if (algo == "md5") {
+        visitor(AlgorithmTag<MD5>());
+    } else if (algo == "sha1") {
+        visitor(AlgorithmTag<SHA1>());
+    } else if (algo == "sha224") {
+        visitor(AlgorithmTag<SHA224>());
+    } else if (algo == "sha256") {
+        visitor(AlgorithmTag<SHA256>());
+    } else if (algo == "sha384") {
+        visitor(AlgorithmTag<SHA384>());
+    } else if (algo == "sha512") {
+        visitor(AlgorithmTag<SHA512>());
+    } else if (algo == "sha512/224") {
+        visitor(AlgorithmTag<SHA512_224>());
+    } else if (algo == "sha512/256") {
+        visitor(AlgorithmTag<SHA512_256>());
+    } else if (algo == "blake256") {
+        visitor(AlgorithmTag<BLAKE256>());
+    } else if (algo == "blake512") {
+        visitor(AlgorithmTag<BLAKE512>());
+    } else {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+}
+
+#endif // HASH_DISPATCH_H
@@ -5,6 +5,8 @@
 #include "blake256.h"
 #include "blake512.h"
 #include "md5.h"
+#include "hmac.h"
+#include "hash_dispatch.h"
 #include <stdexcept>
 #include <algorithm>
 
@@ -15,10 +17,18 @@ std::unique_ptr<HashInterface> HashFactory::createHash(const std::string& algori
         return std::make_unique<MD5>();
     } else if (algo == "sha1") {
         return std::make_unique<SHA1>();
+    } else if (algo == "sha224") {
+        return std::make_unique<SHA224>();
     } else if (algo == "sha256") {
         return std::make_unique<SHA256>();
+    } else if (algo == "sha384") {
+        return std::make_unique<SHA384>();
     } else if (algo == "sha512") {
         return std::make_unique<SHA512>();
+    } else if (algo == "sha512/224") {
+        return std::make_unique<SHA512_224>();
+    } else if (algo == "sha512/256") {
+        return std::make_unique<SHA512_256>();
     } else if (algo == "blake256") {
         return std::make_unique<BLAKE256>();
     } else if (algo == "blake512") {
@@ -28,12 +38,26 @@ std::unique_ptr<HashInterface> HashFactory::createHash(const std::string& algori
     }
 }
 
+std::unique_ptr<HashInterface> HashFactory::createHMAC(const std::string& algorithm,
+                                                      const uint8_t* key, size_t keyLength) {
+    std::unique_ptr<HashInterface> hmac;
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        hmac = std::make_unique<HMAC<H>>(key, keyLength);
+    });
+    return hmac;
+}
+
 std::vector<std::string> HashFactory::getSupportedAlgorithms() {
     return {
         "MD5",
         "SHA1",
+        "SHA224",
         "SHA256",
+        "SHA384",
         "SHA512",
+        "SHA512/224",
+        "SHA512/256",
         "BLAKE256",
         "BLAKE512"
     };
@@ -19,6 +19,17 @@ public:
      */
     static std::unique_ptr<HashInterface> createHash(const std::string& algorithm);
     
+    /**
+     * Create a keyed HMAC instance over a hash algorithm
+     * @param algorithm Underlying algorithm name (case-insensitive)
+     * @param key Pointer to key bytes
+     * @param keyLength Key length in bytes
+     * @return Unique pointer to HMAC implementation
+     * @throws std::invalid_argument if algorithm is not supported
+     */
+    static std::unique_ptr<HashInterface> createHMAC(const std::string& algorithm,
+                                                     const uint8_t* key, size_t keyLength);
+    
     /**
      * Get list of supported algorithms
      * @return Vector of algorithm names
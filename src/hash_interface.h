@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <string>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 /**
  * Abstract base class for hash algorithms
@@ -37,6 +39,13 @@ public:
      */
     virtual std::string getHash() const = 0;
     
+    /**
+     * Get the final hash as raw bytes
+     * Must be called after finalize()
+     * @param digest Output buffer of at least getHashSize() bytes
+     */
+    virtual void getDigest(uint8_t* digest) const = 0;
+    
     /**
      * Get the block size for this hash algorithm
      * @return Block size in bytes
@@ -60,6 +69,28 @@ public:
      * @return True if finalized, false otherwise
      */
     virtual bool isFinalized() const = 0;
+    
+    /**
+     * Copy the hasher including any in-progress state
+     * @return Independent hasher of the same algorithm
+     */
+    virtual std::unique_ptr<HashInterface> clone() const = 0;
+    
+    /**
+     * Serialize the midstate, buffered tail and length counters
+     * The format is stable across runs and platforms (see hash_state.h)
+     * @return Opaque state bytes
+     */
+    virtual std::vector<uint8_t> exportState() const = 0;
+    
+    /**
+     * Restore a state produced by exportState() of the same algorithm
+     * @param data State bytes
+     * @param length Number of state bytes
+     * @throws std::invalid_argument if the state is malformed or for another algorithm;
+     *         the hasher is reset in that case
+     */
+    virtual void importState(const uint8_t* data, size_t length) = 0;
 };
 
 #endif // HASH_INTERFACE_H
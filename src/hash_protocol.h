@@ -0,0 +1,71 @@
+#ifndef HASH_PROTOCOL_H
+#define HASH_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Binary protocol of the --serve daemon
+ *
+ * Request:  u8 opcode, u32 stream id, u32 payload length, payload
+ * Response: u8 status, u32 payload length, payload
+ *
+ * Integers are big-endian. Every request gets exactly one response, in
+ * request order, so clients may pipeline. Payloads by opcode:
+ *
+ *   OPEN      algorithm name                       -> u32 stream id
+ *   UPDATE    data for the stream                  -> empty
+ *   FINALIZE  empty; the stream is closed          -> digest
+ *   HASH      u8 name length, name, data           -> digest
+ *   BATCH     u8 name length, name, u32 count,
+ *             count x (u32 length, data)           -> count digests, concatenated
+ *   ATTACH    empty; a sealed memfd ring region is
+ *             passed as SCM_RIGHTS (hash_ring.h)   -> u32 ring entries
+ *   ENTER     empty; consume the submission ring   -> u32 completions posted
+ *
+ * An ERROR response carries a message instead of the result.
+ */
+namespace HashProtocol {
+
+    enum Opcode : uint8_t {
+        OPEN = 1,
+        UPDATE = 2,
+        FINALIZE = 3,
+        HASH = 4,
+        BATCH = 5,
+        ATTACH = 6,
+        ENTER = 7
+    };
+
+    enum Status : uint8_t {
+        OK = 0,
+        ERROR = 1
+    };
+
+    static constexpr size_t REQUEST_HEADER_SIZE = 9;
+    static constexpr size_t RESPONSE_HEADER_SIZE = 5;
+
+    // Larger frames are a protocol violation and close the connection
+    static constexpr uint32_t MAX_PAYLOAD_SIZE = 64 * 1024 * 1024;
+
+    inline void putU32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    inline uint32_t getU32(const uint8_t* in) {
+        return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+               (static_cast<uint32_t>(in[2]) << 8) | in[3];
+    }
+
+    // u8 length-prefixed algorithm name, as used by HASH and BATCH
+    inline void putName(std::vector<uint8_t>& out, const std::string& name) {
+        out.push_back(static_cast<uint8_t>(name.size()));
+        out.insert(out.end(), name.begin(), name.end());
+    }
+}
+
+#endif // HASH_PROTOCOL_H
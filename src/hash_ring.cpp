@@ -0,0 +1,127 @@
+#include "hash_ring.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace HashRing;
+
+static_assert(sizeof(Header) <= HEADER_SIZE, "Ring header must fit its reserved page");
+
+namespace {
+
+bool validGeometry(uint32_t entries) {
+    return entries > 0 && entries <= MAX_ENTRIES && (entries & (entries - 1)) == 0;
+}
+
+} // namespace
+
+size_t Region::dataOffset(uint32_t entries) {
+    // Data starts on a page boundary after both rings
+    const size_t rings = HEADER_SIZE + entries * (sizeof(Submission) + sizeof(Completion));
+    return (rings + HEADER_SIZE - 1) / HEADER_SIZE * HEADER_SIZE;
+}
+
+size_t Region::regionSize(uint32_t entries, size_t dataSize) {
+    return dataOffset(entries) + dataSize;
+}
+
+#ifdef __linux__
+
+std::unique_ptr<Region> Region::create(uint32_t entries, size_t dataSize) {
+    if (!validGeometry(entries)) {
+        throw std::invalid_argument("Ring entries must be a power of two up to " + std::to_string(MAX_ENTRIES));
+    }
+    const size_t size = regionSize(entries, dataSize);
+    const int fd = ::memfd_create("hashgen-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("memfd_create failed: ") + std::strerror(errno));
+    }
+    // Sealing the size keeps the daemon safe from SIGBUS on a truncated mapping
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0 ||
+        ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::runtime_error(std::string("Cannot size ring region: ") + std::strerror(error));
+    }
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        const int error = errno;
+        ::close(fd);
+        throw std::runtime_error(std::string("Cannot map ring region: ") + std::strerror(error));
+    }
+
+    Header* header = new (base) Header();
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->entries = entries;
+    header->dataSize = dataSize;
+    return std::unique_ptr<Region>(new Region(fd, static_cast<uint8_t*>(base), size, entries, dataSize));
+}
+
+std::unique_ptr<Region> Region::attach(int fd) {
+    auto reject = [fd](const std::string& message) -> std::unique_ptr<Region> {
+        ::close(fd);
+        throw std::runtime_error(message);
+    };
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return reject("Ring descriptor is not a memory file");
+    }
+    const int seals = ::fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & F_SEAL_SHRINK) == 0) {
+        return reject("Ring region must be sealed against shrinking");
+    }
+    const size_t size = static_cast<size_t>(info.st_size);
+    if (size < HEADER_SIZE) {
+        return reject("Ring region too small");
+    }
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return reject(std::string("Cannot map ring region: ") + std::strerror(errno));
+    }
+
+    // Copy the geometry once; later changes by the client are ignored
+    const Header* header = static_cast<const Header*>(base);
+    const uint32_t magic = header->magic;
+    const uint32_t version = header->version;
+    const uint32_t entries = header->entries;
+    const uint64_t dataSize = header->dataSize;
+    if (magic != MAGIC || version != VERSION || !validGeometry(entries) ||
+        dataSize > size || regionSize(entries, static_cast<size_t>(dataSize)) > size) {
+        ::munmap(base, size);
+        return reject("Malformed ring region header");
+    }
+    return std::unique_ptr<Region>(new Region(fd, static_cast<uint8_t*>(base), size, entries,
+                                              static_cast<size_t>(dataSize)));
+}
+
+Region::~Region() {
+    ::munmap(base_, size_);
+    ::close(fd_);
+}
+
+#else
+
+std::unique_ptr<Region> Region::create(uint32_t, size_t) {
+    throw std::runtime_error("Shared-memory rings require memfd (Linux)");
+}
+
+std::unique_ptr<Region> Region::attach(int fd) {
+    ::close(fd);
+    throw std::runtime_error("Shared-memory rings require memfd (Linux)");
+}
+
+Region::~Region() {
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef HASH_RING_H
+#define HASH_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Shared-memory submission/completion rings for the hashing daemon
+ *
+ * The client creates a sealed memfd region and hands it to the daemon over
+ * the socket (ATTACH, with the descriptor as SCM_RIGHTS). Region layout:
+ *
+ *   Header       HEADER_SIZE bytes: geometry and the four ring indices
+ *   Submissions  entries x Submission
+ *   Completions  entries x Completion
+ *   Data         dataSize bytes the client fills with payloads
+ *
+ * The client writes payloads into the data area, pushes Submission entries
+ * (algorithm, offset, length, user data) and advances sqTail; an ENTER
+ * request makes the daemon consume them, hash straight from the shared
+ * pages and publish Completion entries through cqTail. Each index has a
+ * single writer, so the rings need no locks: the producer publishes with a
+ * release store and the consumer reads with an acquire load.
+ *
+ * The daemon copies the geometry once when attaching and copies every entry
+ * before validating it, so a client rewriting shared memory can only spoil
+ * its own results.
+ */
+namespace HashRing {
+
+    static constexpr uint32_t MAGIC = 0x48475251;      // "HGRQ"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 4096;
+    static constexpr size_t MAX_ALGORITHM_NAME = 15;
+    static constexpr size_t MAX_DIGEST_SIZE = 64;
+    static constexpr uint32_t MAX_ENTRIES = 65536;
+
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared rings need lock-free 32-bit atomics");
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entries;           // Power of two
+        uint32_t reserved;
+        uint64_t dataSize;
+        alignas(64) std::atomic<uint32_t> sqHead;   // Written by the daemon
+        alignas(64) std::atomic<uint32_t> sqTail;   // Written by the client
+        alignas(64) std::atomic<uint32_t> cqHead;   // Written by the client
+        alignas(64) std::atomic<uint32_t> cqTail;   // Written by the daemon
+    };
+
+    struct Submission {
+        uint64_t userData;
+        uint64_t offset;            // Into the data area
+        uint64_t length;
+        uint8_t algorithmLength;
+        char algorithm[MAX_ALGORITHM_NAME];
+    };
+
+    struct Completion {
+        uint64_t userData;
+        int32_t status;             // 0, or -1 for an invalid submission
+        uint32_t digestLength;
+        uint8_t digest[MAX_DIGEST_SIZE];
+    };
+
+    /**
+     * A mapped ring region
+     */
+    class Region {
+    public:
+        /**
+         * Create, size, seal and map a new region (client side)
+         * @param entries Ring size, a power of two up to MAX_ENTRIES
+         * @param dataSize Bytes of payload space
+         * @throws std::invalid_argument on bad geometry
+         * @throws std::runtime_error if shared memory is unavailable
+         */
+        static std::unique_ptr<Region> create(uint32_t entries, size_t dataSize);
+
+        /**
+         * Validate and map a region received from a client (daemon side);
+         * takes ownership of fd
+         * @throws std::runtime_error if the region is malformed or not sealed
+         */
+        static std::unique_ptr<Region> attach(int fd);
+
+        ~Region();
+
+        Region(const Region&) = delete;
+        Region& operator=(const Region&) = delete;
+
+        int getFd() const { return fd_; }
+        uint32_t getEntries() const { return entries_; }
+        size_t getDataSize() const { return dataSize_; }
+
+        Header& header() const { return *reinterpret_cast<Header*>(base_); }
+        Submission* submissions() const { return reinterpret_cast<Submission*>(base_ + HEADER_SIZE); }
+        Completion* completions() const {
+            return reinterpret_cast<Completion*>(base_ + HEADER_SIZE + entries_ * sizeof(Submission));
+        }
+        uint8_t* data() const { return base_ + dataOffset(entries_); }
+
+        /**
+         * Total region size for a geometry
+         */
+        static size_t regionSize(uint32_t entries, size_t dataSize);
+
+    private:
+        Region(int fd, uint8_t* base, size_t size, uint32_t entries, size_t dataSize)
+            : fd_(fd), base_(base), size_(size), entries_(entries), dataSize_(dataSize) {}
+
+        static size_t dataOffset(uint32_t entries);
+
+        int fd_;
+        uint8_t* base_;
+        size_t size_;
+        uint32_t entries_;          // Private copies: never re-read from shared memory
+        size_t dataSize_;
+    };
+}
+
+#endif // HASH_RING_H
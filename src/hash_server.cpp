@@ -0,0 +1,737 @@
+#include "hash_server.h"
+#include "batch_hash.h"
+#include "hash_factory.h"
+#include "hash_protocol.h"
+#include "hash_ring.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+constexpr size_t HashServer::MAX_STREAMS;
+
+#ifdef __linux__
+
+namespace {
+
+// Bytes read from one connection per readiness event, so one busy client cannot starve the others
+const size_t READ_QUOTA = 4 * 1024 * 1024;
+
+// Stop reading from a client whose responses are not being consumed
+const size_t MAX_PENDING_OUTPUT = 16 * 1024 * 1024;
+
+// Stop reading ahead of a busy connection once one largest frame is buffered
+const size_t MAX_BUFFERED_INPUT = HashProtocol::REQUEST_HEADER_SIZE + HashProtocol::MAX_PAYLOAD_SIZE;
+
+// One-shot messages per hashBatch task
+const size_t BATCH_SLICE = 256;
+
+// Reset hashers kept per algorithm and connection for reuse
+const size_t MAX_IDLE_HASHERS = 16;
+
+struct Request {
+    uint8_t opcode;
+    uint32_t stream;
+    std::vector<uint8_t> payload;
+    uint8_t status;
+    std::vector<uint8_t> response;
+
+    void fail(const std::string& message) {
+        status = HashProtocol::ERROR;
+        response.assign(message.begin(), message.end());
+    }
+};
+
+std::string lowerCase(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name;
+}
+
+} // namespace
+
+struct HashServer::Connection {
+    int fd;
+    std::mutex fdMutex;
+    std::deque<int> receivedFds;    // SCM_RIGHTS descriptors awaiting an ATTACH, guarded by fdMutex
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+    size_t outputOffset;
+    bool peerClosed;                // EOF: nothing more to read, but responses are still owed
+    bool failed;                    // Socket error: close as soon as no worker holds the connection
+    bool watched;                   // Registered with epoll
+    uint32_t events;
+
+    // Requests being served; only workers touch them until the connection is released
+    std::vector<Request> requests;
+    bool inFlight;
+    std::atomic<size_t> outstanding;
+
+    // One-shot requests whose batch threw; applied once released, as other slices may still fill them
+    std::mutex failureMutex;
+    std::vector<std::pair<Request*, std::string>> failures;
+
+    uint32_t nextStream;
+    std::unordered_map<uint32_t, std::unique_ptr<HashInterface>> streams;
+    std::unordered_map<std::string, std::vector<std::unique_ptr<HashInterface>>> idle;
+
+    // Shared-memory rings; the daemon's own indices are kept privately
+    std::unique_ptr<HashRing::Region> ring;
+    uint32_t sqHead;
+    uint32_t cqTail;
+
+    explicit Connection(int descriptor)
+        : fd(descriptor), outputOffset(0), peerClosed(false), failed(false), watched(true), events(0),
+          inFlight(false), outstanding(0), nextStream(1), sqHead(0), cqTail(0) {
+    }
+
+    ~Connection() {
+        for (int received : receivedFds) {
+            ::close(received);
+        }
+    }
+
+    size_t pendingOutput() const { return output.size() - outputOffset; }
+
+    // Split complete frames off the input buffer; false on a protocol violation
+    bool parseRequests() {
+        size_t offset = 0;
+        while (input.size() - offset >= HashProtocol::REQUEST_HEADER_SIZE) {
+            const uint8_t* header = input.data() + offset;
+            const uint32_t length = HashProtocol::getU32(header + 5);
+            if (length > HashProtocol::MAX_PAYLOAD_SIZE) {
+                return false;
+            }
+            if (input.size() - offset - HashProtocol::REQUEST_HEADER_SIZE < length) {
+                break;
+            }
+            const uint8_t* payload = header + HashProtocol::REQUEST_HEADER_SIZE;
+            requests.push_back(Request{header[0], HashProtocol::getU32(header + 1),
+                                       std::vector<uint8_t>(payload, payload + length),
+                                       HashProtocol::OK, std::vector<uint8_t>()});
+            offset += HashProtocol::REQUEST_HEADER_SIZE + length;
+        }
+        input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+        return true;
+    }
+
+    // OPEN, UPDATE and FINALIZE, in request order; runs on a worker
+    void runStreamRequests() {
+        for (auto& request : requests) {
+            try {
+                switch (request.opcode) {
+                    case HashProtocol::OPEN:
+                        open(request);
+                        break;
+                    case HashProtocol::UPDATE:
+                        findStream(request.stream).update(request.payload.data(), request.payload.size());
+                        break;
+                    case HashProtocol::FINALIZE:
+                        finalize(request);
+                        break;
+                    case HashProtocol::ATTACH:
+                        attach(request);
+                        break;
+                    case HashProtocol::ENTER:
+                        enter(request);
+                        break;
+                    default:
+                        break;
+                }
+            } catch (const std::exception& e) {
+                request.fail(e.what());
+            }
+        }
+    }
+
+    void open(Request& request) {
+        if (streams.size() >= MAX_STREAMS) {
+            throw std::runtime_error("Too many open streams");
+        }
+        const std::string algorithm = lowerCase(std::string(request.payload.begin(), request.payload.end()));
+        std::unique_ptr<HashInterface> hasher;
+        auto reusable = idle.find(algorithm);
+        if (reusable != idle.end() && !reusable->second.empty()) {
+            hasher = std::move(reusable->second.back());
+            reusable->second.pop_back();
+        } else {
+            hasher = HashFactory::createHash(algorithm);
+        }
+        const uint32_t id = nextStream++;
+        streams[id] = std::move(hasher);
+        HashProtocol::putU32(request.response, id);
+    }
+
+    void finalize(Request& request) {
+        auto found = streams.find(request.stream);
+        if (found == streams.end()) {
+            throw std::runtime_error("Unknown stream " + std::to_string(request.stream));
+        }
+        std::unique_ptr<HashInterface> hasher = std::move(found->second);
+        streams.erase(found);
+        hasher->finalize();
+        request.response.resize(hasher->getHashSize());
+        hasher->getDigest(request.response.data());
+
+        auto& pool = idle[lowerCase(hasher->getAlgorithmName())];
+        if (pool.size() < MAX_IDLE_HASHERS) {
+            hasher->reset();
+            pool.push_back(std::move(hasher));
+        }
+    }
+
+    void attach(Request& request) {
+        int regionFd;
+        {
+            std::lock_guard<std::mutex> lock(fdMutex);
+            if (receivedFds.empty()) {
+                throw std::runtime_error("ATTACH without a ring descriptor");
+            }
+            regionFd = receivedFds.front();
+            receivedFds.pop_front();
+        }
+        ring = HashRing::Region::attach(regionFd);
+        sqHead = ring->header().sqHead.load(std::memory_order_acquire);
+        cqTail = ring->header().cqTail.load(std::memory_order_acquire);
+        HashProtocol::putU32(request.response, ring->getEntries());
+    }
+
+    // Hash every pending submission that has room in the completion ring
+    void enter(Request& request) {
+        if (!ring) {
+            throw std::runtime_error("No ring attached");
+        }
+        HashRing::Header& header = ring->header();
+        const uint32_t entries = ring->getEntries();
+        const uint32_t mask = entries - 1;
+        const uint32_t pending = header.sqTail.load(std::memory_order_acquire) - sqHead;
+        const uint32_t used = cqTail - header.cqHead.load(std::memory_order_acquire);
+        if (pending > entries || used > entries) {
+            throw std::runtime_error("Corrupt ring indices");
+        }
+        const uint32_t count = std::min(pending, entries - used);
+
+        // Entries are copied before validation so the client cannot change them underneath
+        std::vector<HashRing::Submission> submissions(count);
+        std::vector<HashRing::Completion> completions(count);
+        std::unordered_map<std::string, std::vector<uint32_t>> groups;
+        for (uint32_t i = 0; i < count; ++i) {
+            const HashRing::Submission& submission = submissions[i] = ring->submissions()[(sqHead + i) & mask];
+            HashRing::Completion& completion = completions[i];
+            std::memset(&completion, 0, sizeof(completion));
+            completion.userData = submission.userData;
+            completion.status = -1;
+            if (submission.algorithmLength > HashRing::MAX_ALGORITHM_NAME ||
+                submission.offset > ring->getDataSize() || submission.length > ring->getDataSize() - submission.offset) {
+                continue;
+            }
+            const std::string algorithm = lowerCase(std::string(submission.algorithm, submission.algorithmLength));
+            if (HashFactory::isSupported(algorithm)) {
+                groups[algorithm].push_back(i);
+            }
+        }
+
+        // Each algorithm's submissions go through the multi-buffer kernels straight from shared pages
+        for (const auto& group : groups) {
+            const size_t hashSize = HashFactory::createHash(group.first)->getHashSize();
+            std::vector<HashSpan> inputs;
+            inputs.reserve(group.second.size());
+            for (uint32_t index : group.second) {
+                inputs.push_back(HashSpan{ring->data() + submissions[index].offset,
+                                          static_cast<size_t>(submissions[index].length)});
+            }
+            std::vector<uint8_t> digests(inputs.size() * hashSize);
+            hashBatch(group.first, inputs.data(), inputs.size(), digests.data());
+            for (size_t i = 0; i < group.second.size(); ++i) {
+                HashRing::Completion& completion = completions[group.second[i]];
+                completion.status = 0;
+                completion.digestLength = static_cast<uint32_t>(hashSize);
+                std::memcpy(completion.digest, digests.data() + i * hashSize, hashSize);
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i) {
+            ring->completions()[(cqTail + i) & mask] = completions[i];
+        }
+        cqTail += count;
+        sqHead += count;
+        header.cqTail.store(cqTail, std::memory_order_release);
+        header.sqHead.store(sqHead, std::memory_order_release);
+        HashProtocol::putU32(request.response, count);
+    }
+
+    HashInterface& findStream(uint32_t id) {
+        auto found = streams.find(id);
+        if (found == streams.end()) {
+            throw std::runtime_error("Unknown stream " + std::to_string(id));
+        }
+        return *found->second;
+    }
+};
+
+// One message of a HASH or BATCH request, where its digest goes and whose connection asked
+struct HashServer::OneShot {
+    HashSpan input;
+    uint8_t* digest;
+    Request* request;
+    Connection* owner;
+};
+
+HashServer::HashServer(const std::string& socketPath, size_t threads)
+    : socketPath_(socketPath), listenFd_(-1), epollFd_(-1), wakePipe_{-1, -1},
+      connectionCount_(0), stopping_(false) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Invalid socket path: " + socketPath);
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    try {
+        listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (listenFd_ < 0) {
+            throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+        }
+        ::unlink(socketPath.c_str());
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listenFd_, SOMAXCONN) != 0) {
+            throw std::runtime_error("Cannot listen on " + socketPath + ": " + std::strerror(errno));
+        }
+
+        epollFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd_ < 0 || ::pipe2(wakePipe_, O_CLOEXEC | O_NONBLOCK) != 0) {
+            throw std::runtime_error(std::string("Cannot create event loop: ") + std::strerror(errno));
+        }
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = listenFd_;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &event);
+        event.data.fd = wakePipe_[0];
+        ::epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakePipe_[0], &event);
+    } catch (...) {
+        for (int fd : {listenFd_, epollFd_, wakePipe_[0], wakePipe_[1]}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        throw;
+    }
+
+    pool_.reset(new ThreadPool(threads));
+}
+
+HashServer::~HashServer() {
+    // Workers may still hold connections
+    pool_.reset();
+    for (auto& entry : connections_) {
+        ::close(entry.first);
+    }
+    ::close(listenFd_);
+    ::close(epollFd_);
+    ::close(wakePipe_[0]);
+    ::close(wakePipe_[1]);
+    ::unlink(socketPath_.c_str());
+}
+
+void HashServer::stop() {
+    stopping_.store(true);
+    wake();
+}
+
+void HashServer::wake() {
+    const char byte = 0;
+    // A full pipe already guarantees a wake-up
+    ssize_t ignored = ::write(wakePipe_[1], &byte, 1);
+    (void)ignored;
+}
+
+void HashServer::run() {
+    epoll_event events[64];
+    while (!stopping_.load()) {
+        const int ready = ::epoll_wait(epollFd_, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == wakePipe_[0]) {
+                char drain[64];
+                while (::read(wakePipe_[0], drain, sizeof(drain)) > 0) {
+                }
+            } else if (fd == listenFd_) {
+                acceptConnections();
+            } else {
+                auto found = connections_.find(fd);
+                if (found == connections_.end()) {
+                    continue;
+                }
+                Connection& connection = *found->second;
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !connection.peerClosed) {
+                    readConnection(connection);
+                }
+                if ((events[i].events & (EPOLLHUP | EPOLLERR)) && connection.peerClosed) {
+                    // Hung up in both directions: nobody is left to read the responses
+                    connection.failed = true;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    writeConnection(connection);
+                }
+            }
+        }
+
+        processRequests();
+    }
+}
+
+void HashServer::acceptConnections() {
+    for (;;) {
+        const int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            return;     // EAGAIN, or out of descriptors until a client leaves
+        }
+        std::unique_ptr<Connection> connection(new Connection(fd));
+        connection->events = EPOLLIN;
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(connection);
+        connectionCount_.store(connections_.size());
+    }
+}
+
+void HashServer::readConnection(Connection& connection) {
+    size_t total = 0;
+    while (total < READ_QUOTA) {
+        const size_t offset = connection.input.size();
+        connection.input.resize(offset + 65536);
+
+        // recvmsg so descriptors passed for ATTACH are not dropped
+        iovec vector;
+        vector.iov_base = connection.input.data() + offset;
+        vector.iov_len = 65536;
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        const ssize_t n = ::recvmsg(connection.fd, &message, MSG_CMSG_CLOEXEC);
+        connection.input.resize(offset + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+        if (n > 0) {
+            for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+                if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+                    const size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                    const int* fds = reinterpret_cast<const int*>(CMSG_DATA(header));
+                    std::lock_guard<std::mutex> lock(connection.fdMutex);
+                    connection.receivedFds.insert(connection.receivedFds.end(), fds, fds + count);
+                }
+            }
+        }
+        if (n > 0) {
+            total += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0) {
+            connection.peerClosed = true;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            connection.failed = true;
+        }
+        break;
+    }
+}
+
+void HashServer::writeConnection(Connection& connection) {
+    while (connection.pendingOutput() > 0) {
+        const ssize_t n = ::send(connection.fd, connection.output.data() + connection.outputOffset,
+                                 connection.pendingOutput(), MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.outputOffset += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                connection.failed = true;
+            }
+            break;
+        }
+    }
+    if (connection.pendingOutput() == 0) {
+        connection.output.clear();
+        connection.outputOffset = 0;
+    }
+}
+
+void HashServer::updateEvents(Connection& connection) {
+    uint32_t wanted = 0;
+    if (!connection.peerClosed && connection.pendingOutput() < MAX_PENDING_OUTPUT &&
+        connection.input.size() < MAX_BUFFERED_INPUT) {
+        wanted |= EPOLLIN;
+    }
+    if (connection.pendingOutput() > 0) {
+        wanted |= EPOLLOUT;
+    }
+    if (wanted != connection.events) {
+        epoll_event event;
+        event.events = wanted;
+        event.data.fd = connection.fd;
+        ::epoll_ctl(epollFd_, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = wanted;
+    }
+}
+
+void HashServer::closeConnection(int fd) {
+    ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections_.erase(fd);
+    connectionCount_.store(connections_.size());
+}
+
+void HashServer::processRequests() {
+    // Finished work first: responses in request order, then as much as the sockets take now
+    std::vector<Connection*> finished;
+    {
+        std::lock_guard<std::mutex> lock(completedMutex_);
+        finished.swap(completed_);
+    }
+    for (Connection* connection : finished) {
+        for (const auto& failure : connection->failures) {
+            failure.first->fail(failure.second);
+        }
+        connection->failures.clear();
+        for (const auto& request : connection->requests) {
+            connection->output.push_back(request.status);
+            HashProtocol::putU32(connection->output, static_cast<uint32_t>(request.response.size()));
+            connection->output.insert(connection->output.end(), request.response.begin(), request.response.end());
+        }
+        connection->requests.clear();
+        connection->inFlight = false;
+        writeConnection(*connection);
+    }
+
+    // A connection with work in flight keeps its later requests buffered, so responses stay ordered
+    std::vector<Connection*> active;
+    for (auto& entry : connections_) {
+        Connection& connection = *entry.second;
+        if (connection.inFlight || connection.failed) {
+            continue;
+        }
+        if (!connection.parseRequests()) {
+            // Answer the frames before the bad one, then hang up
+            connection.input.clear();
+            connection.peerClosed = true;
+        }
+        if (!connection.requests.empty()) {
+            active.push_back(&connection);
+        }
+    }
+    dispatchRequests(active);
+
+    // Half-closed connections stay until their responses are written
+    std::vector<int> closing;
+    for (auto& entry : connections_) {
+        Connection& connection = *entry.second;
+        if (connection.inFlight) {
+            if (connection.failed && connection.watched) {
+                ::epoll_ctl(epollFd_, EPOLL_CTL_DEL, connection.fd, nullptr);
+                connection.watched = false;
+            } else if (connection.watched) {
+                updateEvents(connection);
+            }
+        } else if (connection.failed || (connection.peerClosed && connection.pendingOutput() == 0)) {
+            closing.push_back(entry.first);
+        } else {
+            updateEvents(connection);
+        }
+    }
+    for (int fd : closing) {
+        closeConnection(fd);
+    }
+}
+
+void HashServer::dispatchRequests(const std::vector<Connection*>& active) {
+    // Each connection is held until all of its tasks are queued, so it cannot complete early
+    for (Connection* connection : active) {
+        connection->inFlight = true;
+        connection->outstanding.store(1);
+    }
+
+    // Group one-shot messages from every connection by algorithm
+    std::unordered_map<std::string, std::vector<OneShot>> oneShots;
+    std::unordered_map<std::string, size_t> hashSizes;
+    for (Connection* connection : active) {
+        bool hasStreamRequests = false;
+        for (auto& request : connection->requests) {
+            const uint8_t opcode = request.opcode;
+            if (opcode == HashProtocol::OPEN || opcode == HashProtocol::UPDATE || opcode == HashProtocol::FINALIZE ||
+                opcode == HashProtocol::ATTACH || opcode == HashProtocol::ENTER) {
+                hasStreamRequests = true;
+                continue;
+            }
+            if (opcode != HashProtocol::HASH && opcode != HashProtocol::BATCH) {
+                request.fail("Unknown opcode " + std::to_string(opcode));
+                continue;
+            }
+
+            const std::vector<uint8_t>& payload = request.payload;
+            if (payload.empty() || payload.size() < 1u + payload[0]) {
+                request.fail("Malformed request");
+                continue;
+            }
+            const std::string algorithm = lowerCase(std::string(payload.begin() + 1, payload.begin() + 1 + payload[0]));
+            auto known = hashSizes.find(algorithm);
+            if (known == hashSizes.end()) {
+                if (!HashFactory::isSupported(algorithm)) {
+                    request.fail("Unsupported hash algorithm: " + algorithm);
+                    continue;
+                }
+                known = hashSizes.emplace(algorithm, HashFactory::createHash(algorithm)->getHashSize()).first;
+            }
+            const size_t hashSize = known->second;
+            size_t offset = 1u + payload[0];
+
+            std::vector<HashSpan> messages;
+            if (opcode == HashProtocol::HASH) {
+                messages.push_back(HashSpan{payload.data() + offset, payload.size() - offset});
+            } else {
+                bool valid = payload.size() - offset >= 4;
+                const uint32_t count = valid ? HashProtocol::getU32(payload.data() + offset) : 0;
+                offset += 4;
+                for (uint32_t i = 0; valid && i < count; ++i) {
+                    valid = payload.size() - offset >= 4;
+                    if (valid) {
+                        const uint32_t length = HashProtocol::getU32(payload.data() + offset);
+                        offset += 4;
+                        valid = payload.size() - offset >= length;
+                        if (valid) {
+                            messages.push_back(HashSpan{payload.data() + offset, length});
+                            offset += length;
+                        }
+                    }
+                }
+                if (!valid || offset != payload.size()) {
+                    request.fail("Malformed batch request");
+                    continue;
+                }
+            }
+
+            request.response.resize(messages.size() * hashSize);
+            auto& group = oneShots[algorithm];
+            for (size_t i = 0; i < messages.size(); ++i) {
+                group.push_back(OneShot{messages[i], request.response.data() + i * hashSize, &request, connection});
+            }
+        }
+        if (hasStreamRequests) {
+            connection->outstanding.fetch_add(1);
+            pool_->submit([this, connection]() {
+                connection->runStreamRequests();
+                release(connection);
+            });
+        }
+    }
+
+    for (auto& group : oneShots) {
+        const std::string& algorithm = group.first;
+        const std::vector<OneShot>& messages = group.second;
+        const size_t hashSize = hashSizes[algorithm];
+        for (size_t start = 0; start < messages.size(); start += BATCH_SLICE) {
+            const size_t count = std::min(BATCH_SLICE, messages.size() - start);
+            std::vector<OneShot> slice(messages.begin() + static_cast<std::ptrdiff_t>(start),
+                                       messages.begin() + static_cast<std::ptrdiff_t>(start + count));
+            // A group lists each connection's messages contiguously
+            std::vector<Connection*> owners;
+            for (const OneShot& message : slice) {
+                if (owners.empty() || owners.back() != message.owner) {
+                    owners.push_back(message.owner);
+                    message.owner->outstanding.fetch_add(1);
+                }
+            }
+            pool_->submit([this, algorithm, hashSize, slice, owners]() {
+                HashSpan inputs[BATCH_SLICE];
+                for (size_t i = 0; i < slice.size(); ++i) {
+                    inputs[i] = slice[i].input;
+                }
+                std::vector<uint8_t> digests(slice.size() * hashSize);
+                try {
+                    hashBatch(algorithm, inputs, slice.size(), digests.data());
+                    for (size_t i = 0; i < slice.size(); ++i) {
+                        std::memcpy(slice[i].digest, digests.data() + i * hashSize, hashSize);
+                    }
+                } catch (const std::exception& e) {
+                    // Each affected request once, even if several of its messages are in this slice
+                    for (size_t i = 0; i < slice.size(); ++i) {
+                        if (i == 0 || slice[i].request != slice[i - 1].request) {
+                            std::lock_guard<std::mutex> lock(slice[i].owner->failureMutex);
+                            slice[i].owner->failures.emplace_back(slice[i].request, e.what());
+                        }
+                    }
+                }
+                for (Connection* owner : owners) {
+                    release(owner);
+                }
+            });
+        }
+    }
+
+    for (Connection* connection : active) {
+        release(connection);
+    }
+}
+
+void HashServer::release(Connection* connection) {
+    if (connection->outstanding.fetch_sub(1) == 1) {
+        {
+            std::lock_guard<std::mutex> lock(completedMutex_);
+            completed_.push_back(connection);
+        }
+        wake();
+    }
+}
+
+#else
+
+struct HashServer::Connection {
+};
+
+HashServer::HashServer(const std::string& socketPath, size_t)
+    : socketPath_(socketPath), listenFd_(-1), epollFd_(-1), wakePipe_{-1, -1},
+      connectionCount_(0), stopping_(false) {
+    throw std::runtime_error("The hashing daemon requires epoll (Linux)");
+}
+
+HashServer::~HashServer() {
+}
+
+void HashServer::run() {
+}
+
+void HashServer::stop() {
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef HASH_SERVER_H
+#define HASH_SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * Long-running hashing daemon on a Unix domain socket (see hash_protocol.h)
+ *
+ * A single epoll loop owns every connection. Each loop iteration reads what
+ * is available, gathers every complete request from every idle connection
+ * and hands them to a worker pool: streaming requests run as one task per
+ * connection (so they stay ordered), while one-shot HASH and BATCH messages
+ * from all connections are grouped by algorithm and hashed together through
+ * hashBatch, filling multi-buffer lanes across clients. The loop does not
+ * wait for the workers; the last task of a connection posts it back through
+ * the wake pipe, and its responses are then queued in request order and
+ * written without blocking. A connection with requests in flight keeps its
+ * later requests buffered until then.
+ *
+ * A client that shuts down its sending side still receives every response;
+ * the connection is closed once they are written, or on a socket error.
+ *
+ * Finalized stream hashers are reset and kept per connection for the next
+ * OPEN of the same algorithm.
+ *
+ * A connection may also ATTACH a shared-memory ring region (hash_ring.h);
+ * ENTER then hashes every pending submission directly from the mapped pages
+ * and posts the digests to the completion ring, so no payload crosses the
+ * socket.
+ */
+class HashServer {
+public:
+    // Open streams allowed per connection
+    static constexpr size_t MAX_STREAMS = 4096;
+
+    /**
+     * Bind and listen on socketPath (an existing socket file is replaced)
+     * @param socketPath Filesystem path of the socket
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @throws std::runtime_error if the socket cannot be created
+     */
+    explicit HashServer(const std::string& socketPath, size_t threads = 0);
+
+    /**
+     * Close every connection and remove the socket file
+     */
+    ~HashServer();
+
+    HashServer(const HashServer&) = delete;
+    HashServer& operator=(const HashServer&) = delete;
+
+    /**
+     * Serve until stop() is called
+     */
+    void run();
+
+    /**
+     * Make run() return; safe from other threads and signal handlers
+     */
+    void stop();
+
+    /**
+     * Get the number of open client connections
+     */
+    size_t getConnectionCount() const { return connectionCount_.load(); }
+
+private:
+    struct Connection;
+    struct OneShot;
+
+    void acceptConnections();
+    void readConnection(Connection& connection);
+    void writeConnection(Connection& connection);
+    void updateEvents(Connection& connection);
+    void closeConnection(int fd);
+    void processRequests();
+    void dispatchRequests(const std::vector<Connection*>& active);
+    void release(Connection* connection);
+    void wake();
+
+    std::string socketPath_;
+    int listenFd_;
+    int epollFd_;
+    int wakePipe_[2];
+    std::unique_ptr<ThreadPool> pool_;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::mutex completedMutex_;
+    std::vector<Connection*> completed_;    // Released by the workers, awaiting their responses
+    std::atomic<size_t> connectionCount_;
+    std::atomic<bool> stopping_;
+};
+
+#endif // HASH_SERVER_H
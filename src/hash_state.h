@@ -0,0 +1,155 @@
+#ifndef HASH_STATE_H
+#define HASH_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * Serialized hasher state
+ *
+ * Layout (all integers big-endian):
+ *   "HGST"  magic
+ *   u8      format version (1)
+ *   u8      algorithm name length, followed by the name
+ *   ...     algorithm fields written by the hasher
+ *
+ * A state is only importable into a hasher of the same algorithm name.
+ */
+namespace HashState {
+
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
+    /**
+     * Append big-endian integers to a byte buffer; shared by every file
+     * format and digest encoding that is not a hash state
+     */
+    inline void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    inline void appendU64(std::vector<uint8_t>& out, uint64_t value) {
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    class Writer {
+    public:
+        explicit Writer(const std::string& algorithm) {
+            putBytes(reinterpret_cast<const uint8_t*>("HGST"), 4);
+            putU8(FORMAT_VERSION);
+            putU8(static_cast<uint8_t>(algorithm.size()));
+            putBytes(reinterpret_cast<const uint8_t*>(algorithm.data()), algorithm.size());
+        }
+
+        void putU8(uint8_t value) { data_.push_back(value); }
+
+        void putU32(uint32_t value) { appendU32(data_, value); }
+
+        void putU64(uint64_t value) { appendU64(data_, value); }
+
+        void putBytes(const uint8_t* bytes, size_t length) {
+            data_.insert(data_.end(), bytes, bytes + length);
+        }
+
+        template <typename Word>
+        void putWords(const Word* words, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                sizeof(Word) == 8 ? putU64(static_cast<uint64_t>(words[i]))
+                                  : putU32(static_cast<uint32_t>(words[i]));
+            }
+        }
+
+        // Length-prefixed nested state (used by composite hashers such as HMAC)
+        void putBlob(const std::vector<uint8_t>& blob) {
+            putU32(static_cast<uint32_t>(blob.size()));
+            putBytes(blob.data(), blob.size());
+        }
+
+        std::vector<uint8_t> take() { return std::move(data_); }
+
+    private:
+        std::vector<uint8_t> data_;
+    };
+
+    class Reader {
+    public:
+        /**
+         * @throws std::invalid_argument if the header is malformed or names another algorithm
+         */
+        Reader(const uint8_t* data, size_t length, const std::string& algorithm)
+            : data_(data), length_(length), offset_(0) {
+            if (data == nullptr && length > 0) {
+                throw std::invalid_argument("Hash state data cannot be null");
+            }
+            const uint8_t* magic = getBytes(4);
+            if (magic[0] != 'H' || magic[1] != 'G' || magic[2] != 'S' || magic[3] != 'T') {
+                throw std::invalid_argument("Not a serialized hash state");
+            }
+            if (getU8() != FORMAT_VERSION) {
+                throw std::invalid_argument("Unsupported hash state version");
+            }
+            const size_t nameLength = getU8();
+            const std::string name(reinterpret_cast<const char*>(getBytes(nameLength)), nameLength);
+            if (name != algorithm) {
+                throw std::invalid_argument("Hash state is for " + name + ", not " + algorithm);
+            }
+        }
+
+        uint8_t getU8() { return *getBytes(1); }
+
+        uint32_t getU32() {
+            const uint8_t* p = getBytes(4);
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+        }
+
+        uint64_t getU64() {
+            uint64_t high = getU32();
+            return (high << 32) | getU32();
+        }
+
+        const uint8_t* getBytes(size_t length) {
+            if (length > length_ - offset_) {
+                throw std::invalid_argument("Truncated hash state");
+            }
+            const uint8_t* p = data_ + offset_;
+            offset_ += length;
+            return p;
+        }
+
+        template <typename Word>
+        void getWords(Word* words, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                words[i] = static_cast<Word>(sizeof(Word) == 8 ? getU64() : getU32());
+            }
+        }
+
+        std::vector<uint8_t> getBlob() {
+            const size_t length = getU32();
+            const uint8_t* p = getBytes(length);
+            return std::vector<uint8_t>(p, p + length);
+        }
+
+        /**
+         * @throws std::invalid_argument if unread bytes remain
+         */
+        void finish() const {
+            if (offset_ != length_) {
+                throw std::invalid_argument("Trailing data after hash state");
+            }
+        }
+
+    private:
+        const uint8_t* data_;
+        size_t length_;
+        size_t offset_;
+    };
+}
+
+#endif // HASH_STATE_H
@@ -0,0 +1,240 @@
+#ifndef HMAC_H
+#define HMAC_H
+
+#include "hash_base.h"
+#include "hash_constants.h"
+#include "hash_state.h"
+#include "multi_buffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * HMAC (RFC 2104) over any concrete hash algorithm
+ *
+ * The key is absorbed once: the ipad and opad blocks are compressed into two
+ * midstate copies of H at construction time. Each message then starts from a
+ * copy of those midstates, so the per-message cost is the message itself plus
+ * one outer block instead of two extra key-block compressions.
+ */
+template <typename H>
+class HMAC : public HashInterface {
+public:
+    /**
+     * Constructor
+     * @param key Pointer to key bytes
+     * @param keyLength Key length in bytes (keys longer than a block are hashed first)
+     */
+    HMAC(const uint8_t* key, size_t keyLength) {
+        setKey(key, keyLength);
+    }
+
+    /**
+     * Replace the key and recompute the inner/outer midstates
+     */
+    void setKey(const uint8_t* key, size_t keyLength) {
+        if (key == nullptr && keyLength > 0) {
+            throw std::invalid_argument("HMAC key cannot be null");
+        }
+
+        const size_t blockSize = innerMidstate.getBlockSize();
+        uint8_t keyBlock[HASH_CONSTANTS::MAX_BLOCK_SIZE];
+        std::memset(keyBlock, 0, sizeof(keyBlock));
+
+        if (keyLength > blockSize) {
+            H keyHasher;
+            keyHasher.update(key, keyLength);
+            keyHasher.finalize();
+            keyHasher.getDigest(keyBlock);
+        } else if (keyLength > 0) {
+            std::memcpy(keyBlock, key, keyLength);
+        }
+
+        uint8_t pad[HASH_CONSTANTS::MAX_BLOCK_SIZE];
+
+        innerMidstate.reset();
+        for (size_t i = 0; i < blockSize; ++i) {
+            pad[i] = keyBlock[i] ^ 0x36;
+        }
+        innerMidstate.update(pad, blockSize);
+
+        outerMidstate.reset();
+        for (size_t i = 0; i < blockSize; ++i) {
+            pad[i] = keyBlock[i] ^ 0x5c;
+        }
+        outerMidstate.update(pad, blockSize);
+
+        // Clear key material from the stack
+        std::memset(keyBlock, 0, sizeof(keyBlock));
+        std::memset(pad, 0, sizeof(pad));
+
+        reset();
+    }
+
+    // HashInterface implementation
+    void reset() override {
+        inner = innerMidstate;
+        outer = outerMidstate;
+    }
+
+    void update(const uint8_t* data, size_t length) override {
+        inner.update(data, length);
+    }
+
+    void finalize() override {
+        if (outer.isFinalized()) {
+            return; // Already finalized, avoid double processing
+        }
+        finishOuter(inner, outer);
+    }
+
+    void getDigest(uint8_t* digest) const override {
+        outer.getDigest(digest);
+    }
+
+    std::string getHash() const override {
+        uint8_t digest[HASH_CONSTANTS::MAX_HASH_SIZE];
+        getDigest(digest);
+        return HashBase::toHex(digest, getHashSize());
+    }
+
+    size_t getBlockSize() const override { return outer.getBlockSize(); }
+    size_t getHashSize() const override { return outer.getHashSize(); }
+    std::string getAlgorithmName() const override { return "HMAC-" + outer.getAlgorithmName(); }
+    bool isFinalized() const override { return outer.isFinalized(); }
+
+    std::unique_ptr<HashInterface> clone() const override {
+        return std::unique_ptr<HashInterface>(new HMAC(*this));
+    }
+
+    // The state carries the keyed midstates, so it must be protected like the key
+    std::vector<uint8_t> exportState() const override {
+        HashState::Writer writer(getAlgorithmName());
+        writer.putBlob(innerMidstate.exportState());
+        writer.putBlob(outerMidstate.exportState());
+        writer.putBlob(inner.exportState());
+        writer.putBlob(outer.exportState());
+        return writer.take();
+    }
+
+    void importState(const uint8_t* data, size_t length) override {
+        HashState::Reader reader(data, length, getAlgorithmName());
+        H states[4];
+        for (H& state : states) {
+            std::vector<uint8_t> blob = reader.getBlob();
+            state.importState(blob.data(), blob.size());
+        }
+        reader.finish();
+
+        innerMidstate = states[0];
+        outerMidstate = states[1];
+        inner = states[2];
+        outer = states[3];
+    }
+
+    /**
+     * One-shot MAC of a single message, leaving the streaming state untouched
+     * @param data Message bytes
+     * @param length Message length in bytes
+     * @param digest Output buffer of at least getHashSize() bytes
+     */
+    void compute(const uint8_t* data, size_t length, uint8_t* digest) const {
+        H messageInner = innerMidstate;
+        H messageOuter = outerMidstate;
+        messageInner.update(data, length);
+        finishOuter(messageInner, messageOuter);
+        messageOuter.getDigest(digest);
+    }
+
+    /**
+     * MAC many messages with the same key
+     * SHA-2 instantiations run the inner and outer hashes in multi-buffer
+     * lanes started from the key midstates; other algorithms fall back to
+     * one compute() per message.
+     * Digests are written contiguously, getHashSize() bytes per message
+     * @param messages Array of message pointers
+     * @param lengths Array of message lengths
+     * @param count Number of messages
+     * @param digests Output buffer of at least count * getHashSize() bytes
+     */
+    void computeBatch(const uint8_t* const* messages, const size_t* lengths, size_t count,
+                      uint8_t* digests) const {
+        typedef typename MultiBuffer::KernelFor<H>::type Kernel;
+        computeLanes(static_cast<Kernel*>(nullptr), messages, lengths, count, digests);
+    }
+
+private:
+    H innerMidstate;    // State after absorbing key ^ ipad
+    H outerMidstate;    // State after absorbing key ^ opad
+    H inner;            // Streaming inner hash
+    H outer;            // Streaming outer hash
+
+    // SHA-2 fast path: both midstates end on a block boundary, so lanes start from their chaining values
+    template <typename Kernel>
+    void computeLanes(Kernel*, const uint8_t* const* messages, const size_t* lengths, size_t count,
+                      uint8_t* digests) const {
+        typedef typename Kernel::Word Word;
+        const size_t hashSize = getHashSize();
+        const uint64_t blockSize = Kernel::BLOCK_SIZE;
+
+        // Similar lengths share kernel calls, so fewer lanes idle on dummy blocks
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [lengths](size_t a, size_t b) { return lengths[a] < lengths[b]; });
+
+        Word states[Kernel::LANES][8];
+        uint8_t innerDigests[Kernel::LANES][HASH_CONSTANTS::MAX_HASH_SIZE];
+        const uint8_t* pointers[Kernel::LANES] = {};
+        size_t laneLengths[Kernel::LANES] = {};
+        for (size_t first = 0; first < count; first += Kernel::LANES) {
+            const size_t lanes = std::min(static_cast<size_t>(Kernel::LANES), count - first);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                pointers[lane] = messages[order[first + lane]];
+                laneLengths[lane] = lengths[order[first + lane]];
+            }
+            MultiBuffer::hashLanes<Kernel>(innerMidstate.getChainingState(), blockSize, pointers, laneLengths,
+                                           lanes, states);
+
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                MultiBuffer::storeBigEndian(states[lane], innerDigests[lane], hashSize);
+                pointers[lane] = innerDigests[lane];
+                laneLengths[lane] = hashSize;
+            }
+            MultiBuffer::hashLanes<Kernel>(outerMidstate.getChainingState(), blockSize, pointers, laneLengths,
+                                           lanes, states);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                MultiBuffer::storeBigEndian(states[lane], digests + order[first + lane] * hashSize, hashSize);
+            }
+        }
+
+        // Clear key-derived material from the stack
+        std::memset(states, 0, sizeof(states));
+        std::memset(innerDigests, 0, sizeof(innerDigests));
+    }
+
+    // Generic path for algorithms without a lane kernel
+    void computeLanes(void*, const uint8_t* const* messages, const size_t* lengths, size_t count,
+                      uint8_t* digests) const {
+        const size_t hashSize = getHashSize();
+        for (size_t i = 0; i < count; ++i) {
+            compute(messages[i], lengths[i], digests + i * hashSize);
+        }
+    }
+
+    static void finishOuter(H& innerHash, H& outerHash) {
+        uint8_t innerDigest[HASH_CONSTANTS::MAX_HASH_SIZE];
+        innerHash.finalize();
+        innerHash.getDigest(innerDigest);
+        outerHash.update(innerDigest, innerHash.getHashSize());
+        outerHash.finalize();
+        std::memset(innerDigest, 0, sizeof(innerDigest));
+    }
+};
+
+#endif // HMAC_H
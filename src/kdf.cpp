@@ -0,0 +1,279 @@
+#include "kdf.h"
+#include "hmac.h"
+#include "hash_dispatch.h"
+#include "multi_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// One PBKDF2 output block T_i for one input
+struct PBKDF2Job {
+    const PBKDF2Input* input;
+    uint32_t blockIndex;     // 1-based block number i
+    uint8_t* output;
+    size_t length;           // Bytes of T_i written to output
+};
+
+// U_1 = HMAC(P, S || INT(i))
+template <typename H>
+void firstIteration(const PBKDF2Input& input, uint32_t blockIndex, uint8_t* u) {
+    HMAC<H> mac(input.password, input.passwordLength);
+    uint8_t index[4] = {
+        static_cast<uint8_t>(blockIndex >> 24), static_cast<uint8_t>(blockIndex >> 16),
+        static_cast<uint8_t>(blockIndex >> 8), static_cast<uint8_t>(blockIndex)
+    };
+    mac.update(input.salt, input.saltLength);
+    mac.update(index, sizeof(index));
+    mac.finalize();
+    mac.getDigest(u);
+}
+
+// Chaining states after compressing key^ipad and key^opad
+template <typename H, typename Kernel>
+void computeMidstates(const PBKDF2Input& input, typename Kernel::Word* inner, typename Kernel::Word* outer) {
+    H hasher;
+    uint8_t keyBlock[Kernel::BLOCK_SIZE];
+    std::memset(keyBlock, 0, sizeof(keyBlock));
+
+    if (input.passwordLength > Kernel::BLOCK_SIZE) {
+        hasher.update(input.password, input.passwordLength);
+        hasher.finalize();
+        hasher.getDigest(keyBlock);
+    } else if (input.passwordLength > 0) {
+        std::memcpy(keyBlock, input.password, input.passwordLength);
+    }
+
+    uint8_t pad[Kernel::BLOCK_SIZE];
+    std::memcpy(inner, hasher.getInitialState(), 8 * sizeof(typename Kernel::Word));
+    std::memcpy(outer, hasher.getInitialState(), 8 * sizeof(typename Kernel::Word));
+
+    for (size_t i = 0; i < Kernel::BLOCK_SIZE; ++i) {
+        pad[i] = keyBlock[i] ^ 0x36;
+    }
+    Kernel::compress(inner, pad);
+
+    for (size_t i = 0; i < Kernel::BLOCK_SIZE; ++i) {
+        pad[i] = keyBlock[i] ^ 0x5c;
+    }
+    Kernel::compress(outer, pad);
+
+    std::memset(keyBlock, 0, sizeof(keyBlock));
+    std::memset(pad, 0, sizeof(pad));
+}
+
+// Fixed padding for a single-block message of hashSize bytes following one key block
+void prepareIterationBlock(uint8_t* block, size_t blockSize, size_t hashSize) {
+    std::memset(block, 0, blockSize);
+    block[hashSize] = HASH_CONSTANTS::PADDING_BIT;
+    uint64_t bits = static_cast<uint64_t>(blockSize + hashSize) * 8;
+    for (int i = 0; i < 8; ++i) {
+        block[blockSize - 1 - i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+}
+
+// SHA-2 fast path: lanes iterate U_j = HMAC(P, U_{j-1}) on raw compression calls
+template <typename H, typename Kernel>
+void runJobs(std::vector<PBKDF2Job>& jobs, uint32_t iterations, Kernel*) {
+    typedef typename Kernel::Word Word;
+    const size_t hashSize = H().getHashSize();
+
+    Word innerMid[Kernel::LANES][8];
+    Word outerMid[Kernel::LANES][8];
+    Word states[Kernel::LANES][8];
+    uint8_t innerBlocks[Kernel::LANES][Kernel::BLOCK_SIZE];
+    uint8_t outerBlocks[Kernel::LANES][Kernel::BLOCK_SIZE];
+    uint8_t accumulators[Kernel::LANES][HASH_CONSTANTS::MAX_HASH_SIZE];
+    const uint8_t* innerPointers[Kernel::LANES];
+    const uint8_t* outerPointers[Kernel::LANES];
+
+    for (size_t lane = 0; lane < Kernel::LANES; ++lane) {
+        prepareIterationBlock(innerBlocks[lane], Kernel::BLOCK_SIZE, hashSize);
+        prepareIterationBlock(outerBlocks[lane], Kernel::BLOCK_SIZE, hashSize);
+        innerPointers[lane] = innerBlocks[lane];
+        outerPointers[lane] = outerBlocks[lane];
+    }
+
+    for (size_t first = 0; first < jobs.size(); first += Kernel::LANES) {
+        const size_t lanes = std::min(static_cast<size_t>(Kernel::LANES), jobs.size() - first);
+
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const PBKDF2Job& job = jobs[first + lane];
+            computeMidstates<H, Kernel>(*job.input, innerMid[lane], outerMid[lane]);
+            firstIteration<H>(*job.input, job.blockIndex, innerBlocks[lane]);
+            std::memcpy(accumulators[lane], innerBlocks[lane], hashSize);
+        }
+
+        for (uint32_t iteration = 1; iteration < iterations; ++iteration) {
+            // Inner hash: ipad midstate + U_{j-1}
+            std::memcpy(states, innerMid, lanes * sizeof(states[0]));
+            Kernel::compressLanes(states, innerPointers, lanes);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                MultiBuffer::storeBigEndian(states[lane], outerBlocks[lane], hashSize);
+            }
+
+            // Outer hash: opad midstate + inner digest, giving U_j
+            std::memcpy(states, outerMid, lanes * sizeof(states[0]));
+            Kernel::compressLanes(states, outerPointers, lanes);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                MultiBuffer::storeBigEndian(states[lane], innerBlocks[lane], hashSize);
+                for (size_t i = 0; i < hashSize; ++i) {
+                    accumulators[lane][i] ^= innerBlocks[lane][i];
+                }
+            }
+        }
+
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const PBKDF2Job& job = jobs[first + lane];
+            std::memcpy(job.output, accumulators[lane], job.length);
+        }
+    }
+
+    // Clear key-derived material from the stack
+    std::memset(innerMid, 0, sizeof(innerMid));
+    std::memset(outerMid, 0, sizeof(outerMid));
+    std::memset(states, 0, sizeof(states));
+    std::memset(innerBlocks, 0, sizeof(innerBlocks));
+    std::memset(outerBlocks, 0, sizeof(outerBlocks));
+    std::memset(accumulators, 0, sizeof(accumulators));
+}
+
+// Generic path for algorithms without a lane kernel
+template <typename H>
+void runJobs(std::vector<PBKDF2Job>& jobs, uint32_t iterations, void*) {
+    uint8_t u[HASH_CONSTANTS::MAX_HASH_SIZE];
+    uint8_t accumulator[HASH_CONSTANTS::MAX_HASH_SIZE];
+
+    for (const PBKDF2Job& job : jobs) {
+        HMAC<H> mac(job.input->password, job.input->passwordLength);
+        const size_t hashSize = mac.getHashSize();
+
+        firstIteration<H>(*job.input, job.blockIndex, u);
+        std::memcpy(accumulator, u, hashSize);
+
+        for (uint32_t iteration = 1; iteration < iterations; ++iteration) {
+            mac.compute(u, hashSize, u);
+            for (size_t i = 0; i < hashSize; ++i) {
+                accumulator[i] ^= u[i];
+            }
+        }
+        std::memcpy(job.output, accumulator, job.length);
+    }
+
+    std::memset(u, 0, sizeof(u));
+    std::memset(accumulator, 0, sizeof(accumulator));
+}
+
+} // namespace
+
+void PBKDF2::derive(const std::string& algorithm,
+                    const uint8_t* password, size_t passwordLength,
+                    const uint8_t* salt, size_t saltLength,
+                    uint32_t iterations,
+                    uint8_t* output, size_t outputLength) {
+    PBKDF2Input input = {password, passwordLength, salt, saltLength};
+    deriveBatch(algorithm, &input, 1, iterations, output, outputLength);
+}
+
+void PBKDF2::deriveBatch(const std::string& algorithm,
+                         const PBKDF2Input* inputs, size_t count,
+                         uint32_t iterations,
+                         uint8_t* outputs, size_t outputLength) {
+    if (iterations == 0) {
+        throw std::invalid_argument("PBKDF2 iteration count must be at least 1");
+    }
+    if (count > 0 && (inputs == nullptr || (outputs == nullptr && outputLength > 0))) {
+        throw std::invalid_argument("PBKDF2 inputs and outputs cannot be null");
+    }
+
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        const size_t hashSize = H().getHashSize();
+        const uint64_t blocksPerOutput = (outputLength + hashSize - 1) / hashSize;
+        if (blocksPerOutput > UINT32_MAX) {
+            throw std::invalid_argument("PBKDF2 derived key too long");
+        }
+
+        // Flatten every (input, block) pair so lanes fill across passwords
+        std::vector<PBKDF2Job> jobs;
+        jobs.reserve(count * blocksPerOutput);
+        for (size_t n = 0; n < count; ++n) {
+            uint8_t* output = outputs + n * outputLength;
+            for (uint64_t block = 0; block < blocksPerOutput; ++block) {
+                size_t offset = static_cast<size_t>(block) * hashSize;
+                PBKDF2Job job = {&inputs[n], static_cast<uint32_t>(block + 1),
+                                 output + offset, std::min(hashSize, outputLength - offset)};
+                jobs.push_back(job);
+            }
+        }
+
+        typedef typename MultiBuffer::KernelFor<H>::type Kernel;
+        runJobs<H>(jobs, iterations, static_cast<Kernel*>(nullptr));
+    });
+}
+
+void HKDF::extract(const std::string& algorithm,
+                   const uint8_t* salt, size_t saltLength,
+                   const uint8_t* ikm, size_t ikmLength,
+                   uint8_t* prk) {
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        // An absent salt is a string of HashLen zeros; HMAC zero-pads the key to the same effect
+        HMAC<H> mac(salt, saltLength);
+        mac.compute(ikm, ikmLength, prk);
+    });
+}
+
+void HKDF::expand(const std::string& algorithm,
+                  const uint8_t* prk, size_t prkLength,
+                  const uint8_t* info, size_t infoLength,
+                  uint8_t* output, size_t outputLength) {
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        HMAC<H> mac(prk, prkLength);
+        const size_t hashSize = mac.getHashSize();
+        if (outputLength > 255 * hashSize) {
+            throw std::invalid_argument("HKDF output length exceeds 255 * hash size");
+        }
+
+        uint8_t block[HASH_CONSTANTS::MAX_HASH_SIZE];
+        size_t previousLength = 0;
+        size_t offset = 0;
+
+        // T(i) = HMAC(PRK, T(i-1) || info || i), each starting from the cached PRK midstates
+        for (uint8_t counter = 1; offset < outputLength; ++counter) {
+            mac.reset();
+            mac.update(block, previousLength);
+            mac.update(info, infoLength);
+            mac.update(&counter, 1);
+            mac.finalize();
+            mac.getDigest(block);
+            previousLength = hashSize;
+
+            size_t chunk = std::min(hashSize, outputLength - offset);
+            std::memcpy(output + offset, block, chunk);
+            offset += chunk;
+        }
+
+        std::memset(block, 0, sizeof(block));
+    });
+}
+
+void HKDF::derive(const std::string& algorithm,
+                  const uint8_t* ikm, size_t ikmLength,
+                  const uint8_t* salt, size_t saltLength,
+                  const uint8_t* info, size_t infoLength,
+                  uint8_t* output, size_t outputLength) {
+    uint8_t prk[HASH_CONSTANTS::MAX_HASH_SIZE];
+    size_t prkLength = 0;
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        prkLength = H().getHashSize();
+    });
+
+    extract(algorithm, salt, saltLength, ikm, ikmLength, prk);
+    expand(algorithm, prk, prkLength, info, infoLength, output, outputLength);
+    std::memset(prk, 0, sizeof(prk));
+}
@@ -0,0 +1,98 @@
+#ifndef KDF_H
+#define KDF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * One password/salt pair for batch PBKDF2 derivation
+ */
+struct PBKDF2Input {
+    const uint8_t* password;
+    size_t passwordLength;
+    const uint8_t* salt;
+    size_t saltLength;
+};
+
+/**
+ * PBKDF2 (RFC 8018) with HMAC as the pseudorandom function
+ *
+ * For the SHA-2 family the iteration loop runs directly on the SHA256/SHA512
+ * compression function from precomputed HMAC midstates: each iteration is
+ * exactly one inner and one outer block. Independent output blocks and
+ * independent passwords are packed into multi-buffer lanes so the SIMD
+ * kernels stay full. Other algorithms use the generic HMAC<H> path.
+ */
+class PBKDF2 {
+public:
+    /**
+     * Derive a key from a single password
+     * @param algorithm Underlying hash algorithm (case-insensitive)
+     * @param password Password bytes
+     * @param passwordLength Password length in bytes
+     * @param salt Salt bytes
+     * @param saltLength Salt length in bytes
+     * @param iterations Iteration count (must be at least 1)
+     * @param output Output buffer
+     * @param outputLength Number of key bytes to derive
+     * @throws std::invalid_argument on unsupported algorithm or invalid parameters
+     */
+    static void derive(const std::string& algorithm,
+                       const uint8_t* password, size_t passwordLength,
+                       const uint8_t* salt, size_t saltLength,
+                       uint32_t iterations,
+                       uint8_t* output, size_t outputLength);
+
+    /**
+     * Derive keys for many independent passwords with the same parameters
+     * Keys are written contiguously, outputLength bytes per input
+     * @param algorithm Underlying hash algorithm (case-insensitive)
+     * @param inputs Array of password/salt pairs
+     * @param count Number of inputs
+     * @param iterations Iteration count (must be at least 1)
+     * @param outputs Output buffer of at least count * outputLength bytes
+     * @param outputLength Number of key bytes to derive per input
+     * @throws std::invalid_argument on unsupported algorithm or invalid parameters
+     */
+    static void deriveBatch(const std::string& algorithm,
+                            const PBKDF2Input* inputs, size_t count,
+                            uint32_t iterations,
+                            uint8_t* outputs, size_t outputLength);
+};
+
+/**
+ * HKDF (RFC 5869) extract-and-expand key derivation
+ * The PRK's HMAC midstates are computed once and reused for every expansion block.
+ */
+class HKDF {
+public:
+    /**
+     * Extract a pseudorandom key: PRK = HMAC(salt, ikm)
+     * @param prk Output buffer of the algorithm's hash size
+     */
+    static void extract(const std::string& algorithm,
+                        const uint8_t* salt, size_t saltLength,
+                        const uint8_t* ikm, size_t ikmLength,
+                        uint8_t* prk);
+
+    /**
+     * Expand a pseudorandom key into outputLength bytes
+     * @throws std::invalid_argument if outputLength exceeds 255 * hash size
+     */
+    static void expand(const std::string& algorithm,
+                       const uint8_t* prk, size_t prkLength,
+                       const uint8_t* info, size_t infoLength,
+                       uint8_t* output, size_t outputLength);
+
+    /**
+     * Extract followed by expand
+     */
+    static void derive(const std::string& algorithm,
+                       const uint8_t* ikm, size_t ikmLength,
+                       const uint8_t* salt, size_t saltLength,
+                       const uint8_t* info, size_t infoLength,
+                       uint8_t* output, size_t outputLength);
+};
+
+#endif // KDF_H
@@ -0,0 +1,168 @@
+#include "hash_client.h"
+#include "hash_factory.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Load generator for the --serve daemon
+ *
+ * Each client thread opens its own connection and sends a fixed number of
+ * requests of one kind; every digest returned is checked against a local
+ * hasher. Prints request and byte throughput.
+ */
+
+namespace {
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " <socket> [options]\n\n";
+    std::cout << "Options:\n";
+    std::cout << "  --algorithm=<type>  Hash algorithm (default sha256)\n";
+    std::cout << "  --clients=<n>       Concurrent connections (default 8)\n";
+    std::cout << "  --requests=<n>      Requests per connection (default 10000)\n";
+    std::cout << "  --size=<bytes>      Message size (default 64)\n";
+    std::cout << "  --mode=<mode>       hash (one-shot), batch (64 messages per request),\n";
+    std::cout << "                      stream (open, 4 updates, finalize) or ring (64 messages\n";
+    std::cout << "                      per ENTER through shared memory); default hash\n";
+}
+
+std::vector<uint8_t> localDigest(const std::string& algorithm, const uint8_t* data, size_t length) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(data, length);
+    hasher->finalize();
+    std::vector<uint8_t> digest(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return digest;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::strcmp(argv[1], "--help") == 0) {
+        printUsage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    const std::string socketPath = argv[1];
+    std::string algorithm = "sha256";
+    std::string mode = "hash";
+    size_t clients = 8;
+    size_t requests = 10000;
+    size_t size = 64;
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.substr(0, 12) == "--algorithm=") {
+                algorithm = arg.substr(12);
+            } else if (arg.substr(0, 10) == "--clients=") {
+                clients = std::stoul(arg.substr(10));
+            } else if (arg.substr(0, 11) == "--requests=") {
+                requests = std::stoul(arg.substr(11));
+            } else if (arg.substr(0, 7) == "--size=") {
+                size = std::stoul(arg.substr(7));
+            } else if (arg.substr(0, 7) == "--mode=") {
+                mode = arg.substr(7);
+            } else {
+                throw std::invalid_argument("Unknown argument '" + arg + "'");
+            }
+        }
+        if (mode != "hash" && mode != "batch" && mode != "stream" && mode != "ring") {
+            throw std::invalid_argument("Unknown mode '" + mode + "'");
+        }
+        if (!HashFactory::isSupported(algorithm)) {
+            throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    const size_t BATCH_COUNT = 64;
+    std::atomic<uint64_t> completed(0);
+    std::atomic<uint64_t> failures(0);
+    std::vector<std::thread> threads;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c]() {
+            try {
+                HashClient client(socketPath);
+                std::vector<uint8_t> message(size);
+                std::vector<HashSpan> spans(BATCH_COUNT, HashSpan{message.data(), message.size()});
+                if (mode == "ring") {
+                    client.attachRing(BATCH_COUNT, BATCH_COUNT * size);
+                }
+                for (size_t r = 0; r < requests; ++r) {
+                    // Vary the content so a wrong digest cannot go unnoticed
+                    for (size_t i = 0; i < message.size(); ++i) {
+                        message[i] = static_cast<uint8_t>(c * 131 + r * 7 + i);
+                    }
+                    const std::vector<uint8_t> expected = localDigest(algorithm, message.data(), message.size());
+                    if (mode == "hash") {
+                        if (client.hash(algorithm, message.data(), message.size()) != expected) {
+                            ++failures;
+                        }
+                    } else if (mode == "batch") {
+                        for (const auto& digest : client.hashBatch(algorithm, spans.data(), spans.size())) {
+                            if (digest != expected) {
+                                ++failures;
+                            }
+                        }
+                    } else if (mode == "ring") {
+                        for (size_t m = 0; m < BATCH_COUNT; ++m) {
+                            std::memcpy(client.getRingData() + m * size, message.data(), size);
+                            client.submit(algorithm, m * size, size, m);
+                        }
+                        client.enter();
+                        HashRing::Completion completion;
+                        size_t reaped = 0;
+                        for (; client.reap(completion); ++reaped) {
+                            if (completion.status != 0 ||
+                                std::vector<uint8_t>(completion.digest, completion.digest + completion.digestLength) !=
+                                    expected) {
+                                ++failures;
+                            }
+                        }
+                        if (reaped != BATCH_COUNT) {
+                            ++failures;
+                        }
+                    } else {
+                        const uint32_t stream = client.open(algorithm);
+                        const size_t quarter = message.size() / 4;
+                        for (size_t part = 0; part < 4; ++part) {
+                            const size_t end = part == 3 ? message.size() : (part + 1) * quarter;
+                            client.update(stream, message.data() + part * quarter, end - part * quarter);
+                        }
+                        if (client.finalize(stream) != expected) {
+                            ++failures;
+                        }
+                    }
+                    ++completed;
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Client " << c << ": " << e.what() << std::endl;
+                ++failures;
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t messages = completed.load() * (mode == "batch" || mode == "ring" ? BATCH_COUNT : 1);
+    std::cout << completed.load() << " requests (" << messages << " messages) in " << seconds << " s: "
+              << static_cast<uint64_t>(completed.load() / seconds) << " requests/s, "
+              << (messages * size / seconds / (1024 * 1024)) << " MiB/s\n";
+    if (failures.load() > 0) {
+        std::cerr << failures.load() << " failures\n";
+        return 1;
+    }
+    return 0;
+}
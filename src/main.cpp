@@ -1,8 +1,32 @@
 #include "stream_processor.h"
 #include "hash_factory.h"
+#include "hash_config.h"
+#include "tree_hash.h"
+#include "composite_hash.h"
+#include "append_hash.h"
+#include "chunk_index.h"
+#include "rsync_delta.h"
+#include "tee_hash.h"
+#include "copy_hash.h"
+#include "tar_hash.h"
+#include "hash_server.h"
+#include "coprocess.h"
+#include "multi_input.h"
+#include "digest_index.h"
+#include "dupe_finder.h"
+#include "dir_digest.h"
+#include "sampled_fingerprint.h"
+#include "file_io.h"
+#include "hash_base.h"
+#include <atomic>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <cstring>
+#include <csignal>
+#include <stdexcept>
+#include <vector>
 
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " --algorithm=<hash_type>\n\n";
@@ -11,7 +35,56 @@ void printUsage(const char* programName) {
     std::cout << "  --algorithm=<type>  Hash algorithm to use\n";
     std::cout << "  -a <type>           Short form of --algorithm\n";
     std::cout << "  --help, -h          Show this help message\n";
-    std::cout << "  --list              List supported algorithms\n\n";
+    std::cout << "  --list              List supported algorithms\n";
+    std::cout << "  --tree              Hash input as a Merkle tree of leaves in parallel\n";
+    std::cout << "  --leaf-size=<size>  Tree leaf size (default 1M; K/M/G suffixes)\n";
+    std::cout << "  --threads=<n>       Worker threads (default: all cores)\n";
+    std::cout << "  --composite=<fmt>   Composite part digest: s3-etag, dropbox, bittorrent\n";
+    std::cout << "  --part-size=<size>  Composite part size (default: format's convention)\n";
+    std::cout << "  --emit-parts        Print each part digest before the composite\n";
+    std::cout << "  --append-state=<f>  Resume from and save hasher state in sidecar file f;\n";
+    std::cout << "                      stdin must be a regular file that only grows\n";
+    std::cout << "  --index=<f>         Keep per-chunk (--leaf-size) digests in sidecar file f\n";
+    std::cout << "                      and rehash only what changed; prints the --tree root\n";
+    std::cout << "  --cdc               Content-defined chunking: print 'offset length digest'\n";
+    std::cout << "                      for each chunk, hashed in parallel\n";
+    std::cout << "  --cdc-min=<size>    Minimum chunk size (default 2K)\n";
+    std::cout << "  --cdc-avg=<size>    Average chunk size, a power of two (default 8K)\n";
+    std::cout << "  --cdc-max=<size>    Maximum chunk size (default 64K)\n";
+    std::cout << "  --signature         Print rsync-style weak/strong block signatures of the input\n";
+    std::cout << "  --block-size=<size> Signature block size (default 2K)\n";
+    std::cout << "  --delta=<sigfile>   Match the input against a signature: print 'copy offset\n";
+    std::cout << "                      length block' and 'literal offset length' operations\n";
+    std::cout << "  --records=<fmt>     Print one digest per record: lines, nul, u32be-length\n";
+    std::cout << "  --tee               Copy stdin to stdout unchanged while hashing it\n";
+    std::cout << "  --digest-fd=<n>     With --tee, write the digest to descriptor n (default 2)\n";
+    std::cout << "  --digest-file=<f>   With --tee, write the digest to file f\n";
+    std::cout << "  --copy <src> <dst>  Copy src to dst and print the digest, reading src once\n";
+    std::cout << "  --direct            With --copy, write dst with O_DIRECT\n";
+    std::cout << "  --verify            With --copy, re-read dst and compare digests\n";
+    std::cout << "  --tar               Read a tar stream: print 'digest  path' per member file\n";
+    std::cout << "  --archive-digest    With --tar, also print the whole stream's digest as '-'\n";
+    std::cout << "  --serve <socket>    Run as a hashing daemon on a Unix domain socket\n";
+    std::cout << "  --batch[=<fmt>]     Stay resident answering requests on stdin: paths (one\n";
+    std::cout << "                      file per line, default) or frames (u32be-length messages)\n";
+    std::cout << "  --input=<path>      Hash this FIFO or file concurrently with other inputs;\n";
+    std::cout << "                      repeatable, prints 'digest  path' as each one ends\n";
+    std::cout << "  --input-fd=<n>      Same for an inherited descriptor, reported as fd:n\n";
+    std::cout << "  --build-index=<f>   Build a known-digest index f from hex digests on stdin\n";
+    std::cout << "  --bloom-bits=<n>    Index Bloom filter bits per digest (default 10, 0 for none)\n";
+    std::cout << "  --match=<index>     With --batch, print only files whose digest is in the index;\n";
+    std::cout << "                      exit status 1 if none match\n";
+    std::cout << "  --dupes <dir>       List groups of identical files below dir, reading whole\n";
+    std::cout << "                      files only when size and head/tail digests collide\n";
+    std::cout << "  --tree-digest <dir> Print a Merkle digest of dir from entry names, modes and\n";
+    std::cout << "                      contents, hashing files in parallel\n";
+    std::cout << "  --tree-cache=<f>    With --tree-digest, reuse unchanged files and subtrees\n";
+    std::cout << "                      from digest cache file f and update it\n";
+    std::cout << "  --sample            Print a sampled fingerprint of stdin (file or block device)\n";
+    std::cout << "                      from its size, head, tail and seed-chosen chunks\n";
+    std::cout << "  --samples=<n>       Chunks read by --sample, head and tail included (default 1024)\n";
+    std::cout << "  --sample-size=<size> Sampled chunk size (default 64K, rounded to the device)\n";
+    std::cout << "  --seed=<n>          Seed choosing the sampled chunks (default 0)\n\n";
     std::cout << "Supported algorithms:\n";
     auto algorithms = HashFactory::getSupportedAlgorithms();
     for (const auto& algo : algorithms) {
@@ -20,6 +93,34 @@ void printUsage(const char* programName) {
     std::cout << "\nExamples:\n";
     std::cout << "  echo -n 'hello world' | " << programName << " --algorithm=sha256\n";
     std::cout << "  " << programName << " -a md5 < file.txt\n";
+    std::cout << "  " << programName << " -a sha256 --tree --leaf-size=4M < disk.img\n";
+    std::cout << "  " << programName << " --composite=s3-etag --part-size=16M < object.bin\n";
+    std::cout << "  " << programName << " -a sha256 --append-state=app.log.state < app.log\n";
+    std::cout << "  " << programName << " -a sha256 --index=vm.img.idx --leaf-size=4M < vm.img\n";
+    std::cout << "  " << programName << " -a sha256 --cdc --cdc-avg=16K < backup.tar\n";
+    std::cout << "  " << programName << " -a sha256 --signature < old.bin > old.sig\n";
+    std::cout << "  " << programName << " --delta=old.sig < new.bin\n";
+    std::cout << "  " << programName << " -a sha256 --records=lines < events.jsonl\n";
+    std::cout << "  producer | " << programName << " -a sha256 --tee --digest-fd=3 3>digest.txt | consumer\n";
+    std::cout << "  " << programName << " --copy build/app.tar /mnt/release/app.tar -a sha256 --verify\n";
+    std::cout << "  " << programName << " -a sha256 --tar --archive-digest < backup.tar\n";
+    std::cout << "  " << programName << " --serve /run/hashgen.sock --threads=8\n";
+    std::cout << "  find . -type f | " << programName << " -a sha256 --batch\n";
+    std::cout << "  " << programName << " -a sha256 --input=<(job1) --input=<(job2) --input-fd=3 3< <(job3)\n";
+    std::cout << "  " << programName << " -a sha1 --build-index=known.idx < known-sha1.txt\n";
+    std::cout << "  find / -type f | " << programName << " -a sha1 --batch --match=known.idx\n";
+    std::cout << "  " << programName << " -a sha256 --dupes /srv/photos\n";
+    std::cout << "  " << programName << " -a sha256 --tree-digest build/ --tree-cache=.build.digests\n";
+    std::cout << "  " << programName << " -a sha256 --sample --seed=7 < /dev/backup/vol0\n";
+}
+
+// Daemon stopped by SIGINT/SIGTERM
+HashServer* activeServer = nullptr;
+
+void stopServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
 }
 
 void printSupportedAlgorithms() {
@@ -29,8 +130,67 @@ void printSupportedAlgorithms() {
     }
 }
 
+/**
+ * Parse a byte count with an optional K, M or G (binary) suffix
+ */
+size_t parseSize(const std::string& text) {
+    size_t pos = 0;
+    unsigned long long value = std::stoull(text, &pos);
+    std::string suffix = text.substr(pos);
+    
+    if (suffix == "K" || suffix == "k") {
+        value <<= 10;
+    } else if (suffix == "M" || suffix == "m") {
+        value <<= 20;
+    } else if (suffix == "G" || suffix == "g") {
+        value <<= 30;
+    } else if (!suffix.empty()) {
+        throw std::invalid_argument("Invalid size suffix: " + text);
+    }
+    return static_cast<size_t>(value);
+}
+
 int main(int argc, char* argv[]) {
     std::string algorithm;
+    bool treeMode = false;
+    size_t leafSize = HashConfig::DEFAULT_TREE_LEAF_SIZE;
+    size_t threads = 0;
+    std::string compositeFormat;
+    size_t partSize = 0;
+    bool emitParts = false;
+    std::string appendState;
+    std::string indexPath;
+    bool cdcMode = false;
+    size_t cdcMin = GearChunker::DEFAULT_MIN_SIZE;
+    size_t cdcAvg = GearChunker::DEFAULT_AVG_SIZE;
+    size_t cdcMax = GearChunker::DEFAULT_MAX_SIZE;
+    bool signatureMode = false;
+    size_t blockSize = BlockSignature::DEFAULT_BLOCK_SIZE;
+    std::string deltaPath;
+    std::string recordFormat;
+    bool teeMode = false;
+    int digestFd = 2;
+    std::string digestFile;
+    std::string copySource;
+    std::string copyDestination;
+    bool directIO = false;
+    bool verifyCopy = false;
+    bool tarMode = false;
+    bool archiveDigest = false;
+    std::string servePath;
+    std::string batchFormat;
+    std::vector<std::string> inputPaths;
+    std::vector<int> inputFds;
+    std::string buildIndexPath;
+    size_t bloomBits = DigestIndex::DEFAULT_BLOOM_BITS;
+    std::string matchPath;
+    std::string dupesRoot;
+    std::string treeDigestRoot;
+    std::string treeCachePath;
+    bool sampleMode = false;
+    size_t sampleCount = SampledFingerprint::DEFAULT_SAMPLE_COUNT;
+    size_t sampleSize = SampledFingerprint::DEFAULT_SAMPLE_SIZE;
+    uint64_t sampleSeed = 0;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -46,6 +206,147 @@ int main(int argc, char* argv[]) {
             algorithm = arg.substr(12);
         } else if (arg == "-a" && i + 1 < argc) {
             algorithm = argv[++i];
+        } else if (arg == "--tree") {
+            treeMode = true;
+        } else if (arg.substr(0, 12) == "--leaf-size=") {
+            try {
+                leafSize = parseSize(arg.substr(12));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid leaf size '" << arg.substr(12) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 10) == "--threads=") {
+            try {
+                threads = static_cast<size_t>(std::stoul(arg.substr(10)));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid thread count '" << arg.substr(10) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 12) == "--composite=") {
+            compositeFormat = arg.substr(12);
+        } else if (arg.substr(0, 12) == "--part-size=") {
+            try {
+                partSize = parseSize(arg.substr(12));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid part size '" << arg.substr(12) << "'\n";
+                return 1;
+            }
+        } else if (arg == "--emit-parts") {
+            emitParts = true;
+        } else if (arg.substr(0, 15) == "--append-state=") {
+            appendState = arg.substr(15);
+        } else if (arg.substr(0, 8) == "--index=") {
+            indexPath = arg.substr(8);
+        } else if (arg == "--cdc") {
+            cdcMode = true;
+        } else if (arg.substr(0, 10) == "--cdc-min=" || arg.substr(0, 10) == "--cdc-avg=" ||
+                   arg.substr(0, 10) == "--cdc-max=") {
+            size_t size;
+            try {
+                size = parseSize(arg.substr(10));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid chunk size '" << arg.substr(10) << "'\n";
+                return 1;
+            }
+            const std::string which = arg.substr(6, 3);
+            (which == "min" ? cdcMin : which == "avg" ? cdcAvg : cdcMax) = size;
+        } else if (arg == "--signature") {
+            signatureMode = true;
+        } else if (arg.substr(0, 13) == "--block-size=") {
+            try {
+                blockSize = parseSize(arg.substr(13));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid block size '" << arg.substr(13) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 8) == "--delta=") {
+            deltaPath = arg.substr(8);
+        } else if (arg.substr(0, 10) == "--records=") {
+            recordFormat = arg.substr(10);
+        } else if (arg == "--tee") {
+            teeMode = true;
+        } else if (arg.substr(0, 12) == "--digest-fd=") {
+            try {
+                digestFd = std::stoi(arg.substr(12));
+            } catch (const std::exception&) {
+                digestFd = -1;
+            }
+            if (digestFd < 0) {
+                std::cerr << "Error: Invalid digest descriptor '" << arg.substr(12) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 14) == "--digest-file=") {
+            digestFile = arg.substr(14);
+        } else if (arg == "--copy" && i + 2 < argc) {
+            copySource = argv[++i];
+            copyDestination = argv[++i];
+        } else if (arg == "--direct") {
+            directIO = true;
+        } else if (arg == "--verify") {
+            verifyCopy = true;
+        } else if (arg == "--tar") {
+            tarMode = true;
+        } else if (arg == "--archive-digest") {
+            archiveDigest = true;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            servePath = argv[++i];
+        } else if (arg == "--batch") {
+            batchFormat = "paths";
+        } else if (arg.substr(0, 8) == "--batch=") {
+            batchFormat = arg.substr(8);
+        } else if (arg.substr(0, 8) == "--input=") {
+            inputPaths.push_back(arg.substr(8));
+        } else if (arg.substr(0, 11) == "--input-fd=") {
+            int fd = -1;
+            try {
+                fd = std::stoi(arg.substr(11));
+            } catch (const std::exception&) {
+            }
+            if (fd < 0) {
+                std::cerr << "Error: Invalid input descriptor '" << arg.substr(11) << "'\n";
+                return 1;
+            }
+            inputFds.push_back(fd);
+        } else if (arg.substr(0, 14) == "--build-index=") {
+            buildIndexPath = arg.substr(14);
+        } else if (arg.substr(0, 13) == "--bloom-bits=") {
+            try {
+                bloomBits = static_cast<size_t>(std::stoul(arg.substr(13)));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid Bloom filter size '" << arg.substr(13) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 8) == "--match=") {
+            matchPath = arg.substr(8);
+        } else if (arg == "--dupes" && i + 1 < argc) {
+            dupesRoot = argv[++i];
+        } else if (arg == "--tree-digest" && i + 1 < argc) {
+            treeDigestRoot = argv[++i];
+        } else if (arg.substr(0, 13) == "--tree-cache=") {
+            treeCachePath = arg.substr(13);
+        } else if (arg == "--sample") {
+            sampleMode = true;
+        } else if (arg.substr(0, 10) == "--samples=") {
+            try {
+                sampleCount = static_cast<size_t>(std::stoul(arg.substr(10)));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid sample count '" << arg.substr(10) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 14) == "--sample-size=") {
+            try {
+                sampleSize = parseSize(arg.substr(14));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid sample size '" << arg.substr(14) << "'\n";
+                return 1;
+            }
+        } else if (arg.substr(0, 7) == "--seed=") {
+            try {
+                sampleSeed = static_cast<uint64_t>(std::stoull(arg.substr(7)));
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid seed '" << arg.substr(7) << "'\n";
+                return 1;
+            }
         } else {
             std::cerr << "Error: Unknown argument '" << arg << "'\n";
             printUsage(argv[0]);
@@ -53,6 +354,65 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Composite formats fix their own algorithms
+    if (!compositeFormat.empty()) {
+        try {
+            CompositeHasher composite(CompositeHasher::parseFormat(compositeFormat), partSize, threads);
+            composite.processStream(std::cin);
+            if (emitParts) {
+                for (const auto& part : composite.getPartHashes()) {
+                    std::cout << part << "\n";
+                }
+            }
+            std::cout << composite.getHash() << std::endl;
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    // Clients choose the algorithm per request
+    if (!servePath.empty()) {
+        try {
+            HashServer server(servePath, threads);
+            activeServer = &server;
+            std::signal(SIGINT, stopServer);
+            std::signal(SIGTERM, stopServer);
+            server.run();
+            activeServer = nullptr;
+            return 0;
+        } catch (const std::exception& e) {
+            activeServer = nullptr;
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    // Delta matching takes the algorithm and block size from the signature
+    if (!deltaPath.empty()) {
+        try {
+            std::ifstream sigFile(deltaPath);
+            if (!sigFile) {
+                throw std::runtime_error("Cannot open signature file: " + deltaPath);
+            }
+            BlockSignature signature = BlockSignature::read(sigFile);
+            DeltaMatcher matcher(signature);
+            matcher.process(std::cin, [](const DeltaOp& op) {
+                if (op.type == DeltaOp::COPY) {
+                    std::cout << "copy " << op.offset << ' ' << op.length << ' ' << op.block << '\n';
+                } else {
+                    std::cout << "literal " << op.offset << ' ' << op.length << '\n';
+                }
+            });
+            std::cout.flush();
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
     if (algorithm.empty()) {
         std::cerr << "Error: No algorithm specified\n";
         printUsage(argv[0]);
@@ -60,6 +420,194 @@ int main(int argc, char* argv[]) {
     }
     
     try {
+        if (!appendState.empty()) {
+            // Whole-file digest that only reads bytes appended since the last run
+            AppendHasher appender(algorithm, appendState);
+            appender.processFile(0);
+            std::cout << appender.getHash() << std::endl;
+            return 0;
+        }
+        
+        if (sampleMode) {
+            // Triage only: labelled so it is never mistaken for a content digest
+            SampledFingerprint sample(algorithm, sampleSize, sampleCount, sampleSeed, threads);
+            sample.processFile(0);
+            std::cout << "sampled:" << sample.getHash() << std::endl;
+            std::cerr << "sampled " << sample.getChunksRead() << " of " << sample.getChunkCount() << " chunks of "
+                      << sample.getChunkSize() << " bytes; read " << sample.getBytesRead() << " of "
+                      << sample.getFileSize() << " bytes\n";
+            return 0;
+        }
+        
+        if (!indexPath.empty()) {
+            // Tree root over chunks, reusing unchanged chunk digests from the sidecar
+            ChunkIndex index(algorithm, leafSize, indexPath, threads);
+            index.processFile(0);
+            std::cout << index.getHash() << std::endl;
+            return 0;
+        }
+        
+        if (cdcMode) {
+            // One record per content-defined chunk, in stream order
+            GearChunker chunker(cdcMin, cdcAvg, cdcMax);
+            StreamProcessor processor(HashFactory::createHash(algorithm));
+            processor.processChunks(std::cin, chunker, threads, [](const ChunkRecord& record) {
+                std::cout << record.offset << ' ' << record.length << ' '
+                          << HashBase::toHex(record.digest.data(), record.digest.size()) << '\n';
+            });
+            std::cout.flush();
+            return 0;
+        }
+        
+        if (!copySource.empty()) {
+            // Single read of the source feeds both the copy and the digest
+            CopyHasher copier(algorithm, directIO, verifyCopy);
+            copier.copy(copySource, copyDestination);
+            std::cout << copier.getHash() << std::endl;
+            return 0;
+        }
+        
+        if (tarMode) {
+            // sha256sum-style lines, one per regular file in the archive
+            TarHasher tar(algorithm, archiveDigest);
+            tar.processStream(std::cin, [](const TarMember& member) {
+                std::cout << HashBase::toHex(member.digest.data(), member.digest.size()) << "  "
+                          << member.path << '\n';
+            });
+            if (archiveDigest) {
+                std::cout << tar.getArchiveHash() << "  -\n";
+            }
+            std::cout.flush();
+            return 0;
+        }
+        
+        if (teeMode) {
+            // stdout carries the data, so the digest goes to its own descriptor or file
+            TeeHasher tee(algorithm);
+            tee.process(0, 1);
+            const std::string line = tee.getHash() + "\n";
+            if (!digestFile.empty()) {
+                std::ofstream out(digestFile);
+                out << line;
+                if (!out) {
+                    throw std::runtime_error("Cannot write digest file: " + digestFile);
+                }
+            } else {
+                FileIO::writeAll(digestFd, reinterpret_cast<const uint8_t*>(line.data()), line.size());
+            }
+            return 0;
+        }
+        
+        if (!inputPaths.empty() || !inputFds.empty()) {
+            // One process hashes every input; each line is printed as its input ends
+            MultiInputHasher inputs(algorithm, threads);
+            for (int fd : inputFds) {
+                inputs.addDescriptor(fd);
+            }
+            for (const auto& path : inputPaths) {
+                inputs.addPath(path);
+            }
+            bool failed = false;
+            inputs.run([&failed](const InputDigest& input) {
+                if (!input.error.empty()) {
+                    std::cerr << "Error: " << input.name << ": " << input.error << std::endl;
+                    failed = true;
+                    return;
+                }
+                std::cout << HashBase::toHex(input.digest.data(), input.digest.size()) << "  " << input.name
+                          << std::endl;
+            });
+            return failed ? 1 : 0;
+        }
+        
+        if (!dupesRoot.empty()) {
+            // One 'digest  path' line per file, a blank line between groups
+            DuplicateFinder finder(algorithm, threads);
+            const std::vector<DuplicateGroup> groups = finder.find(dupesRoot);
+            for (size_t g = 0; g < groups.size(); ++g) {
+                const std::string digest = HashBase::toHex(groups[g].digest.data(), groups[g].digest.size());
+                std::cout << (g > 0 ? "\n" : "");
+                for (const auto& path : groups[g].paths) {
+                    std::cout << digest << "  " << path << '\n';
+                }
+            }
+            std::cout.flush();
+            for (const auto& error : finder.getErrors()) {
+                std::cerr << "Error: " << error << '\n';
+            }
+            std::cerr << finder.getFilesScanned() << " files, " << groups.size() << " duplicate groups; read "
+                      << finder.getBytesRead() << " of " << finder.getBytesScanned() << " bytes\n";
+            return finder.getErrors().empty() ? 0 : 1;
+        }
+        
+        if (!treeCachePath.empty() && treeDigestRoot.empty()) {
+            throw std::invalid_argument("--tree-cache requires --tree-digest");
+        }
+        
+        if (!treeDigestRoot.empty()) {
+            DirectoryDigest tree(algorithm, threads, treeCachePath);
+            std::cout << tree.hashTree(treeDigestRoot) << "  " << treeDigestRoot << std::endl;
+            return 0;
+        }
+        
+        if (!buildIndexPath.empty()) {
+            const uint64_t count = DigestIndex::build(buildIndexPath, algorithm, std::cin, bloomBits);
+            std::cout << count << " digests indexed\n";
+            return 0;
+        }
+        
+        if (!matchPath.empty() && batchFormat.empty()) {
+            throw std::invalid_argument("--match requires --batch");
+        }
+        
+        if (!batchFormat.empty()) {
+            // Coprocess mode: answers go straight to the descriptor, bypassing std::cout
+            CoprocessHasher coprocess(algorithm, threads);
+            std::unique_ptr<DigestIndex> index;
+            std::atomic<uint64_t> hits(0);
+            if (!matchPath.empty()) {
+                // Probed in place through the mapping; the set never lands on the heap
+                index.reset(new DigestIndex(matchPath));
+                if (index->getAlgorithm() != HashFactory::createHash(algorithm)->getAlgorithmName()) {
+                    throw std::invalid_argument("Index " + matchPath + " holds " + index->getAlgorithm() +
+                                                " digests, not " + algorithm);
+                }
+                const DigestIndex* known = index.get();
+                coprocess.setFilter([known, &hits](const uint8_t* digest) {
+                    const bool hit = known->contains(digest);
+                    hits += hit ? 1 : 0;
+                    return hit;
+                });
+            }
+            coprocess.run(0, 1, CoprocessHasher::parseFormat(batchFormat));
+            return index && hits.load() == 0 ? 1 : 0;
+        }
+        
+        if (!recordFormat.empty()) {
+            // One digest line per record, in input order
+            StreamProcessor processor(HashFactory::createHash(algorithm));
+            processor.processRecords(std::cin, StreamProcessor::parseRecordFormat(recordFormat), std::cout);
+            std::cout.flush();
+            return 0;
+        }
+        
+        if (signatureMode) {
+            // Basis file signature for a later --delta run
+            BlockSignature signature(algorithm, blockSize);
+            signature.generate(std::cin);
+            signature.write(std::cout);
+            std::cout.flush();
+            return 0;
+        }
+        
+        if (treeMode) {
+            // Parallel Merkle tree over fixed-size leaves
+            TreeHasher tree(algorithm, leafSize, threads);
+            tree.processStream(std::cin);
+            std::cout << tree.getHash() << std::endl;
+            return 0;
+        }
+        
         // Create hash implementation
         auto hasher = HashFactory::createHash(algorithm);
         
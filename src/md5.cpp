@@ -1,7 +1,5 @@
 #include "md5.h"
 #include "hash_constants.h"
-#include <iomanip>
-#include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <limits>
@@ -33,6 +31,10 @@ void MD5::reset() {
 }
 
 void MD5::processBlock(const uint8_t* block) {
+    compress(state, block);
+}
+
+void MD5::compress(uint32_t chainingState[4], const uint8_t* block) {
     uint32_t w[16];
     
     // Convert block to 32-bit words (little-endian)
@@ -43,10 +45,10 @@ void MD5::processBlock(const uint8_t* block) {
                (static_cast<uint32_t>(block[i * 4 + 3]) << 24);
     }
     
-    uint32_t a = state[0];
-    uint32_t b = state[1];
-    uint32_t c = state[2];
-    uint32_t d = state[3];
+    uint32_t a = chainingState[0];
+    uint32_t b = chainingState[1];
+    uint32_t c = chainingState[2];
+    uint32_t d = chainingState[3];
     
     // MD5 rounds
     for (int i = 0; i < 64; ++i) {
@@ -84,10 +86,10 @@ void MD5::processBlock(const uint8_t* block) {
         a = temp;
     }
     
-    state[0] += a;
-    state[1] += b;
-    state[2] += c;
-    state[3] += d;
+    chainingState[0] += a;
+    chainingState[1] += b;
+    chainingState[2] += c;
+    chainingState[3] += d;
 }
 
 void MD5::addPadding() {
@@ -130,41 +132,48 @@ void MD5::addPadding() {
     processBlock(buffer);
 }
 
-std::string MD5::getHash() const {
+void MD5::getDigest(uint8_t* digest) const {
     if (!finalized) {
         throw std::runtime_error("Cannot get hash before finalization. Call finalize() first.");
     }
     
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
     // MD5 output is little-endian
     for (int i = 0; i < 4; ++i) {
         for (int j = 0; j < 4; ++j) {
-            ss << std::setw(2) << static_cast<unsigned int>((state[i] >> (j * 8)) & 0xff);
+            digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (j * 8));
         }
     }
-    
-    return ss.str();
 }
 
-uint32_t MD5::leftRotate(uint32_t value, unsigned int count) const {
+uint32_t MD5::leftRotate(uint32_t value, unsigned int count) {
     count &= 31; // Prevent undefined behavior
     return (value << count) | (value >> (32 - count));
 }
 
-uint32_t MD5::F(uint32_t x, uint32_t y, uint32_t z) const {
+uint32_t MD5::F(uint32_t x, uint32_t y, uint32_t z) {
     return (x & y) | (~x & z);
 }
 
-uint32_t MD5::G(uint32_t x, uint32_t y, uint32_t z) const {
+uint32_t MD5::G(uint32_t x, uint32_t y, uint32_t z) {
     return (x & z) | (y & ~z);
 }
 
-uint32_t MD5::H(uint32_t x, uint32_t y, uint32_t z) const {
+uint32_t MD5::H(uint32_t x, uint32_t y, uint32_t z) {
     return x ^ y ^ z;
 }
 
-uint32_t MD5::I(uint32_t x, uint32_t y, uint32_t z) const {
+uint32_t MD5::I(uint32_t x, uint32_t y, uint32_t z) {
     return y ^ (x | ~z);
 }
+
+std::unique_ptr<HashInterface> MD5::clone() const {
+    return std::unique_ptr<HashInterface>(new MD5(*this));
+}
+
+void MD5::saveState(HashState::Writer& writer) const {
+    writer.putWords(state, 4);
+}
+
+void MD5::loadState(HashState::Reader& reader) {
+    reader.getWords(state, 4);
+}
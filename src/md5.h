@@ -12,10 +12,18 @@ public:
     
     // HashBase implementation
     void reset() override;
-    std::string getHash() const override;
+    void getDigest(uint8_t* digest) const override;
     size_t getBlockSize() const override { return HASH_CONSTANTS::MD5_BLOCK_SIZE; }
     size_t getHashSize() const override { return HASH_CONSTANTS::MD5_HASH_SIZE; }
     std::string getAlgorithmName() const override { return "MD5"; }
+    std::unique_ptr<HashInterface> clone() const override;
+    
+    /**
+     * Compress one 64-byte block into a raw chaining state
+     * @param chainingState 4-word state, updated in place
+     * @param block Pointer to one block of input
+     */
+    static void compress(uint32_t chainingState[4], const uint8_t* block);
 
 private:
     // MD5 state
@@ -24,11 +32,13 @@ private:
     // Internal methods
     void processBlock(const uint8_t* block) override;
     void addPadding() override;
-    uint32_t leftRotate(uint32_t value, unsigned int count) const;
-    uint32_t F(uint32_t x, uint32_t y, uint32_t z) const;
-    uint32_t G(uint32_t x, uint32_t y, uint32_t z) const;
-    uint32_t H(uint32_t x, uint32_t y, uint32_t z) const;
-    uint32_t I(uint32_t x, uint32_t y, uint32_t z) const;
+    void saveState(HashState::Writer& writer) const override;
+    void loadState(HashState::Reader& reader) override;
+    static uint32_t leftRotate(uint32_t value, unsigned int count);
+    static uint32_t F(uint32_t x, uint32_t y, uint32_t z);
+    static uint32_t G(uint32_t x, uint32_t y, uint32_t z);
+    static uint32_t H(uint32_t x, uint32_t y, uint32_t z);
+    static uint32_t I(uint32_t x, uint32_t y, uint32_t z);
 };
 
 #endif // MD5_H
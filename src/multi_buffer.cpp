@@ -0,0 +1,182 @@
+#include "multi_buffer.h"
+#include "sha256.h"
+#include "sha512.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MULTI_BUFFER_VECTORIZED 1
+#else
+#define MULTI_BUFFER_VECTORIZED 0
+#endif
+
+namespace MultiBuffer {
+
+#if MULTI_BUFFER_VECTORIZED
+
+// One vector holds the same word of every lane
+typedef uint32_t Lanes32 __attribute__((vector_size(SHA256_LANES * sizeof(uint32_t))));
+typedef uint64_t Lanes64 __attribute__((vector_size(SHA512_LANES * sizeof(uint64_t))));
+
+// Macros rather than functions: passing vectors by value across calls changes the ABI
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static inline uint32_t loadBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) |
+           (static_cast<uint32_t>(p[3]));
+}
+
+static inline uint64_t loadBigEndian64(const uint8_t* p) {
+    return (static_cast<uint64_t>(loadBigEndian32(p)) << 32) | loadBigEndian32(p + 4);
+}
+
+void sha256Compress(uint32_t (*states)[8], const uint8_t* const* blocks, size_t lanes) {
+    if (lanes == 0 || lanes > SHA256_LANES) {
+        throw std::invalid_argument("Invalid SHA256 lane count");
+    }
+
+    // Message schedule, transposed so each vector holds one word of every lane
+    Lanes32 w[64];
+    for (int i = 0; i < 16; ++i) {
+        for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+            w[i][lane] = lane < lanes ? loadBigEndian32(blocks[lane] + i * 4) : 0;
+        }
+    }
+
+    for (int i = 16; i < 64; ++i) {
+        Lanes32 s0 = ROTR32(w[i - 15], 7) ^ ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        Lanes32 s1 = ROTR32(w[i - 2], 17) ^ ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    Lanes32 v[8];
+    for (int j = 0; j < 8; ++j) {
+        for (size_t lane = 0; lane < SHA256_LANES; ++lane) {
+            v[j][lane] = lane < lanes ? states[lane][j] : 0;
+        }
+    }
+
+    Lanes32 a = v[0], b = v[1], c = v[2], d = v[3];
+    Lanes32 e = v[4], f = v[5], g = v[6], h = v[7];
+
+    for (int i = 0; i < 64; ++i) {
+        Lanes32 S1 = ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25);
+        Lanes32 ch = (e & f) ^ (~e & g);
+        Lanes32 temp1 = h + S1 + ch + SHA256::K[i] + w[i];
+        Lanes32 S0 = ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22);
+        Lanes32 maj = (a & b) ^ (a & c) ^ (b & c);
+        Lanes32 temp2 = S0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    v[0] += a; v[1] += b; v[2] += c; v[3] += d;
+    v[4] += e; v[5] += f; v[6] += g; v[7] += h;
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        for (int j = 0; j < 8; ++j) {
+            states[lane][j] = v[j][lane];
+        }
+    }
+
+    // Clear sensitive data from stack
+    std::memset(w, 0, sizeof(w));
+}
+
+void sha512Compress(uint64_t (*states)[8], const uint8_t* const* blocks, size_t lanes) {
+    if (lanes == 0 || lanes > SHA512_LANES) {
+        throw std::invalid_argument("Invalid SHA512 lane count");
+    }
+
+    // Message schedule, transposed so each vector holds one word of every lane
+    Lanes64 w[80];
+    for (int i = 0; i < 16; ++i) {
+        for (size_t lane = 0; lane < SHA512_LANES; ++lane) {
+            w[i][lane] = lane < lanes ? loadBigEndian64(blocks[lane] + i * 8) : 0;
+        }
+    }
+
+    for (int i = 16; i < 80; ++i) {
+        Lanes64 s0 = ROTR64(w[i - 15], 1) ^ ROTR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        Lanes64 s1 = ROTR64(w[i - 2], 19) ^ ROTR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    Lanes64 v[8];
+    for (int j = 0; j < 8; ++j) {
+        for (size_t lane = 0; lane < SHA512_LANES; ++lane) {
+            v[j][lane] = lane < lanes ? states[lane][j] : 0;
+        }
+    }
+
+    Lanes64 a = v[0], b = v[1], c = v[2], d = v[3];
+    Lanes64 e = v[4], f = v[5], g = v[6], h = v[7];
+
+    for (int i = 0; i < 80; ++i) {
+        Lanes64 S1 = ROTR64(e, 14) ^ ROTR64(e, 18) ^ ROTR64(e, 41);
+        Lanes64 ch = (e & f) ^ (~e & g);
+        Lanes64 temp1 = h + S1 + ch + SHA512::K[i] + w[i];
+        Lanes64 S0 = ROTR64(a, 28) ^ ROTR64(a, 34) ^ ROTR64(a, 39);
+        Lanes64 maj = (a & b) ^ (a & c) ^ (b & c);
+        Lanes64 temp2 = S0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    v[0] += a; v[1] += b; v[2] += c; v[3] += d;
+    v[4] += e; v[5] += f; v[6] += g; v[7] += h;
+
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        for (int j = 0; j < 8; ++j) {
+            states[lane][j] = v[j][lane];
+        }
+    }
+
+    // Clear sensitive data from stack
+    std::memset(w, 0, sizeof(w));
+}
+
+#else // !MULTI_BUFFER_VECTORIZED
+
+void sha256Compress(uint32_t (*states)[8], const uint8_t* const* blocks, size_t lanes) {
+    if (lanes == 0 || lanes > SHA256_LANES) {
+        throw std::invalid_argument("Invalid SHA256 lane count");
+    }
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        SHA256::compress(states[lane], blocks[lane]);
+    }
+}
+
+void sha512Compress(uint64_t (*states)[8], const uint8_t* const* blocks, size_t lanes) {
+    if (lanes == 0 || lanes > SHA512_LANES) {
+        throw std::invalid_argument("Invalid SHA512 lane count");
+    }
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        SHA512::compress(states[lane], blocks[lane]);
+    }
+}
+
+#endif // MULTI_BUFFER_VECTORIZED
+
+bool isVectorized() {
+    return MULTI_BUFFER_VECTORIZED != 0;
+}
+
+}
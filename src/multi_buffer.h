@@ -0,0 +1,181 @@
+#ifndef MULTI_BUFFER_H
+#define MULTI_BUFFER_H
+
+#include "sha256.h"
+#include "sha512.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Multi-buffer compression kernels
+ *
+ * Each call compresses one block into each of several independent chaining
+ * states at once. The lanes are laid out so that every round operates on a
+ * whole SIMD register of states; on compilers without vector extensions the
+ * kernels fall back to one scalar compression per lane.
+ */
+namespace MultiBuffer {
+
+    // Lanes per kernel call (256-bit vectors)
+    static constexpr size_t SHA256_LANES = 8;
+    static constexpr size_t SHA512_LANES = 4;
+
+    /**
+     * Compress one 64-byte block into each SHA256-family state
+     * @param states Array of lanes chaining states, updated in place
+     * @param blocks Array of lanes block pointers
+     * @param lanes Number of active lanes (1..SHA256_LANES)
+     */
+    void sha256Compress(uint32_t (*states)[8], const uint8_t* const* blocks, size_t lanes);
+
+    /**
+     * Compress one 128-byte block into each SHA512-family state
+     * @param states Array of lanes chaining states, updated in place
+     * @param blocks Array of lanes block pointers
+     * @param lanes Number of active lanes (1..SHA512_LANES)
+     */
+    void sha512Compress(uint64_t (*states)[8], const uint8_t* const* blocks, size_t lanes);
+
+    /**
+     * Check whether the vectorized kernels were compiled in
+     * @return True if lanes are processed in SIMD registers
+     */
+    bool isVectorized();
+
+    /**
+     * Kernel adapters binding a SHA-2 compression function to its lane kernel
+     * Used by templates that run the same loop over either word size
+     */
+    struct SHA256Kernel {
+        typedef uint32_t Word;
+        static constexpr size_t LANES = SHA256_LANES;
+        static constexpr size_t BLOCK_SIZE = HASH_CONSTANTS::SHA256_BLOCK_SIZE;
+        static constexpr size_t LENGTH_FIELD_SIZE = 8;
+        static void compress(Word* state, const uint8_t* block) { SHA256::compress(state, block); }
+        static void compressLanes(Word (*states)[8], const uint8_t* const* blocks, size_t lanes) {
+            sha256Compress(states, blocks, lanes);
+        }
+    };
+
+    struct SHA512Kernel {
+        typedef uint64_t Word;
+        static constexpr size_t LANES = SHA512_LANES;
+        static constexpr size_t BLOCK_SIZE = HASH_CONSTANTS::SHA512_BLOCK_SIZE;
+        static constexpr size_t LENGTH_FIELD_SIZE = 16;
+        static void compress(Word* state, const uint8_t* block) { SHA512::compress(state, block); }
+        static void compressLanes(Word (*states)[8], const uint8_t* const* blocks, size_t lanes) {
+            sha512Compress(states, blocks, lanes);
+        }
+    };
+
+    /**
+     * Select the lane kernel for a hash class; void when none is available
+     */
+    template <typename H, typename Enable = void>
+    struct KernelFor {
+        typedef void type;
+    };
+
+    template <typename H>
+    struct KernelFor<H, typename std::enable_if<std::is_base_of<SHA256, H>::value>::type> {
+        typedef SHA256Kernel type;
+    };
+
+    template <typename H>
+    struct KernelFor<H, typename std::enable_if<std::is_base_of<SHA512, H>::value>::type> {
+        typedef SHA512Kernel type;
+    };
+
+    /**
+     * Apply Merkle-Damgard padding to the unprocessed tail of a message
+     * @param tail Buffer of 2 * BLOCK_SIZE bytes whose first tailLength bytes hold the tail
+     * @param tailLength Tail bytes (less than one block)
+     * @param messageLength Total message length in bytes
+     * @return Number of final blocks to compress (1 or 2)
+     */
+    template <typename Kernel>
+    size_t padFinalBlocks(uint8_t* tail, size_t tailLength, uint64_t messageLength) {
+        const size_t blocks = (tailLength + 1 + Kernel::LENGTH_FIELD_SIZE <= Kernel::BLOCK_SIZE) ? 1 : 2;
+        const size_t end = blocks * Kernel::BLOCK_SIZE;
+        std::memset(tail + tailLength, 0, end - tailLength);
+        tail[tailLength] = 0x80;
+        const uint64_t bitLength = messageLength * 8;
+        for (size_t i = 0; i < 8; ++i) {
+            tail[end - 1 - i] = static_cast<uint8_t>(bitLength >> (8 * i));
+        }
+        return blocks;
+    }
+
+    /**
+     * Serialize a chaining state big-endian, truncated to length bytes
+     */
+    template <typename Word>
+    void storeBigEndian(const Word* state, uint8_t* out, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            out[i] = static_cast<uint8_t>(state[i / sizeof(Word)] >> (8 * (sizeof(Word) - 1 - i % sizeof(Word))));
+        }
+    }
+
+    /**
+     * Hash up to LANES whole messages side by side, one block per lane per
+     * kernel call. Full blocks are read in place; only the padded tail (one
+     * or two blocks) is copied.
+     * @param initialState Chaining state every lane starts from (an IV, or a midstate)
+     * @param prefixLength Bytes already absorbed into initialState, counted in the padding
+     * @param messages Array of lanes message pointers
+     * @param lengths Array of lanes message lengths
+     * @param lanes Number of active lanes (1..Kernel::LANES)
+     * @param finalStates Chaining state of each lane after its padding
+     */
+    template <typename Kernel>
+    void hashLanes(const typename Kernel::Word* initialState, uint64_t prefixLength,
+                   const uint8_t* const* messages, const size_t* lengths, size_t lanes,
+                   typename Kernel::Word (*finalStates)[8]) {
+        typedef typename Kernel::Word Word;
+        constexpr size_t BLOCK = Kernel::BLOCK_SIZE;
+
+        Word states[Kernel::LANES][8];
+        uint8_t tails[Kernel::LANES][2 * BLOCK];
+        size_t fullBlocks[Kernel::LANES];
+        size_t totalBlocks[Kernel::LANES];
+        const uint8_t* pointers[Kernel::LANES];
+        size_t maxBlocks = 0;
+
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            const size_t remainder = lengths[lane] % BLOCK;
+            fullBlocks[lane] = lengths[lane] / BLOCK;
+            if (remainder > 0) {
+                std::memcpy(tails[lane], messages[lane] + fullBlocks[lane] * BLOCK, remainder);
+            }
+            totalBlocks[lane] = fullBlocks[lane] +
+                padFinalBlocks<Kernel>(tails[lane], remainder, prefixLength + lengths[lane]);
+            if (totalBlocks[lane] > maxBlocks) {
+                maxBlocks = totalBlocks[lane];
+            }
+            std::memcpy(states[lane], initialState, sizeof(states[lane]));
+        }
+
+        for (size_t block = 0; block < maxBlocks; ++block) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                if (block < fullBlocks[lane]) {
+                    pointers[lane] = messages[lane] + block * BLOCK;
+                } else if (block < totalBlocks[lane]) {
+                    pointers[lane] = tails[lane] + (block - fullBlocks[lane]) * BLOCK;
+                } else {
+                    // Finished lane: compress a dummy block, the result is discarded
+                    pointers[lane] = tails[lane];
+                }
+            }
+            Kernel::compressLanes(states, pointers, lanes);
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                if (block + 1 == totalBlocks[lane]) {
+                    std::memcpy(finalStates[lane], states[lane], sizeof(states[lane]));
+                }
+            }
+        }
+    }
+}
+
+#endif // MULTI_BUFFER_H
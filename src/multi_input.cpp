@@ -0,0 +1,242 @@
+#include "multi_input.h"
+#include "file_io.h"
+#include "hash_factory.h"
+#include "stream_multiplexer.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+constexpr size_t MultiInputHasher::READ_SIZE;
+constexpr size_t MultiInputHasher::READ_QUOTA;
+
+MultiInputHasher::MultiInputHasher(const std::string& algorithm, size_t threads)
+    : algorithm_(algorithm), threads_(threads) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+}
+
+MultiInputHasher::~MultiInputHasher() {
+    for (const auto& input : inputs_) {
+        if (input.fd >= 0) {
+            ::close(input.fd);
+        }
+    }
+}
+
+void MultiInputHasher::addDescriptor(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        throw std::runtime_error("Invalid input descriptor " + std::to_string(fd) + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    const bool regular = ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    inputs_.push_back(Input{fd, "fd:" + std::to_string(fd), !regular});
+}
+
+void MultiInputHasher::addPath(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    struct stat info;
+    const bool regular = ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    inputs_.push_back(Input{fd, path, !regular});
+}
+
+#ifdef __linux__
+
+// State of one run(); the pool is joined first so no worker outlives the rest
+class MultiInputHasher::Loop {
+public:
+    Loop(const std::string& algorithm, size_t threads, std::vector<Input>& inputs)
+        : inputs_(inputs), mux_(algorithm), states_(inputs.size()), results_(inputs.size()),
+          epoll_(::epoll_create1(EPOLL_CLOEXEC)) {
+        int wakePipe[2];
+        if (epoll_.get() < 0 || ::pipe2(wakePipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+            throw std::runtime_error(std::string("Cannot set up epoll: ") + std::strerror(errno));
+        }
+        wakeRead_ = FileIO::Descriptor(wakePipe[0]);
+        wakeWrite_ = FileIO::Descriptor(wakePipe[1]);
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u64 = inputs.size();
+        if (::epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, wakeRead_.get(), &event) != 0) {
+            throw std::runtime_error(std::string("Cannot set up epoll: ") + std::strerror(errno));
+        }
+        pool_.reset(new ThreadPool(threads));
+    }
+
+    ~Loop() {
+        pool_.reset();
+    }
+
+    void run(const std::function<void(const InputDigest&)>& emit) {
+        const size_t count = inputs_.size();
+        for (size_t i = 0; i < count; ++i) {
+            states_[i].id = mux_.open();
+            states_[i].buffer.resize(READ_SIZE);
+            results_[i].name = inputs_[i].name;
+            results_[i].bytes = 0;
+            // epoll refuses descriptors that are always ready (EPERM)
+            if (inputs_[i].pollable && !arm(i, EPOLL_CTL_ADD)) {
+                if (errno != EPERM) {
+                    throw std::runtime_error("Cannot watch " + inputs_[i].name + ": " + std::strerror(errno));
+                }
+                inputs_[i].pollable = false;
+            }
+            if (!inputs_[i].pollable) {
+                schedule(i);
+            }
+        }
+
+        size_t remaining = count;
+        epoll_event events[64];
+        std::vector<size_t> completed;
+        while (remaining > 0) {
+            const int ready = ::epoll_wait(epoll_.get(), events, 64, -1);
+            if (ready < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+            }
+            for (int i = 0; i < ready; ++i) {
+                const size_t index = static_cast<size_t>(events[i].data.u64);
+                if (index != count) {
+                    schedule(index);
+                    continue;
+                }
+                uint8_t bytes[256];
+                while (::read(wakeRead_.get(), bytes, sizeof(bytes)) > 0) {
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    completed.swap(finished_);
+                }
+                for (size_t done : completed) {
+                    emit(results_[done]);
+                    --remaining;
+                }
+                completed.clear();
+            }
+        }
+    }
+
+private:
+    struct State {
+        StreamMultiplexer::StreamId id;
+        std::vector<uint8_t> buffer;
+    };
+
+    void schedule(size_t index) {
+        pool_->submit([this, index]() { drain(index); });
+    }
+
+    bool arm(size_t index, int operation) {
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.u64 = index;
+        return ::epoll_ctl(epoll_.get(), operation, inputs_[index].fd, &event) == 0;
+    }
+
+    // Give the input another turn: re-arm it, or requeue it if it is always ready
+    void requeue(size_t index) {
+        if (!inputs_[index].pollable) {
+            schedule(index);
+        } else if (!arm(index, EPOLL_CTL_MOD)) {
+            throw std::runtime_error(std::string("epoll_ctl failed: ") + std::strerror(errno));
+        }
+    }
+
+    // Runs on a worker; the one-shot registration guarantees no other worker has this input
+    void drain(size_t index) {
+        State& state = states_[index];
+        size_t quota = READ_QUOTA;
+        try {
+            for (;;) {
+                const ssize_t n = ::read(inputs_[index].fd, state.buffer.data(), state.buffer.size());
+                if (n > 0) {
+                    mux_.update(state.id, state.buffer.data(), static_cast<size_t>(n));
+                    results_[index].bytes += static_cast<uint64_t>(n);
+                    if (static_cast<size_t>(n) >= quota) {
+                        requeue(index);
+                        return;
+                    }
+                    quota -= static_cast<size_t>(n);
+                } else if (n == 0) {
+                    finish(index, std::string());
+                    return;
+                } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    requeue(index);
+                    return;
+                } else if (errno != EINTR) {
+                    throw std::runtime_error(std::string("Read failed: ") + std::strerror(errno));
+                }
+            }
+        } catch (const std::exception& e) {
+            finish(index, e.what());
+        }
+    }
+
+    // Never throws: run() counts on every input being posted exactly once
+    void finish(size_t index, const std::string& error) {
+        InputDigest& result = results_[index];
+        result.error = error;
+        try {
+            result.digest.resize(mux_.getHashSize());
+            mux_.finalize(states_[index].id, result.digest.data());
+        } catch (const std::exception& e) {
+            if (result.error.empty()) {
+                result.error = e.what();
+            }
+        }
+        if (!result.error.empty()) {
+            result.digest.clear();
+        }
+        ::close(inputs_[index].fd);     // Also removes it from the epoll set
+        inputs_[index].fd = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_.push_back(index);
+        }
+        const uint8_t byte = 1;
+        while (::write(wakeWrite_.get(), &byte, 1) < 0 && errno == EINTR) {
+        }
+    }
+
+    std::vector<Input>& inputs_;
+    StreamMultiplexer mux_;
+    std::vector<State> states_;
+    std::vector<InputDigest> results_;
+    FileIO::Descriptor epoll_;
+    FileIO::Descriptor wakeRead_;
+    FileIO::Descriptor wakeWrite_;
+    std::mutex mutex_;
+    std::vector<size_t> finished_;      // Inputs done but not yet reported
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+void MultiInputHasher::run(const std::function<void(const InputDigest&)>& emit) {
+    Loop loop(algorithm_, threads_, inputs_);
+    loop.run(emit);
+}
+
+#else
+
+void MultiInputHasher::run(const std::function<void(const InputDigest&)>&) {
+    throw std::runtime_error("Multi-input hashing requires epoll (Linux)");
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef MULTI_INPUT_H
+#define MULTI_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * Digest of one input, reported when it reaches end of file
+ */
+struct InputDigest {
+    std::string name;               // Path, or "fd:N" for an inherited descriptor
+    uint64_t bytes;
+    std::vector<uint8_t> digest;    // Empty if the input failed
+    std::string error;
+};
+
+/**
+ * Concurrent hashing of many pipes, FIFOs and files in one process
+ *
+ * Every input is made non-blocking and registered with epoll (one-shot), so
+ * only descriptors with data waiting cost anything. A ready input is drained
+ * by a worker until it would block or has used its READ_QUOTA, then re-armed;
+ * the one-shot registration keeps each stream on at most one worker at a
+ * time, so its bytes stay in order. Contexts live in a StreamMultiplexer,
+ * which hashes SHA-2 blocks from different streams together in multi-buffer
+ * lanes. Regular files, which epoll cannot watch, are always ready and are
+ * simply requeued after each quota.
+ *
+ * Each input's digest is reported from the calling thread as soon as that
+ * input reaches end of file, so results arrive in completion order.
+ */
+class MultiInputHasher {
+public:
+    static constexpr size_t READ_SIZE = 64 * 1024;
+    static constexpr size_t READ_QUOTA = 1024 * 1024;   // Per turn, so one busy input cannot starve the rest
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    MultiInputHasher(const std::string& algorithm, size_t threads = 0);
+    ~MultiInputHasher();
+
+    MultiInputHasher(const MultiInputHasher&) = delete;
+    MultiInputHasher& operator=(const MultiInputHasher&) = delete;
+
+    /**
+     * Add an inherited descriptor; it is switched to non-blocking mode and
+     * closed once it reaches end of file
+     */
+    void addDescriptor(int fd);
+
+    /**
+     * Add a path (FIFO or file), opened non-blocking so a FIFO without a
+     * writer yet does not stall the others
+     * @throws std::runtime_error if the path cannot be opened
+     */
+    void addPath(const std::string& path);
+
+    /**
+     * Hash every input until each reaches end of file
+     * @param emit Called on this thread once per input, in completion order
+     * @throws std::runtime_error if epoll is unavailable
+     */
+    void run(const std::function<void(const InputDigest&)>& emit);
+
+    /**
+     * Get the number of inputs added
+     */
+    size_t getInputCount() const { return inputs_.size(); }
+
+private:
+    class Loop;
+
+    struct Input {
+        int fd;
+        std::string name;
+        bool pollable;
+    };
+
+    std::string algorithm_;
+    size_t threads_;
+    std::vector<Input> inputs_;
+};
+
+#endif // MULTI_INPUT_H
@@ -0,0 +1,49 @@
+#include "prefix_cache.h"
+#include "hash_factory.h"
+#include <stdexcept>
+
+PrefixStateCache::PrefixStateCache(size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Prefix cache capacity must be greater than zero");
+    }
+}
+
+std::unique_ptr<HashInterface> PrefixStateCache::fork(const std::string& algorithm,
+                                                      const uint8_t* prefix, size_t length) {
+    if (prefix == nullptr && length > 0) {
+        throw std::invalid_argument("Prefix data cannot be null");
+    }
+
+    std::string key = algorithm;
+    key.push_back('\0');
+    key.append(reinterpret_cast<const char*>(prefix), length);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        return found->second->second->clone();
+    }
+
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(prefix, length);
+
+    if (entries_.size() == capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.emplace_front(key, hasher->clone());
+    index_[key] = entries_.begin();
+    return hasher;
+}
+
+size_t PrefixStateCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void PrefixStateCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef PREFIX_CACHE_H
+#define PREFIX_CACHE_H
+
+#include "hash_interface.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Cache of hasher states that have already absorbed a shared prefix
+ *
+ * The first request for an (algorithm, prefix) pair hashes the prefix once;
+ * every request returns an independent clone positioned just after the
+ * prefix, ready for the message-specific suffix. The least recently used
+ * entry is evicted once the capacity is reached. Thread-safe.
+ */
+class PrefixStateCache {
+public:
+    /**
+     * Constructor
+     * @param capacity Maximum number of cached prefixes
+     * @throws std::invalid_argument if capacity is zero
+     */
+    explicit PrefixStateCache(size_t capacity = 64);
+
+    /**
+     * Get a hasher that has absorbed the prefix
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param prefix Prefix bytes
+     * @param length Prefix length in bytes
+     * @return Independent hasher; updating it never affects the cache
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    std::unique_ptr<HashInterface> fork(const std::string& algorithm, const uint8_t* prefix, size_t length);
+
+    /**
+     * Get the number of cached prefixes
+     */
+    size_t size() const;
+
+    /**
+     * Drop every cached prefix
+     */
+    void clear();
+
+private:
+    typedef std::list<std::pair<std::string, std::unique_ptr<HashInterface>>> EntryList;
+
+    size_t capacity_;
+    mutable std::mutex mutex_;
+    EntryList entries_;                                            // Most recently used first
+    std::unordered_map<std::string, EntryList::iterator> index_;   // Key: algorithm, NUL, prefix bytes
+};
+
+#endif // PREFIX_CACHE_H
@@ -0,0 +1,302 @@
+#include "rsync_delta.h"
+#include "hash_base.h"
+#include "hash_factory.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+constexpr size_t BlockSignature::DEFAULT_BLOCK_SIZE;
+constexpr uint32_t DeltaMatcher::EMPTY_SLOT;
+
+namespace {
+
+const char* const SIGNATURE_MAGIC = "hashgen-signature";
+const int SIGNATURE_VERSION = 1;
+
+std::vector<uint8_t> parseHex(const std::string& hex) {
+    if (hex.size() % 2 != 0) {
+        throw std::invalid_argument("Malformed signature: odd-length hex digest");
+    }
+    std::vector<uint8_t> bytes(hex.size() / 2);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<uint8_t>(std::stoul(hex.substr(i * 2, 2), nullptr, 16));
+    }
+    return bytes;
+}
+
+size_t slotOf(uint32_t weak, size_t mask) {
+    // Both checksum halves feed the slot index
+    uint32_t x = weak ^ (weak >> 16);
+    x *= 0x45d9f3b;
+    x ^= x >> 16;
+    return x & mask;
+}
+
+std::vector<uint8_t> strongDigest(HashInterface& hasher, const uint8_t* data, size_t length) {
+    hasher.reset();
+    hasher.update(data, length);
+    hasher.finalize();
+    std::vector<uint8_t> digest(hasher.getHashSize());
+    hasher.getDigest(digest.data());
+    return digest;
+}
+
+} // namespace
+
+void RollingChecksum::init(const uint8_t* data, size_t length) {
+    uint32_t a = 0;
+    uint32_t b = 0;
+    size_t i = 0;
+
+    // Four independent byte sums per step, folded into b with their weights
+    for (; i + 4 <= length; i += 4) {
+        const uint32_t weight = static_cast<uint32_t>(length - i);
+        b += weight * data[i] + (weight - 1) * data[i + 1] + (weight - 2) * data[i + 2] +
+             (weight - 3) * data[i + 3];
+        a += static_cast<uint32_t>(data[i]) + data[i + 1] + data[i + 2] + data[i + 3];
+    }
+    for (; i < length; ++i) {
+        a += data[i];
+        b += static_cast<uint32_t>(length - i) * data[i];
+    }
+
+    a_ = a;
+    b_ = b;
+    length_ = length;
+}
+
+BlockSignature::BlockSignature(const std::string& algorithm, size_t blockSize)
+    : algorithm_(algorithm), blockSize_(blockSize), fileLength_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be greater than zero");
+    }
+}
+
+void BlockSignature::generate(std::istream& input) {
+    auto hasher = HashFactory::createHash(algorithm_);
+    std::vector<uint8_t> block(blockSize_);
+    RollingChecksum checksum;
+
+    blocks_.clear();
+    fileLength_ = 0;
+    while (input.good()) {
+        input.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(blockSize_));
+        const size_t length = static_cast<size_t>(input.gcount());
+        if (length == 0) {
+            break;
+        }
+        checksum.init(block.data(), length);
+        blocks_.push_back(Block{checksum.value(), strongDigest(*hasher, block.data(), length)});
+        fileLength_ += length;
+    }
+}
+
+void BlockSignature::write(std::ostream& output) const {
+    output << SIGNATURE_MAGIC << ' ' << SIGNATURE_VERSION << ' ' << algorithm_ << ' '
+           << blockSize_ << ' ' << fileLength_ << '\n';
+    char weak[9];
+    for (const auto& block : blocks_) {
+        std::snprintf(weak, sizeof(weak), "%08x", block.weak);
+        output << weak << ' ' << HashBase::toHex(block.strong.data(), block.strong.size()) << '\n';
+    }
+}
+
+BlockSignature BlockSignature::read(std::istream& input) {
+    std::string magic;
+    int version = 0;
+    std::string algorithm;
+    size_t blockSize = 0;
+    uint64_t fileLength = 0;
+    if (!(input >> magic >> version >> algorithm >> blockSize >> fileLength) ||
+        magic != SIGNATURE_MAGIC || version != SIGNATURE_VERSION) {
+        throw std::invalid_argument("Malformed signature header");
+    }
+
+    BlockSignature signature(algorithm, blockSize);
+    signature.fileLength_ = fileLength;
+    const size_t hashSize = HashFactory::createHash(algorithm)->getHashSize();
+    const uint64_t blockCount = (fileLength + blockSize - 1) / blockSize;
+
+    std::string weak;
+    std::string strong;
+    for (uint64_t i = 0; i < blockCount; ++i) {
+        if (!(input >> weak >> strong) || weak.size() != 8 || strong.size() != hashSize * 2) {
+            throw std::invalid_argument("Malformed signature block " + std::to_string(i));
+        }
+        try {
+            signature.blocks_.push_back(Block{static_cast<uint32_t>(std::stoul(weak, nullptr, 16)),
+                                              parseHex(strong)});
+        } catch (const std::logic_error&) {
+            throw std::invalid_argument("Malformed signature block " + std::to_string(i));
+        }
+    }
+    return signature;
+}
+
+size_t BlockSignature::blockLength(size_t index) const {
+    const uint64_t start = static_cast<uint64_t>(index) * blockSize_;
+    return static_cast<size_t>(std::min<uint64_t>(blockSize_, fileLength_ - start));
+}
+
+DeltaMatcher::DeltaMatcher(const BlockSignature& signature)
+    : signature_(signature), strong_(HashFactory::createHash(signature.getAlgorithm())), slotMask_(0), matchedBytes_(0), literalBytes_(0), falseMatches_(0) {
+    const auto& blocks = signature.getBlocks();
+
+    // Keep the table at most half full so probe runs stay short
+    size_t capacity = 16;
+    while (capacity < blocks.size() * 2) {
+        capacity <<= 1;
+    }
+    slots_.assign(capacity, EMPTY_SLOT);
+    slotMask_ = capacity - 1;
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        size_t slot = slotOf(blocks[i].weak, slotMask_);
+        while (slots_[slot] != EMPTY_SLOT) {
+            slot = (slot + 1) & slotMask_;
+        }
+        slots_[slot] = static_cast<uint32_t>(i);
+    }
+}
+
+DeltaMatcher::~DeltaMatcher() = default;
+
+uint32_t DeltaMatcher::findBlock(uint32_t weak, const uint8_t* data, size_t length, size_t preferred) {
+    const auto& blocks = signature_.getBlocks();
+    std::vector<uint8_t> strong;
+
+    auto confirm = [&](size_t index) {
+        if (blocks[index].weak != weak || signature_.blockLength(index) != length) {
+            return false;
+        }
+        // Strong digest of the window is computed at most once per lookup
+        if (strong.empty()) {
+            strong = strongDigest(*strong_, data, length);
+        }
+        if (strong == blocks[index].strong) {
+            return true;
+        }
+        ++falseMatches_;
+        return false;
+    };
+
+    // The block after the previous match is the likeliest candidate
+    if (preferred < blocks.size() && confirm(preferred)) {
+        return static_cast<uint32_t>(preferred);
+    }
+    for (size_t slot = slotOf(weak, slotMask_); slots_[slot] != EMPTY_SLOT; slot = (slot + 1) & slotMask_) {
+        const size_t index = slots_[slot];
+        if (index != preferred && confirm(index)) {
+            return static_cast<uint32_t>(index);
+        }
+    }
+    return EMPTY_SLOT;
+}
+
+void DeltaMatcher::process(std::istream& input, const std::function<void(const DeltaOp&)>& emit) {
+    const size_t blockSize = signature_.getBlockSize();
+    std::vector<uint8_t> window(std::max<size_t>(blockSize * 4, 65536));
+    size_t pos = 0;
+    size_t end = 0;
+    uint64_t base = 0;              // File offset of window[0]
+    bool eof = false;
+
+    RollingChecksum checksum;
+    bool haveChecksum = false;
+
+    bool inLiteral = false;
+    uint64_t literalStart = 0;
+    DeltaOp copy = {DeltaOp::COPY, 0, 0, 0};
+    bool haveCopy = false;
+    size_t nextBlock = 0;
+
+    matchedBytes_ = 0;
+    literalBytes_ = 0;
+    falseMatches_ = 0;
+
+    auto flushLiteral = [&](uint64_t upTo) {
+        if (inLiteral && upTo > literalStart) {
+            emit(DeltaOp{DeltaOp::LITERAL, literalStart, upTo - literalStart, 0});
+            literalBytes_ += upTo - literalStart;
+        }
+        inLiteral = false;
+    };
+    auto flushCopy = [&]() {
+        if (haveCopy) {
+            emit(copy);
+            matchedBytes_ += copy.length;
+            haveCopy = false;
+        }
+    };
+    auto addCopy = [&](uint64_t offset, size_t block, size_t length) {
+        if (haveCopy && copy.offset + copy.length == offset &&
+            copy.block + copy.length / blockSize == block && copy.length % blockSize == 0) {
+            copy.length += length;
+        } else {
+            flushCopy();
+            copy = DeltaOp{DeltaOp::COPY, offset, length, block};
+            haveCopy = true;
+        }
+        nextBlock = block + 1;
+    };
+    auto startLiteral = [&](uint64_t offset) {
+        if (!inLiteral) {
+            flushCopy();
+            inLiteral = true;
+            literalStart = offset;
+        }
+    };
+
+    for (;;) {
+        // Keep one block plus the next byte buffered so the window can roll
+        if (!eof && end - pos <= blockSize) {
+            std::memmove(window.data(), window.data() + pos, end - pos);
+            base += pos;
+            end -= pos;
+            pos = 0;
+            while (!eof && end < window.size()) {
+                input.read(reinterpret_cast<char*>(window.data() + end),
+                           static_cast<std::streamsize>(window.size() - end));
+                end += static_cast<size_t>(input.gcount());
+                eof = !input.good();
+            }
+        }
+
+        const size_t available = end - pos;
+        if (available == 0) {
+            break;
+        }
+        const size_t length = std::min(available, blockSize);
+        if (!haveChecksum) {
+            checksum.init(window.data() + pos, length);
+            haveChecksum = true;
+        }
+
+        // Short windows only occur at the end and can only match a short final block
+        uint32_t block = findBlock(checksum.value(), window.data() + pos, length, nextBlock);
+        if (block != EMPTY_SLOT) {
+            flushLiteral(base + pos);
+            addCopy(base + pos, block, length);
+            pos += length;
+            haveChecksum = false;
+            continue;
+        }
+
+        startLiteral(base + pos);
+        if (available > blockSize) {
+            checksum.roll(window[pos], window[pos + blockSize]);
+            ++pos;
+        } else {
+            // End of input with no match: the rest is literal
+            pos = end;
+        }
+    }
+
+    flushLiteral(base + pos);
+    flushCopy();
+}
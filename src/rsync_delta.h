@@ -0,0 +1,153 @@
+#ifndef RSYNC_DELTA_H
+#define RSYNC_DELTA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+class HashInterface;
+
+/**
+ * rsync-style weak rolling checksum (Adler-32 variant, both halves mod 2^16)
+ *
+ *   a = sum of bytes, b = sum of (length - i) * byte[i]
+ *   value = a | b << 16
+ *
+ * Sliding the window by one byte is O(1) via roll().
+ */
+class RollingChecksum {
+public:
+    RollingChecksum() : a_(0), b_(0), length_(0) {}
+
+    /**
+     * Start a new window over data
+     */
+    void init(const uint8_t* data, size_t length);
+
+    /**
+     * Slide the window one byte: drop out, append in
+     */
+    void roll(uint8_t out, uint8_t in) {
+        a_ = a_ - out + in;
+        b_ = b_ - static_cast<uint32_t>(length_) * out + a_;
+    }
+
+    uint32_t value() const { return (a_ & 0xffff) | (b_ << 16); }
+
+private:
+    uint32_t a_;
+    uint32_t b_;
+    size_t length_;
+};
+
+/**
+ * Per-block weak and strong signatures of a basis file
+ *
+ * Text form:
+ *   hashgen-signature 1 <algorithm> <block size> <file length>
+ *   <weak checksum, 8 hex digits> <strong digest hex>     (one line per block)
+ */
+class BlockSignature {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 2048;
+
+    struct Block {
+        uint32_t weak;
+        std::vector<uint8_t> strong;
+    };
+
+    /**
+     * Constructor
+     * @param algorithm Strong hash algorithm (any HashFactory name)
+     * @param blockSize Block size in bytes
+     * @throws std::invalid_argument on unsupported algorithm or zero block size
+     */
+    BlockSignature(const std::string& algorithm, size_t blockSize);
+
+    /**
+     * Compute signatures for every block of a stream (the last block may be short)
+     */
+    void generate(std::istream& input);
+
+    void write(std::ostream& output) const;
+
+    /**
+     * Parse the text form
+     * @throws std::invalid_argument if the signature is malformed
+     */
+    static BlockSignature read(std::istream& input);
+
+    const std::string& getAlgorithm() const { return algorithm_; }
+    size_t getBlockSize() const { return blockSize_; }
+    uint64_t getFileLength() const { return fileLength_; }
+    const std::vector<Block>& getBlocks() const { return blocks_; }
+
+    /**
+     * Length of block index (only the last block can be short)
+     */
+    size_t blockLength(size_t index) const;
+
+private:
+    std::string algorithm_;
+    size_t blockSize_;
+    uint64_t fileLength_;
+    std::vector<Block> blocks_;
+};
+
+/**
+ * One instruction to rebuild the new file from the basis file
+ */
+struct DeltaOp {
+    enum Type { COPY, LITERAL };
+    Type type;
+    uint64_t offset;       // Position in the new file
+    uint64_t length;
+    size_t block;          // COPY: first basis block of the run
+};
+
+/**
+ * Rolls the weak checksum byte by byte over a new file, looks candidates up
+ * in an open-addressing table of basis block checksums and confirms them with
+ * the strong digest. Consecutive matching blocks are merged into one COPY;
+ * unmatched bytes are merged into LITERAL ranges.
+ */
+class DeltaMatcher {
+public:
+    explicit DeltaMatcher(const BlockSignature& signature);
+    ~DeltaMatcher();
+
+    /**
+     * Match a stream against the signature
+     * @param input New file contents
+     * @param emit Called once per operation, in file order
+     */
+    void process(std::istream& input, const std::function<void(const DeltaOp&)>& emit);
+
+    uint64_t getMatchedBytes() const { return matchedBytes_; }
+    uint64_t getLiteralBytes() const { return literalBytes_; }
+
+    /**
+     * Number of weak hits rejected by the strong digest in the last run
+     */
+    uint64_t getFalseMatches() const { return falseMatches_; }
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = 0xffffffff;
+
+    // Index of a basis block whose data matches, or EMPTY_SLOT
+    uint32_t findBlock(uint32_t weak, const uint8_t* data, size_t length, size_t preferred);
+
+    const BlockSignature& signature_;
+    std::unique_ptr<HashInterface> strong_;
+    std::vector<uint32_t> slots_;      // Block indices, linear probing on the weak checksum
+    size_t slotMask_;
+    uint64_t matchedBytes_;
+    uint64_t literalBytes_;
+    uint64_t falseMatches_;
+};
+
+#endif // RSYNC_DELTA_H
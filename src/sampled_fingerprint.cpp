@@ -0,0 +1,253 @@
+#include "sampled_fingerprint.h"
+#include "file_io.h"
+#include "hash_base.h"
+#include "hash_factory.h"
+#include "hash_state.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <future>
+#include <set>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+constexpr size_t SampledFingerprint::DEFAULT_SAMPLE_SIZE;
+constexpr size_t SampledFingerprint::DEFAULT_SAMPLE_COUNT;
+constexpr size_t SampledFingerprint::MAX_READ_SIZE;
+
+namespace {
+
+// SplitMix64: small, fast and identical on every platform
+class ChunkRandom {
+public:
+    explicit ChunkRandom(uint64_t seed) : state_(seed) {
+    }
+
+    // Uniform enough in [0, bound) for bounds far below 2^64
+    uint64_t below(uint64_t bound) {
+        state_ += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = state_;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return (z ^ (z >> 31)) % bound;
+    }
+
+private:
+    uint64_t state_;
+};
+
+struct Geometry {
+    uint64_t size;
+    uint64_t minimumIo;
+    uint64_t optimalIo;     // 0 if unknown
+};
+
+Geometry geometryOf(int fd) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        throw std::runtime_error("Cannot stat sampled input");
+    }
+    Geometry geometry;
+    geometry.minimumIo = info.st_blksize > 0 ? static_cast<uint64_t>(info.st_blksize) : 1;
+    geometry.optimalIo = 0;
+    if (S_ISREG(info.st_mode)) {
+        geometry.size = static_cast<uint64_t>(info.st_size);
+        return geometry;
+    }
+    if (!S_ISBLK(info.st_mode)) {
+        throw std::runtime_error("Sampled mode requires a regular file or block device");
+    }
+#ifdef __linux__
+    uint64_t bytes = 0;
+    unsigned int minimum = 0;
+    unsigned int optimal = 0;
+    if (::ioctl(fd, BLKGETSIZE64, &bytes) != 0) {
+        throw std::runtime_error("Cannot get block device size");
+    }
+    geometry.size = bytes;
+    if (::ioctl(fd, BLKIOMIN, &minimum) == 0 && minimum > 0) {
+        geometry.minimumIo = std::max<uint64_t>(geometry.minimumIo, minimum);
+    }
+    if (::ioctl(fd, BLKIOOPT, &optimal) == 0) {
+        geometry.optimalIo = optimal;
+    }
+#else
+    const off_t end = ::lseek(fd, 0, SEEK_END);
+    if (end < 0) {
+        throw std::runtime_error("Cannot get block device size");
+    }
+    geometry.size = static_cast<uint64_t>(end);
+#endif
+    return geometry;
+}
+
+uint64_t roundUp(uint64_t value, uint64_t unit) {
+    return (value + unit - 1) / unit * unit;
+}
+
+// A sampled byte range of the input
+struct Sample {
+    uint64_t offset;
+    uint64_t length;
+};
+
+// One positioned read covering the samples [first, last)
+struct ChunkRead {
+    uint64_t offset;
+    uint64_t end;
+    size_t first;
+    size_t last;
+};
+
+} // namespace
+
+SampledFingerprint::SampledFingerprint(const std::string& algorithm, size_t sampleSize, size_t sampleCount,
+                                       uint64_t seed, size_t threads)
+    : algorithm_(algorithm), sampleSize_(sampleSize), sampleCount_(sampleCount), seed_(seed), threads_(threads),
+      fileSize_(0), chunkSize_(0), chunkCount_(0), chunksRead_(0), bytesRead_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    if (sampleSize == 0) {
+        throw std::invalid_argument("Sample size must be greater than zero");
+    }
+    if (sampleCount < 2) {
+        throw std::invalid_argument("Sample count must be at least 2 (head and tail)");
+    }
+}
+
+std::vector<uint64_t> SampledFingerprint::selectChunks(uint64_t chunkCount, size_t sampleCount, uint64_t seed) {
+    std::vector<uint64_t> chunks;
+    if (chunkCount <= sampleCount) {
+        for (uint64_t chunk = 0; chunk < chunkCount; ++chunk) {
+            chunks.push_back(chunk);
+        }
+        return chunks;
+    }
+
+    // Floyd's algorithm: k distinct picks from the interior [1, chunkCount - 1) in k draws
+    const uint64_t interior = chunkCount - 2;
+    const uint64_t picks = sampleCount - 2;
+    ChunkRandom random(seed);
+    std::set<uint64_t> chosen;
+    for (uint64_t j = interior - picks; j < interior; ++j) {
+        const uint64_t t = random.below(j + 1);
+        chosen.insert(chosen.count(t) ? j : t);
+    }
+    chunks.push_back(0);
+    for (uint64_t pick : chosen) {
+        chunks.push_back(pick + 1);
+    }
+    chunks.push_back(chunkCount - 1);
+    return chunks;
+}
+
+void SampledFingerprint::processFile(int fd) {
+    processFile(fd, 0);
+}
+
+void SampledFingerprint::processFile(int fd, size_t ioSize) {
+    const Geometry geometry = geometryOf(fd);
+    fileSize_ = geometry.size;
+    chunkSize_ = sampleSize_;
+    chunkCount_ = (fileSize_ + chunkSize_ - 1) / chunkSize_;
+
+    // Whole I/O units (whole stripes once a chunk spans one) per read
+    uint64_t unit = ioSize > 0 ? ioSize : geometry.minimumIo;
+    if (ioSize == 0 && geometry.optimalIo > 0 && chunkSize_ >= geometry.optimalIo) {
+        unit = roundUp(geometry.optimalIo, unit);
+    }
+    const uint64_t maxRead = std::max<uint64_t>(roundUp(MAX_READ_SIZE, unit), unit);
+    chunksRead_ = 0;
+    bytesRead_ = 0;
+#ifdef POSIX_FADV_RANDOM
+    // Read-ahead would pull in bytes the sample never uses
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+
+    // The last chunk can be a single byte: sample the final chunkSize_ bytes instead
+    const std::vector<uint64_t> chunks = selectChunks(chunkCount_, sampleCount_, seed_);
+    std::vector<Sample> samples;
+    for (uint64_t chunk : chunks) {
+        const uint64_t offset = chunk + 1 < chunkCount_ ? chunk * chunkSize_ : fileSize_ - std::min(chunkSize_, fileSize_);
+        samples.push_back(Sample{offset, std::min(chunkSize_, fileSize_ - offset)});
+    }
+    const size_t hashSize = HashFactory::createHash(algorithm_)->getHashSize();
+    std::vector<uint8_t> digests(samples.size() * hashSize);
+
+    // Align each sample's read to the unit and merge reads whose units touch or overlap
+    std::vector<ChunkRead> reads;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const uint64_t start = samples[i].offset / unit * unit;
+        const uint64_t end = std::min(roundUp(samples[i].offset + samples[i].length, unit), fileSize_);
+        if (!reads.empty() && start <= reads.back().end && end - reads.back().offset <= maxRead) {
+            reads.back().end = std::max(reads.back().end, end);
+            reads.back().last = i + 1;
+        } else {
+            reads.push_back(ChunkRead{start, end, i, i + 1});
+        }
+    }
+
+    // One ascending run of reads per worker
+    ThreadPool pool(threads_);
+    const size_t runs = std::max<size_t>(1, std::min(reads.size(), pool.getThreadCount()));
+    std::vector<std::future<uint64_t>> tasks;
+    for (size_t run = 0; run < runs; ++run) {
+        const size_t first = reads.size() * run / runs;
+        const size_t last = reads.size() * (run + 1) / runs;
+        tasks.push_back(pool.submit([this, fd, &samples, &reads, &digests, hashSize, first, last]() {
+            auto hasher = HashFactory::createHash(algorithm_);
+            std::vector<uint8_t> buffer;
+            uint64_t bytes = 0;
+            for (size_t r = first; r < last; ++r) {
+                const ChunkRead& read = reads[r];
+                const size_t length = static_cast<size_t>(read.end - read.offset);
+                buffer.resize(std::max(buffer.size(), length));
+                if (FileIO::readAt(fd, buffer.data(), length, static_cast<off_t>(read.offset)) != length) {
+                    throw std::runtime_error("Input shrank while sampling");
+                }
+                bytes += length;
+                for (size_t i = read.first; i < read.last; ++i) {
+                    hasher->reset();
+                    hasher->update(buffer.data() + (samples[i].offset - read.offset),
+                                   static_cast<size_t>(samples[i].length));
+                    hasher->finalize();
+                    hasher->getDigest(digests.data() + i * hashSize);
+                }
+            }
+            return bytes;
+        }));
+    }
+    for (auto& task : tasks) {
+        bytesRead_ += task.get();
+    }
+    chunksRead_ = samples.size();
+
+    std::vector<uint8_t> summary;
+    HashState::appendU64(summary, fileSize_);
+    HashState::appendU64(summary, chunkSize_);
+    HashState::appendU64(summary, seed_);
+    HashState::appendU64(summary, samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        HashState::appendU64(summary, samples[i].offset);
+        HashState::appendU64(summary, samples[i].length);
+        summary.insert(summary.end(), digests.begin() + i * hashSize, digests.begin() + (i + 1) * hashSize);
+    }
+    auto hasher = HashFactory::createHash(algorithm_);
+    hasher->update(summary.data(), summary.size());
+    hasher->finalize();
+    fingerprint_.resize(hashSize);
+    hasher->getDigest(fingerprint_.data());
+}
+
+std::string SampledFingerprint::getHash() const {
+    if (fingerprint_.empty()) {
+        throw std::runtime_error("No file has been sampled");
+    }
+    return HashBase::toHex(fingerprint_.data(), fingerprint_.size());
+}
@@ -0,0 +1,112 @@
+#ifndef SAMPLED_FINGERPRINT_H
+#define SAMPLED_FINGERPRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Sampled fingerprint of a large file or block device, for cheap change
+ * triage before a full verify
+ *
+ * The input is divided into chunks and a seed-determined subset of them is
+ * read: always the first, plus distinct pseudo-random others up to the
+ * sample count. The last chunk is replaced by the tail, the final
+ * min(sample size, input size) bytes, so the end of the input is always
+ * covered in full however short the last chunk is. Each sample is read
+ * with a positioned read and hashed in parallel. The fingerprint is the
+ * hash of (integers big-endian):
+ *
+ *   u64     input size
+ *   u64     chunk size
+ *   u64     seed
+ *   u64     number of samples
+ *   ...     per sample, ascending: u64 offset, u64 length, sample digest
+ *
+ * It is NOT a content digest. Equal fingerprints only mean that the size
+ * and the sampled bytes match; a change outside the sample goes unseen.
+ * Any difference, however, proves the input changed.
+ *
+ * Chunks depend only on the sample size, so a copy on other storage gives
+ * the same fingerprint. The device's I/O geometry only shapes the reads:
+ * each one is widened to whole minimum I/O units (st_blksize, or BLKIOMIN
+ * for a block device), or to whole stripes (BLKIOOPT) once a chunk spans
+ * one, and chunks whose units touch are read together, up to MAX_READ_SIZE.
+ * Each worker reads an ascending run, and kernel read-ahead is turned off
+ * for the sampled reads.
+ */
+class SampledFingerprint {
+public:
+    static constexpr size_t DEFAULT_SAMPLE_SIZE = 64 * 1024;
+    static constexpr size_t DEFAULT_SAMPLE_COUNT = 1024;
+
+    // Largest read made by merging neighbouring chunks
+    static constexpr size_t MAX_READ_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param sampleSize Chunk size in bytes
+     * @param sampleCount Chunks to read, head and tail included (at least 2)
+     * @param seed Selects the chunks; equal seeds pick equal chunks for equal sizes
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm, zero sample size or a count below 2
+     */
+    SampledFingerprint(const std::string& algorithm, size_t sampleSize = DEFAULT_SAMPLE_SIZE,
+                       size_t sampleCount = DEFAULT_SAMPLE_COUNT, uint64_t seed = 0, size_t threads = 0);
+
+    /**
+     * Sample a regular file or block device
+     * @param fd Open, readable file descriptor
+     * @throws std::runtime_error if fd is neither, or on I/O errors
+     */
+    void processFile(int fd);
+
+    /**
+     * Sample with an explicit read granularity instead of the device's
+     * @param ioSize Alignment and unit of every read in bytes (0 asks the device)
+     */
+    void processFile(int fd, size_t ioSize);
+
+    /**
+     * Get the fingerprint as a hex string
+     * @throws std::runtime_error if no file has been processed
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the input size, the chunk size and the number of chunks in the input
+     */
+    uint64_t getFileSize() const { return fileSize_; }
+    uint64_t getChunkSize() const { return chunkSize_; }
+    uint64_t getChunkCount() const { return chunkCount_; }
+
+    /**
+     * Get the samples hashed and the bytes read (alignment included) by the last run
+     */
+    uint64_t getChunksRead() const { return chunksRead_; }
+    uint64_t getBytesRead() const { return bytesRead_; }
+
+    /**
+     * Pick the chunks to sample, in ascending order
+     * @return Every chunk if chunkCount <= sampleCount, otherwise chunk 0,
+     *         chunk chunkCount - 1 and sampleCount - 2 distinct chunks between
+     */
+    static std::vector<uint64_t> selectChunks(uint64_t chunkCount, size_t sampleCount, uint64_t seed);
+
+private:
+    std::string algorithm_;
+    size_t sampleSize_;
+    size_t sampleCount_;
+    uint64_t seed_;
+    size_t threads_;
+    uint64_t fileSize_;
+    uint64_t chunkSize_;
+    uint64_t chunkCount_;
+    uint64_t chunksRead_;
+    uint64_t bytesRead_;
+    std::vector<uint8_t> fingerprint_;
+};
+
+#endif // SAMPLED_FINGERPRINT_H
@@ -1,7 +1,5 @@
 #include "sha1.h"
 #include "hash_constants.h"
-#include <iomanip>
-#include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <limits>
@@ -22,6 +20,10 @@ void SHA1::reset() {
 }
 
 void SHA1::processBlock(const uint8_t* block) {
+    compress(state, block);
+}
+
+void SHA1::compress(uint32_t chainingState[5], const uint8_t* block) {
     uint32_t w[80];
     
     // Initialize first 16 words from the block (big-endian)
@@ -37,11 +39,11 @@ void SHA1::processBlock(const uint8_t* block) {
         w[i] = leftRotate(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
     }
     
-    uint32_t a = state[0];
-    uint32_t b = state[1];
-    uint32_t c = state[2];
-    uint32_t d = state[3];
-    uint32_t e = state[4];
+    uint32_t a = chainingState[0];
+    uint32_t b = chainingState[1];
+    uint32_t c = chainingState[2];
+    uint32_t d = chainingState[3];
+    uint32_t e = chainingState[4];
     
     // Main loop
     for (int i = 0; i < 80; ++i) {
@@ -69,11 +71,11 @@ void SHA1::processBlock(const uint8_t* block) {
         a = temp;
     }
     
-    state[0] += a;
-    state[1] += b;
-    state[2] += c;
-    state[3] += d;
-    state[4] += e;
+    chainingState[0] += a;
+    chainingState[1] += b;
+    chainingState[2] += c;
+    chainingState[3] += d;
+    chainingState[4] += e;
 }
 
 void SHA1::addPadding() {
@@ -116,22 +118,32 @@ void SHA1::addPadding() {
     processBlock(buffer);
 }
 
-std::string SHA1::getHash() const {
+void SHA1::getDigest(uint8_t* digest) const {
     if (!finalized) {
         throw std::runtime_error("Cannot get hash before finalization. Call finalize() first.");
     }
     
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
+    // SHA1 output is big-endian
     for (int i = 0; i < 5; ++i) {
-        ss << std::setw(8) << state[i];
+        for (int j = 0; j < 4; ++j) {
+            digest[i * 4 + j] = static_cast<uint8_t>(state[i] >> (24 - j * 8));
+        }
     }
-    
-    return ss.str();
 }
 
-uint32_t SHA1::leftRotate(uint32_t value, unsigned int count) const {
+uint32_t SHA1::leftRotate(uint32_t value, unsigned int count) {
     count &= 31; // Prevent undefined behavior
     return (value << count) | (value >> (32 - count));
 }
+
+std::unique_ptr<HashInterface> SHA1::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA1(*this));
+}
+
+void SHA1::saveState(HashState::Writer& writer) const {
+    writer.putWords(state, 5);
+}
+
+void SHA1::loadState(HashState::Reader& reader) {
+    reader.getWords(state, 5);
+}
@@ -12,10 +12,18 @@ public:
     
     // HashBase implementation
     void reset() override;
-    std::string getHash() const override;
+    void getDigest(uint8_t* digest) const override;
     size_t getBlockSize() const override { return HASH_CONSTANTS::SHA1_BLOCK_SIZE; }
     size_t getHashSize() const override { return HASH_CONSTANTS::SHA1_HASH_SIZE; }
     std::string getAlgorithmName() const override { return "SHA1"; }
+    std::unique_ptr<HashInterface> clone() const override;
+    
+    /**
+     * Compress one 64-byte block into a raw chaining state
+     * @param chainingState 5-word state, updated in place
+     * @param block Pointer to one block of input
+     */
+    static void compress(uint32_t chainingState[5], const uint8_t* block);
 
 private:
     // SHA1 state
@@ -24,7 +32,9 @@ private:
     // Internal methods
     void processBlock(const uint8_t* block) override;
     void addPadding() override;
-    uint32_t leftRotate(uint32_t value, unsigned int count) const;
+    void saveState(HashState::Writer& writer) const override;
+    void loadState(HashState::Reader& reader) override;
+    static uint32_t leftRotate(uint32_t value, unsigned int count);
 };
 
 #endif // SHA1_H
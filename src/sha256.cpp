@@ -1,13 +1,11 @@
 #include "sha256.h"
 #include "hash_constants.h"
-#include <iomanip>
-#include <sstream>
 #include <cstring>
 #include <stdexcept>
 #include <limits>
 
-// SHA256 constants moved to hash_constants.h, using local copy for performance
-const uint32_t K[64] = {
+// SHA256 round constants (first 32 bits of the fractional parts of the cube roots of the first 64 primes)
+const uint32_t SHA256::K[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
     0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
     0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
@@ -18,25 +16,38 @@ const uint32_t K[64] = {
     0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
-SHA256::SHA256() : HashBase(HASH_CONSTANTS::SHA256_BLOCK_SIZE) {
+// Initial hash values (FIPS 180-4, sections 5.3.3 and 5.3.2)
+static const uint32_t SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t SHA224_IV[8] = {
+    0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
+    0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4
+};
+
+SHA256::SHA256() : SHA256(SHA256_IV, HASH_CONSTANTS::SHA256_HASH_SIZE, "SHA256") {
+}
+
+SHA256::SHA256(const uint32_t* iv, size_t hash_size, const char* name)
+    : HashBase(HASH_CONSTANTS::SHA256_BLOCK_SIZE),
+      initialState(iv), digestSize(hash_size), algorithmName(name) {
     reset();
 }
 
 void SHA256::reset() {
     resetBase(); // Reset base class state
     
-    // Initialize SHA256-specific state values (FIPS 180-4)
-    state[0] = 0x6a09e667;
-    state[1] = 0xbb67ae85;
-    state[2] = 0x3c6ef372;
-    state[3] = 0xa54ff53a;
-    state[4] = 0x510e527f;
-    state[5] = 0x9b05688c;
-    state[6] = 0x1f83d9ab;
-    state[7] = 0x5be0cd19;
+    // Initialize variant-specific state values (FIPS 180-4)
+    std::memcpy(state, initialState, sizeof(state));
 }
 
 void SHA256::processBlock(const uint8_t* block) {
+    compress(state, block);
+}
+
+void SHA256::compress(uint32_t chainingState[8], const uint8_t* block) {
     uint32_t w[64];
     
     // Initialize first 16 words from the block
@@ -55,14 +66,14 @@ void SHA256::processBlock(const uint8_t* block) {
     }
     
     // Initialize working variables
-    uint32_t a = state[0];
-    uint32_t b = state[1];
-    uint32_t c = state[2];
-    uint32_t d = state[3];
-    uint32_t e = state[4];
-    uint32_t f = state[5];
-    uint32_t g = state[6];
-    uint32_t h = state[7];
+    uint32_t a = chainingState[0];
+    uint32_t b = chainingState[1];
+    uint32_t c = chainingState[2];
+    uint32_t d = chainingState[3];
+    uint32_t e = chainingState[4];
+    uint32_t f = chainingState[5];
+    uint32_t g = chainingState[6];
+    uint32_t h = chainingState[7];
     
     // Main loop
     for (int i = 0; i < 64; ++i) {
@@ -84,14 +95,14 @@ void SHA256::processBlock(const uint8_t* block) {
     }
     
     // Add the compressed chunk to the current hash value
-    state[0] += a;
-    state[1] += b;
-    state[2] += c;
-    state[3] += d;
-    state[4] += e;
-    state[5] += f;
-    state[6] += g;
-    state[7] += h;
+    chainingState[0] += a;
+    chainingState[1] += b;
+    chainingState[2] += c;
+    chainingState[3] += d;
+    chainingState[4] += e;
+    chainingState[5] += f;
+    chainingState[6] += g;
+    chainingState[7] += h;
     
     // Clear sensitive data from stack
     std::memset(w, 0, sizeof(w));
@@ -140,47 +151,62 @@ void SHA256::addPadding() {
     processBlock(buffer);
 }
 
-std::string SHA256::getHash() const {
+void SHA256::getDigest(uint8_t* digest) const {
     if (!finalized) {
         throw std::runtime_error("Cannot get hash before finalization. Call processStream() first.");
     }
     
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
-    for (int i = 0; i < 8; ++i) {
-        ss << std::setw(8) << state[i];
+    // Big-endian output, truncated to the variant's digest size
+    for (size_t i = 0; i < digestSize; ++i) {
+        digest[i] = static_cast<uint8_t>(state[i / 4] >> (24 - 8 * (i % 4)));
     }
-    
-    return ss.str();
 }
 
-uint32_t SHA256::rightRotate(uint32_t value, unsigned int count) const {
+uint32_t SHA256::rightRotate(uint32_t value, unsigned int count) {
     // Ensure count is within valid range to prevent undefined behavior
     count &= 31; // Equivalent to count % 32, but faster
     return (value >> count) | (value << (32 - count));
 }
 
-uint32_t SHA256::choose(uint32_t x, uint32_t y, uint32_t z) const {
+uint32_t SHA256::choose(uint32_t x, uint32_t y, uint32_t z) {
     return (x & y) ^ (~x & z);
 }
 
-uint32_t SHA256::majority(uint32_t x, uint32_t y, uint32_t z) const {
+uint32_t SHA256::majority(uint32_t x, uint32_t y, uint32_t z) {
     return (x & y) ^ (x & z) ^ (y & z);
 }
 
-uint32_t SHA256::sigma0(uint32_t x) const {
+uint32_t SHA256::sigma0(uint32_t x) {
     return rightRotate(x, 7) ^ rightRotate(x, 18) ^ (x >> 3);
 }
 
-uint32_t SHA256::sigma1(uint32_t x) const {
+uint32_t SHA256::sigma1(uint32_t x) {
     return rightRotate(x, 17) ^ rightRotate(x, 19) ^ (x >> 10);
 }
 
-uint32_t SHA256::bigSigma0(uint32_t x) const {
+uint32_t SHA256::bigSigma0(uint32_t x) {
     return rightRotate(x, 2) ^ rightRotate(x, 13) ^ rightRotate(x, 22);
 }
 
-uint32_t SHA256::bigSigma1(uint32_t x) const {
+uint32_t SHA256::bigSigma1(uint32_t x) {
     return rightRotate(x, 6) ^ rightRotate(x, 11) ^ rightRotate(x, 25);
 }
+
+SHA224::SHA224() : SHA256(SHA224_IV, HASH_CONSTANTS::SHA224_HASH_SIZE, "SHA224") {
+}
+
+std::unique_ptr<HashInterface> SHA256::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA256(*this));
+}
+
+void SHA256::saveState(HashState::Writer& writer) const {
+    writer.putWords(state, 8);
+}
+
+void SHA256::loadState(HashState::Reader& reader) {
+    reader.getWords(state, 8);
+}
+
+std::unique_ptr<HashInterface> SHA224::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA224(*this));
+}
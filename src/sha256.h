@@ -12,25 +12,75 @@ public:
     
     // HashBase implementation
     void reset() override;
-    std::string getHash() const override;
+    void getDigest(uint8_t* digest) const override;
     size_t getBlockSize() const override { return HASH_CONSTANTS::SHA256_BLOCK_SIZE; }
-    size_t getHashSize() const override { return HASH_CONSTANTS::SHA256_HASH_SIZE; }
-    std::string getAlgorithmName() const override { return "SHA256"; }
+    size_t getHashSize() const override { return digestSize; }
+    std::string getAlgorithmName() const override { return algorithmName; }
+    std::unique_ptr<HashInterface> clone() const override;
+    
+    /**
+     * Compress one 64-byte block into a raw chaining state
+     * Exposed for callers that manage midstates directly (e.g. PBKDF2, multi-buffer kernels)
+     * @param chainingState 8-word state, updated in place
+     * @param block Pointer to one block of input
+     */
+    static void compress(uint32_t chainingState[8], const uint8_t* block);
+    
+    /**
+     * Get the initial chaining value of this variant
+     * @return Pointer to 8 IV words
+     */
+    const uint32_t* getInitialState() const { return initialState; }
+    
+    /**
+     * Get the current chaining value, covering the whole blocks absorbed so far
+     * Used to start multi-buffer lanes from a midstate (e.g. HMAC key blocks)
+     * @return Pointer to 8 state words
+     */
+    const uint32_t* getChainingState() const { return state; }
+    
+    // Round constants (FIPS 180-4)
+    static const uint32_t K[64];
+
+protected:
+    /**
+     * Constructor for truncated variants sharing the SHA256 compression function
+     * @param iv Initial hash value (8 words)
+     * @param hash_size Output size in bytes (truncated from the 32-byte state)
+     * @param name Algorithm name reported by getAlgorithmName()
+     */
+    SHA256(const uint32_t* iv, size_t hash_size, const char* name);
 
 private:
     // Internal state
     uint32_t state[8];
     
+    // Variant parameters
+    const uint32_t* initialState;
+    size_t digestSize;
+    const char* algorithmName;
+    
     // Internal methods
     void processBlock(const uint8_t* block) override;
     void addPadding() override;
-    uint32_t rightRotate(uint32_t value, unsigned int count) const;
-    uint32_t choose(uint32_t x, uint32_t y, uint32_t z) const;
-    uint32_t majority(uint32_t x, uint32_t y, uint32_t z) const;
-    uint32_t sigma0(uint32_t x) const;
-    uint32_t sigma1(uint32_t x) const;
-    uint32_t bigSigma0(uint32_t x) const;
-    uint32_t bigSigma1(uint32_t x) const;
+    void saveState(HashState::Writer& writer) const override;
+    void loadState(HashState::Reader& reader) override;
+    static uint32_t rightRotate(uint32_t value, unsigned int count);
+    static uint32_t choose(uint32_t x, uint32_t y, uint32_t z);
+    static uint32_t majority(uint32_t x, uint32_t y, uint32_t z);
+    static uint32_t sigma0(uint32_t x);
+    static uint32_t sigma1(uint32_t x);
+    static uint32_t bigSigma0(uint32_t x);
+    static uint32_t bigSigma1(uint32_t x);
+};
+
+/**
+ * SHA-224 (FIPS 180-4): SHA256 compression with a distinct IV, truncated to 224 bits
+ */
+class SHA224 : public SHA256 {
+public:
+    SHA224();
+    std::unique_ptr<HashInterface> clone() const override;
 };
 
 #endif // SHA256_H
@@ -1,11 +1,9 @@
 #include "sha512.h"
 #include "hash_constants.h"
-#include <iomanip>
-#include <sstream>
 #include <cstring>
 
 // SHA512 constants (first 64 bits of the fractional parts of the cube roots of the first 80 primes)
-const uint64_t K[80] = {
+const uint64_t SHA512::K[80] = {
     0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
     0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
     0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
@@ -28,25 +26,48 @@ const uint64_t K[80] = {
     0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
 };
 
-SHA512::SHA512() : HashBase(HASH_CONSTANTS::SHA512_BLOCK_SIZE) {
+// Initial hash values (FIPS 180-4, sections 5.3.4 - 5.3.6)
+static const uint64_t SHA512_IV[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint64_t SHA384_IV[8] = {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+
+static const uint64_t SHA512_224_IV[8] = {
+    0x8c3d37c819544da2ULL, 0x73e1996689dcd4d6ULL, 0x1dfab7ae32ff9c82ULL, 0x679dd514582f9fcfULL,
+    0x0f6d2b697bd44da8ULL, 0x77e36f7304c48942ULL, 0x3f9d85a86a1d36c8ULL, 0x1112e6ad91d692a1ULL
+};
+
+static const uint64_t SHA512_256_IV[8] = {
+    0x22312194fc2bf72cULL, 0x9f555fa3c84c64c2ULL, 0x2393b86b6f53b151ULL, 0x963877195940eabdULL,
+    0x96283ee2a88effe3ULL, 0xbe5e1e2553863992ULL, 0x2b0199fc2c85b8aaULL, 0x0eb72ddc81c52ca2ULL
+};
+
+SHA512::SHA512() : SHA512(SHA512_IV, HASH_CONSTANTS::SHA512_HASH_SIZE, "SHA512") {
+}
+
+SHA512::SHA512(const uint64_t* iv, size_t hash_size, const char* name)
+    : HashBase(HASH_CONSTANTS::SHA512_BLOCK_SIZE),
+      initialState(iv), digestSize(hash_size), algorithmName(name) {
     reset();
 }
 
 void SHA512::reset() {
     resetBase(); // Reset base class state
     
-    // Initialize SHA512-specific state values (FIPS 180-4)
-    state[0] = 0x6a09e667f3bcc908ULL;
-    state[1] = 0xbb67ae8584caa73bULL;
-    state[2] = 0x3c6ef372fe94f82bULL;
-    state[3] = 0xa54ff53a5f1d36f1ULL;
-    state[4] = 0x510e527fade682d1ULL;
-    state[5] = 0x9b05688c2b3e6c1fULL;
-    state[6] = 0x1f83d9abfb41bd6bULL;
-    state[7] = 0x5be0cd19137e2179ULL;
+    // Initialize variant-specific state values (FIPS 180-4)
+    std::memcpy(state, initialState, sizeof(state));
 }
 
 void SHA512::processBlock(const uint8_t* block) {
+    compress(state, block);
+}
+
+void SHA512::compress(uint64_t chainingState[8], const uint8_t* block) {
     uint64_t w[80];
     
     // Initialize first 16 words from the block (big-endian)
@@ -69,14 +90,14 @@ void SHA512::processBlock(const uint8_t* block) {
     }
     
     // Initialize working variables
-    uint64_t a = state[0];
-    uint64_t b = state[1];
-    uint64_t c = state[2];
-    uint64_t d = state[3];
-    uint64_t e = state[4];
-    uint64_t f = state[5];
-    uint64_t g = state[6];
-    uint64_t h = state[7];
+    uint64_t a = chainingState[0];
+    uint64_t b = chainingState[1];
+    uint64_t c = chainingState[2];
+    uint64_t d = chainingState[3];
+    uint64_t e = chainingState[4];
+    uint64_t f = chainingState[5];
+    uint64_t g = chainingState[6];
+    uint64_t h = chainingState[7];
     
     // Main loop
     for (int i = 0; i < 80; ++i) {
@@ -98,14 +119,14 @@ void SHA512::processBlock(const uint8_t* block) {
     }
     
     // Add the compressed chunk to the current hash value
-    state[0] += a;
-    state[1] += b;
-    state[2] += c;
-    state[3] += d;
-    state[4] += e;
-    state[5] += f;
-    state[6] += g;
-    state[7] += h;
+    chainingState[0] += a;
+    chainingState[1] += b;
+    chainingState[2] += c;
+    chainingState[3] += d;
+    chainingState[4] += e;
+    chainingState[5] += f;
+    chainingState[6] += g;
+    chainingState[7] += h;
     
     // Clear sensitive data from stack
     std::memset(w, 0, sizeof(w));
@@ -163,47 +184,76 @@ void SHA512::addPadding() {
     processBlock(buffer);
 }
 
-std::string SHA512::getHash() const {
+void SHA512::getDigest(uint8_t* digest) const {
     if (!finalized) {
         throw std::runtime_error("Cannot get hash before finalization. Call processStream() first.");
     }
     
-    std::stringstream ss;
-    ss << std::hex << std::setfill('0');
-    
-    for (int i = 0; i < 8; ++i) {
-        ss << std::setw(16) << state[i];
+    // Big-endian output, truncated to the variant's digest size
+    for (size_t i = 0; i < digestSize; ++i) {
+        digest[i] = static_cast<uint8_t>(state[i / 8] >> (56 - 8 * (i % 8)));
     }
-    
-    return ss.str();
 }
 
-uint64_t SHA512::rightRotate(uint64_t value, unsigned int count) const {
+uint64_t SHA512::rightRotate(uint64_t value, unsigned int count) {
     // Ensure count is within valid range to prevent undefined behavior
     count &= 63; // Equivalent to count % 64, but faster
     return (value >> count) | (value << (64 - count));
 }
 
-uint64_t SHA512::choose(uint64_t x, uint64_t y, uint64_t z) const {
+uint64_t SHA512::choose(uint64_t x, uint64_t y, uint64_t z) {
     return (x & y) ^ (~x & z);
 }
 
-uint64_t SHA512::majority(uint64_t x, uint64_t y, uint64_t z) const {
+uint64_t SHA512::majority(uint64_t x, uint64_t y, uint64_t z) {
     return (x & y) ^ (x & z) ^ (y & z);
 }
 
-uint64_t SHA512::sigma0(uint64_t x) const {
+uint64_t SHA512::sigma0(uint64_t x) {
     return rightRotate(x, 1) ^ rightRotate(x, 8) ^ (x >> 7);
 }
 
-uint64_t SHA512::sigma1(uint64_t x) const {
+uint64_t SHA512::sigma1(uint64_t x) {
     return rightRotate(x, 19) ^ rightRotate(x, 61) ^ (x >> 6);
 }
 
-uint64_t SHA512::bigSigma0(uint64_t x) const {
+uint64_t SHA512::bigSigma0(uint64_t x) {
     return rightRotate(x, 28) ^ rightRotate(x, 34) ^ rightRotate(x, 39);
 }
 
-uint64_t SHA512::bigSigma1(uint64_t x) const {
+uint64_t SHA512::bigSigma1(uint64_t x) {
     return rightRotate(x, 14) ^ rightRotate(x, 18) ^ rightRotate(x, 41);
 }
+
+SHA384::SHA384() : SHA512(SHA384_IV, HASH_CONSTANTS::SHA384_HASH_SIZE, "SHA384") {
+}
+
+SHA512_224::SHA512_224() : SHA512(SHA512_224_IV, HASH_CONSTANTS::SHA512_224_HASH_SIZE, "SHA512/224") {
+}
+
+SHA512_256::SHA512_256() : SHA512(SHA512_256_IV, HASH_CONSTANTS::SHA512_256_HASH_SIZE, "SHA512/256") {
+}
+
+std::unique_ptr<HashInterface> SHA512::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA512(*this));
+}
+
+void SHA512::saveState(HashState::Writer& writer) const {
+    writer.putWords(state, 8);
+}
+
+void SHA512::loadState(HashState::Reader& reader) {
+    reader.getWords(state, 8);
+}
+
+std::unique_ptr<HashInterface> SHA384::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA384(*this));
+}
+
+std::unique_ptr<HashInterface> SHA512_224::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA512_224(*this));
+}
+
+std::unique_ptr<HashInterface> SHA512_256::clone() const {
+    return std::unique_ptr<HashInterface>(new SHA512_256(*this));
+}
@@ -12,25 +12,94 @@ public:
     
     // HashBase implementation
     void reset() override;
-    std::string getHash() const override;
+    void getDigest(uint8_t* digest) const override;
     size_t getBlockSize() const override { return HASH_CONSTANTS::SHA512_BLOCK_SIZE; }
-    size_t getHashSize() const override { return HASH_CONSTANTS::SHA512_HASH_SIZE; }
-    std::string getAlgorithmName() const override { return "SHA512"; }
+    size_t getHashSize() const override { return digestSize; }
+    std::string getAlgorithmName() const override { return algorithmName; }
+    std::unique_ptr<HashInterface> clone() const override;
+    
+    /**
+     * Compress one 128-byte block into a raw chaining state
+     * Exposed for callers that manage midstates directly (e.g. PBKDF2, multi-buffer kernels)
+     * @param chainingState 8-word state, updated in place
+     * @param block Pointer to one block of input
+     */
+    static void compress(uint64_t chainingState[8], const uint8_t* block);
+    
+    /**
+     * Get the initial chaining value of this variant
+     * @return Pointer to 8 IV words
+     */
+    const uint64_t* getInitialState() const { return initialState; }
+    
+    /**
+     * Get the current chaining value, covering the whole blocks absorbed so far
+     * Used to start multi-buffer lanes from a midstate (e.g. HMAC key blocks)
+     * @return Pointer to 8 state words
+     */
+    const uint64_t* getChainingState() const { return state; }
+    
+    // Round constants (FIPS 180-4)
+    static const uint64_t K[80];
+
+protected:
+    /**
+     * Constructor for truncated variants sharing the SHA512 compression function
+     * @param iv Initial hash value (8 words)
+     * @param hash_size Output size in bytes (truncated from the 64-byte state)
+     * @param name Algorithm name reported by getAlgorithmName()
+     */
+    SHA512(const uint64_t* iv, size_t hash_size, const char* name);
 
 private:
     // Internal state (8 64-bit words)
     uint64_t state[8];
     
+    // Variant parameters
+    const uint64_t* initialState;
+    size_t digestSize;
+    const char* algorithmName;
+    
     // Internal methods
     void processBlock(const uint8_t* block) override;
     void addPadding() override;
-    uint64_t rightRotate(uint64_t value, unsigned int count) const;
-    uint64_t choose(uint64_t x, uint64_t y, uint64_t z) const;
-    uint64_t majority(uint64_t x, uint64_t y, uint64_t z) const;
-    uint64_t sigma0(uint64_t x) const;
-    uint64_t sigma1(uint64_t x) const;
-    uint64_t bigSigma0(uint64_t x) const;
-    uint64_t bigSigma1(uint64_t x) const;
+    void saveState(HashState::Writer& writer) const override;
+    void loadState(HashState::Reader& reader) override;
+    static uint64_t rightRotate(uint64_t value, unsigned int count);
+    static uint64_t choose(uint64_t x, uint64_t y, uint64_t z);
+    static uint64_t majority(uint64_t x, uint64_t y, uint64_t z);
+    static uint64_t sigma0(uint64_t x);
+    static uint64_t sigma1(uint64_t x);
+    static uint64_t bigSigma0(uint64_t x);
+    static uint64_t bigSigma1(uint64_t x);
+};
+
+/**
+ * SHA-384 (FIPS 180-4): SHA512 compression with a distinct IV, truncated to 384 bits
+ */
+class SHA384 : public SHA512 {
+public:
+    SHA384();
+    std::unique_ptr<HashInterface> clone() const override;
+};
+
+/**
+ * SHA-512/224 (FIPS 180-4): SHA512 compression with a distinct IV, truncated to 224 bits
+ */
+class SHA512_224 : public SHA512 {
+public:
+    SHA512_224();
+    std::unique_ptr<HashInterface> clone() const override;
+};
+
+/**
+ * SHA-512/256 (FIPS 180-4): SHA512 compression with a distinct IV, truncated to 256 bits
+ * Faster per byte than SHA256 on 64-bit hardware with the same output size
+ */
+class SHA512_256 : public SHA512 {
+public:
+    SHA512_256();
+    std::unique_ptr<HashInterface> clone() const override;
 };
 
 #endif // SHA512_H
@@ -0,0 +1,349 @@
+#include "stream_multiplexer.h"
+#include "hash_dispatch.h"
+#include "multi_buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+class StreamMultiplexer::Engine {
+public:
+    virtual ~Engine() = default;
+    virtual void open(StreamId id) = 0;
+    virtual void update(StreamId id, const uint8_t* data, size_t length) = 0;
+    virtual void finalize(StreamId id, uint8_t* digest) = 0;
+    virtual void flush() = 0;
+    virtual size_t getStreamCount() const = 0;
+
+    std::atomic<StreamId> nextId{1};
+};
+
+namespace {
+
+typedef StreamMultiplexer::StreamId StreamId;
+
+// A single stream may queue this many blocks before the queue is drained with
+// partially filled lanes, bounding memory when few streams are active
+constexpr size_t MAX_QUEUED_BLOCKS = 256;
+
+// Blocks taken from each lane per claim, so the lock is not taken per block
+constexpr size_t BLOCKS_PER_CLAIM = 16;
+
+// Locking: mutex_ guards the stream table and the ready queue, each stream's
+// own mutex guards its queued bytes. mutex_ may be held while taking a stream
+// mutex, never the other way round. A drainer claims up to LANES ready streams,
+// copies their next blocks out and compresses them with no lock held; the
+// claim keeps other drainers (and finalize) off those streams meanwhile.
+template <typename H, typename Kernel>
+class LaneEngine : public StreamMultiplexer::Engine {
+public:
+    LaneEngine() : hashSize_(H().getHashSize()) {
+        std::memcpy(initialState_, H().getInitialState(), sizeof(initialState_));
+    }
+
+    void open(StreamId id) override {
+        std::unique_ptr<Stream> stream(new Stream());
+        stream->id = id;
+        std::memcpy(stream->state, initialState_, sizeof(stream->state));
+        std::lock_guard<std::mutex> lock(mutex_);
+        streams_[id] = std::move(stream);
+    }
+
+    void update(StreamId id, const uint8_t* data, size_t length) override {
+        Stream& stream = find(id);
+        if (length == 0) {
+            return;
+        }
+        size_t blocks;
+        {
+            std::lock_guard<std::mutex> lock(stream.mutex);
+            stream.queued.insert(stream.queued.end(), data, data + length);
+            stream.totalLength += length;
+            blocks = queuedBlocks(stream);
+        }
+        if (blocks > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            schedule(stream);
+        }
+        drain(blocks > MAX_QUEUED_BLOCKS);
+    }
+
+    void finalize(StreamId id, uint8_t* digest) override {
+        std::unique_ptr<Stream> owned;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto it = streams_.find(id);
+            if (it == streams_.end()) {
+                throw std::invalid_argument("Stream is not open: " + std::to_string(id));
+            }
+            Stream* claimed = it->second.get();
+            released_.wait(lock, [claimed]() { return !claimed->claimed; });
+            if (claimed->ready) {
+                ready_.erase(std::find(ready_.begin(), ready_.end(), id));
+            }
+            owned = std::move(streams_[id]);
+            streams_.erase(id);
+        }
+        Stream& stream = *owned;
+
+        // Finish this stream's queue on its own; it is already out of step with the lanes
+        while (queuedBlocks(stream) > 0) {
+            Kernel::compress(stream.state, stream.queued.data() + stream.offset);
+            stream.offset += Kernel::BLOCK_SIZE;
+        }
+
+        uint8_t tail[2 * Kernel::BLOCK_SIZE];
+        const size_t tailLength = stream.queued.size() - stream.offset;
+        if (tailLength > 0) {
+            std::memcpy(tail, stream.queued.data() + stream.offset, tailLength);
+        }
+        const size_t blocks = MultiBuffer::padFinalBlocks<Kernel>(tail, tailLength, stream.totalLength);
+        for (size_t i = 0; i < blocks; ++i) {
+            Kernel::compress(stream.state, tail + i * Kernel::BLOCK_SIZE);
+        }
+        MultiBuffer::storeBigEndian(stream.state, digest, hashSize_);
+    }
+
+    void flush() override {
+        drain(true);
+    }
+
+    size_t getStreamCount() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return streams_.size();
+    }
+
+private:
+    typedef typename Kernel::Word Word;
+
+    struct Stream {
+        StreamId id = 0;
+        Word state[8];
+        std::mutex mutex;
+        std::vector<uint8_t> queued;   // Unprocessed bytes, consumed from offset (stream mutex)
+        size_t offset = 0;
+        uint64_t totalLength = 0;
+        bool ready = false;            // Listed in ready_ or claimed by a drainer (mutex_)
+        bool claimed = false;          // Being compressed by a drainer (mutex_)
+    };
+
+    Stream& find(StreamId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = streams_.find(id);
+        if (it == streams_.end()) {
+            throw std::invalid_argument("Stream is not open: " + std::to_string(id));
+        }
+        return *it->second;
+    }
+
+    static size_t queuedBlocks(const Stream& stream) {
+        return (stream.queued.size() - stream.offset) / Kernel::BLOCK_SIZE;
+    }
+
+    // List a stream with a full block queued; caller holds mutex_
+    void schedule(Stream& stream) {
+        if (stream.ready) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        if (queuedBlocks(stream) > 0) {
+            stream.ready = true;
+            ready_.push_back(stream.id);
+        }
+    }
+
+    // Compress blocks from up to LANES ready streams side by side.
+    // Without force, only full lane groups are run.
+    void drain(bool force) {
+        Word states[Kernel::LANES][8];
+        uint8_t blocks[Kernel::LANES][BLOCKS_PER_CLAIM * Kernel::BLOCK_SIZE];
+        const uint8_t* pointers[Kernel::LANES];
+        Stream* lanes[Kernel::LANES];
+
+        for (;;) {
+            size_t count;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (ready_.size() < Kernel::LANES && !(force && !ready_.empty())) {
+                    return;
+                }
+                count = std::min(static_cast<size_t>(Kernel::LANES), ready_.size());
+                for (size_t lane = 0; lane < count; ++lane) {
+                    lanes[lane] = streams_.find(ready_.front())->second.get();
+                    lanes[lane]->claimed = true;
+                    ready_.pop_front();
+                }
+            }
+
+            // Every lane advances by the same number of blocks; queues only grow while claimed
+            size_t rounds = BLOCKS_PER_CLAIM;
+            for (size_t lane = 0; lane < count; ++lane) {
+                std::lock_guard<std::mutex> lock(lanes[lane]->mutex);
+                rounds = std::min(rounds, queuedBlocks(*lanes[lane]));
+            }
+            for (size_t lane = 0; lane < count; ++lane) {
+                Stream& stream = *lanes[lane];
+                std::lock_guard<std::mutex> lock(stream.mutex);
+                std::memcpy(blocks[lane], stream.queued.data() + stream.offset, rounds * Kernel::BLOCK_SIZE);
+                stream.offset += rounds * Kernel::BLOCK_SIZE;
+                std::memcpy(states[lane], stream.state, sizeof(states[lane]));
+            }
+
+            for (size_t round = 0; round < rounds; ++round) {
+                for (size_t lane = 0; lane < count; ++lane) {
+                    pointers[lane] = blocks[lane] + round * Kernel::BLOCK_SIZE;
+                }
+                Kernel::compressLanes(states, pointers, count);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (size_t lane = 0; lane < count; ++lane) {
+                    Stream& stream = *lanes[lane];
+                    std::lock_guard<std::mutex> streamLock(stream.mutex);
+                    std::memcpy(stream.state, states[lane], sizeof(stream.state));
+                    stream.claimed = false;
+                    if (queuedBlocks(stream) > 0) {
+                        // Rejoin at the back so that other streams fill the next lanes
+                        ready_.push_back(stream.id);
+                    } else {
+                        stream.ready = false;
+                        compact(stream);
+                    }
+                }
+            }
+            released_.notify_all();
+        }
+    }
+
+    // Drop consumed bytes once only a partial block remains
+    static void compact(Stream& stream) {
+        stream.queued.erase(stream.queued.begin(), stream.queued.begin() + stream.offset);
+        stream.offset = 0;
+    }
+
+    Word initialState_[8];
+    size_t hashSize_;
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+    std::unordered_map<StreamId, std::unique_ptr<Stream>> streams_;
+    std::deque<StreamId> ready_;
+};
+
+// Algorithms without a lane kernel hash each update in place, under the stream's own lock
+template <typename H>
+class ScalarEngine : public StreamMultiplexer::Engine {
+public:
+    void open(StreamId id) override {
+        std::unique_ptr<Stream> stream(new Stream());
+        std::lock_guard<std::mutex> lock(mutex_);
+        streams_[id] = std::move(stream);
+    }
+
+    void update(StreamId id, const uint8_t* data, size_t length) override {
+        Stream& stream = find(id);
+        std::lock_guard<std::mutex> lock(stream.mutex);
+        stream.hasher.update(data, length);
+    }
+
+    void finalize(StreamId id, uint8_t* digest) override {
+        std::unique_ptr<Stream> owned;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = streams_.find(id);
+            if (it == streams_.end()) {
+                throw std::invalid_argument("Stream is not open: " + std::to_string(id));
+            }
+            owned = std::move(it->second);
+            streams_.erase(it);
+        }
+        std::lock_guard<std::mutex> lock(owned->mutex);
+        owned->hasher.finalize();
+        owned->hasher.getDigest(digest);
+    }
+
+    void flush() override {
+    }
+
+    size_t getStreamCount() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return streams_.size();
+    }
+
+private:
+    struct Stream {
+        std::mutex mutex;
+        H hasher;
+    };
+
+    Stream& find(StreamId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = streams_.find(id);
+        if (it == streams_.end()) {
+            throw std::invalid_argument("Stream is not open: " + std::to_string(id));
+        }
+        return *it->second;
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<StreamId, std::unique_ptr<Stream>> streams_;
+};
+
+template <typename H>
+typename std::enable_if<!std::is_void<typename MultiBuffer::KernelFor<H>::type>::value,
+                        std::unique_ptr<StreamMultiplexer::Engine>>::type
+makeEngine() {
+    return std::unique_ptr<StreamMultiplexer::Engine>(
+        new LaneEngine<H, typename MultiBuffer::KernelFor<H>::type>());
+}
+
+template <typename H>
+typename std::enable_if<std::is_void<typename MultiBuffer::KernelFor<H>::type>::value,
+                        std::unique_ptr<StreamMultiplexer::Engine>>::type
+makeEngine() {
+    return std::unique_ptr<StreamMultiplexer::Engine>(new ScalarEngine<H>());
+}
+
+} // namespace
+
+StreamMultiplexer::StreamMultiplexer(const std::string& algorithm) : hashSize_(0) {
+    dispatchAlgorithm(algorithm, [&](auto tag) {
+        typedef typename decltype(tag)::type H;
+        engine_ = makeEngine<H>();
+        hashSize_ = H().getHashSize();
+    });
+}
+
+StreamMultiplexer::~StreamMultiplexer() = default;
+
+StreamMultiplexer::StreamId StreamMultiplexer::open() {
+    StreamId id = engine_->nextId++;
+    engine_->open(id);
+    return id;
+}
+
+void StreamMultiplexer::update(StreamId id, const uint8_t* data, size_t length) {
+    if (data == nullptr && length > 0) {
+        throw std::invalid_argument("Stream data must not be null");
+    }
+    engine_->update(id, data, length);
+}
+
+void StreamMultiplexer::finalize(StreamId id, uint8_t* digest) {
+    engine_->finalize(id, digest);
+}
+
+void StreamMultiplexer::flush() {
+    engine_->flush();
+}
+
+size_t StreamMultiplexer::getStreamCount() const {
+    return engine_->getStreamCount();
+}
@@ -0,0 +1,80 @@
+#ifndef STREAM_MULTIPLEXER_H
+#define STREAM_MULTIPLEXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * Interleaved hashing of many concurrent incremental streams
+ *
+ * Each stream is fed a chunk at a time. Complete blocks are queued per stream
+ * and, for the SHA-2 family, compressed together with blocks from other
+ * streams once enough streams have work to fill every multi-buffer lane.
+ * Other algorithms hash each update directly. All methods are thread-safe:
+ * lanes are filled under a short critical section and compression runs
+ * outside it, so threads updating different streams compress in parallel.
+ */
+class StreamMultiplexer {
+public:
+    typedef uint64_t StreamId;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm for every stream (any HashFactory name)
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    explicit StreamMultiplexer(const std::string& algorithm);
+
+    ~StreamMultiplexer();
+
+    StreamMultiplexer(const StreamMultiplexer&) = delete;
+    StreamMultiplexer& operator=(const StreamMultiplexer&) = delete;
+
+    /**
+     * Start a new stream
+     * @return Identifier for subsequent update/finalize calls
+     */
+    StreamId open();
+
+    /**
+     * Append data to a stream
+     * @param id Stream identifier returned by open()
+     * @param data Input bytes
+     * @param length Number of bytes
+     * @throws std::invalid_argument if the stream is not open
+     */
+    void update(StreamId id, const uint8_t* data, size_t length);
+
+    /**
+     * Finish a stream and release its context
+     * @param id Stream identifier returned by open()
+     * @param digest Output buffer of getHashSize() bytes
+     * @throws std::invalid_argument if the stream is not open
+     */
+    void finalize(StreamId id, uint8_t* digest);
+
+    /**
+     * Compress every queued block, even if lanes cannot be filled
+     */
+    void flush();
+
+    /**
+     * Get the number of open streams
+     */
+    size_t getStreamCount() const;
+
+    /**
+     * Get the digest size of the configured algorithm
+     */
+    size_t getHashSize() const { return hashSize_; }
+
+    class Engine;
+
+private:
+    std::unique_ptr<Engine> engine_;
+    size_t hashSize_;
+};
+
+#endif // STREAM_MULTIPLEXER_H
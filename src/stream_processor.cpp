@@ -1,5 +1,11 @@
 #include "stream_processor.h"
+#include "thread_pool.h"
+#include "batch_hash.h"
+#include "hash_factory.h"
+#include <algorithm>
 #include <cstring>
+#include <deque>
+#include <future>
 #include <stdexcept>
 
 StreamProcessor::StreamProcessor(std::unique_ptr<HashInterface> hasher)
@@ -41,6 +47,210 @@ void StreamProcessor::processStream(std::istream& input) {
     hasher_->finalize();
 }
 
+void StreamProcessor::processChunks(std::istream& input, const GearChunker& chunker, size_t threads,
+                                    const std::function<void(const ChunkRecord&)>& emit) {
+    if (!hasher_) {
+        throw std::runtime_error("No hash implementation available");
+    }
+    
+    // Workers clone a fresh prototype; cloning a const hasher is safe from any thread
+    std::unique_ptr<HashInterface> fresh = hasher_->clone();
+    fresh->reset();
+    std::shared_ptr<const HashInterface> prototype(std::move(fresh));
+    
+    ThreadPool pool(threads);
+    const size_t maxInFlight = pool.getThreadCount() * 4;
+    std::deque<std::future<ChunkRecord>> pending;
+    
+    auto emitOldest = [&]() {
+        ChunkRecord record = pending.front().get();
+        pending.pop_front();
+        emit(record);
+    };
+    
+    // The window always holds a full maximum-size chunk until the input ends,
+    // so boundaries never depend on read sizes
+    const size_t maxSize = chunker.getMaxSize();
+    std::vector<uint8_t> window(std::max(maxSize * 4, static_cast<size_t>(BUFFER_SIZE)));
+    size_t start = 0;
+    size_t end = 0;
+    uint64_t offset = 0;
+    bool eof = false;
+    
+    for (;;) {
+        if (!eof && end - start < maxSize) {
+            std::memmove(window.data(), window.data() + start, end - start);
+            end -= start;
+            start = 0;
+            while (!eof && end < window.size()) {
+                input.read(reinterpret_cast<char*>(window.data() + end),
+                           static_cast<std::streamsize>(window.size() - end));
+                std::streamsize bytesRead = input.gcount();
+                end += static_cast<size_t>(bytesRead);
+                eof = !input.good();
+            }
+        }
+        if (start == end) {
+            break;
+        }
+        
+        const size_t length = chunker.findBoundary(window.data() + start, end - start);
+        auto chunk = std::make_shared<std::vector<uint8_t>>(window.begin() + start,
+                                                            window.begin() + start + length);
+        if (pending.size() >= maxInFlight) {
+            emitOldest();
+        }
+        pending.push_back(pool.submit([chunk, prototype, offset]() {
+            std::unique_ptr<HashInterface> hasher = prototype->clone();
+            hasher->update(chunk->data(), chunk->size());
+            hasher->finalize();
+            ChunkRecord record;
+            record.offset = offset;
+            record.length = chunk->size();
+            record.digest.resize(hasher->getHashSize());
+            hasher->getDigest(record.digest.data());
+            return record;
+        }));
+        
+        start += length;
+        offset += length;
+    }
+    
+    while (!pending.empty()) {
+        emitOldest();
+    }
+}
+
+StreamProcessor::RecordFormat StreamProcessor::parseRecordFormat(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    
+    if (lower == "lines") {
+        return RecordFormat::LINES;
+    } else if (lower == "nul") {
+        return RecordFormat::NUL;
+    } else if (lower == "u32be-length") {
+        return RecordFormat::U32BE_LENGTH;
+    }
+    throw std::invalid_argument("Unsupported record format: " + name);
+}
+
+void StreamProcessor::processRecords(std::istream& input, RecordFormat format, std::ostream& output) {
+    if (!hasher_) {
+        throw std::runtime_error("No hash implementation available");
+    }
+    
+    static const char digits[] = "0123456789abcdef";
+    const std::string algorithm = hasher_->getAlgorithmName();
+    const size_t hashSize = hasher_->getHashSize();
+    // Keyed or custom hashers (HMAC, ...) have no batch kernel and state the name does not carry
+    const bool batched = HashFactory::isSupported(algorithm);
+    const char delimiter = (format == RecordFormat::NUL) ? '\0' : '\n';
+    
+    std::vector<uint8_t> window(RECORD_WINDOW_SIZE);
+    std::vector<HashSpan> spans;
+    spans.reserve(RECORD_BATCH_SIZE);
+    std::vector<uint8_t> digests(RECORD_BATCH_SIZE * hashSize);
+    std::string pending;
+    pending.reserve(OUTPUT_BUFFER_SIZE + RECORD_BATCH_SIZE * (hashSize * 2 + 1));
+    
+    // Spans point into the window, so every batch is hashed before the window moves
+    auto hashSpans = [&]() {
+        if (spans.empty()) {
+            return;
+        }
+        if (batched) {
+            hashBatch(algorithm, spans.data(), spans.size(), digests.data());
+        } else {
+            for (size_t i = 0; i < spans.size(); ++i) {
+                std::unique_ptr<HashInterface> hasher = hasher_->clone();
+                hasher->update(spans[i].data, spans[i].length);
+                hasher->finalize();
+                hasher->getDigest(digests.data() + i * hashSize);
+            }
+        }
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const uint8_t* digest = digests.data() + i * hashSize;
+            for (size_t j = 0; j < hashSize; ++j) {
+                pending.push_back(digits[digest[j] >> 4]);
+                pending.push_back(digits[digest[j] & 0x0f]);
+            }
+            pending.push_back('\n');
+        }
+        spans.clear();
+        if (pending.size() >= OUTPUT_BUFFER_SIZE) {
+            output.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+            pending.clear();
+        }
+    };
+    auto addRecord = [&](const uint8_t* data, size_t length) {
+        spans.push_back(HashSpan{data, length});
+        if (spans.size() == RECORD_BATCH_SIZE) {
+            hashSpans();
+        }
+    };
+    
+    size_t start = 0;
+    size_t end = 0;
+    bool eof = false;
+    
+    for (;;) {
+        // Collect every complete record in the window
+        if (format == RecordFormat::U32BE_LENGTH) {
+            while (end - start >= 4) {
+                const uint8_t* frame = window.data() + start;
+                const size_t length = (static_cast<size_t>(frame[0]) << 24) | (static_cast<size_t>(frame[1]) << 16) |
+                                      (static_cast<size_t>(frame[2]) << 8) | frame[3];
+                if (end - start - 4 < length) {
+                    break;
+                }
+                addRecord(frame + 4, length);
+                start += 4 + length;
+            }
+        } else {
+            // memchr is the libc's vectorized byte scan
+            while (start < end) {
+                const void* found = std::memchr(window.data() + start, delimiter, end - start);
+                if (!found) {
+                    break;
+                }
+                const size_t length = static_cast<const uint8_t*>(found) - (window.data() + start);
+                addRecord(window.data() + start, length);
+                start += length + 1;
+            }
+        }
+        
+        if (eof) {
+            if (start < end) {
+                if (format == RecordFormat::U32BE_LENGTH) {
+                    throw std::runtime_error("Truncated record frame at end of input");
+                }
+                addRecord(window.data() + start, end - start);
+            }
+            hashSpans();
+            break;
+        }
+        
+        hashSpans();
+        std::memmove(window.data(), window.data() + start, end - start);
+        end -= start;
+        start = 0;
+        
+        // A single record larger than the window grows it
+        if (end == window.size()) {
+            window.resize(window.size() * 2);
+        }
+        while (!eof && end < window.size()) {
+            input.read(reinterpret_cast<char*>(window.data() + end),
+                       static_cast<std::streamsize>(window.size() - end));
+            end += static_cast<size_t>(input.gcount());
+            eof = !input.good();
+        }
+    }
+    
+    output.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+}
+
 std::string StreamProcessor::getHash() const {
     if (!hasher_) {
         throw std::runtime_error("No hash implementation available");
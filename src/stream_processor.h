@@ -2,8 +2,22 @@
 #define STREAM_PROCESSOR_H
 
 #include "hash_interface.h"
+#include "cdc_chunker.h"
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * One content-defined chunk and its digest
+ */
+struct ChunkRecord {
+    uint64_t offset;
+    size_t length;
+    std::vector<uint8_t> digest;
+};
 
 /**
  * Stream processor for handling input data and feeding it to hash algorithms
@@ -11,6 +25,15 @@
  */
 class StreamProcessor {
 public:
+    /**
+     * Record framing for processRecords
+     */
+    enum class RecordFormat {
+        LINES,          // '\n'-terminated; the delimiter is not hashed
+        NUL,            // '\0'-terminated; the delimiter is not hashed
+        U32BE_LENGTH    // 4-byte big-endian length followed by the payload
+    };
+    
     /**
      * Constructor
      * @param hasher Unique pointer to hash implementation
@@ -23,6 +46,40 @@ public:
      */
     void processStream(std::istream& input);
     
+    /**
+     * Split the stream into content-defined chunks and hash each one
+     * Every chunk is hashed by its own clone of the configured hasher on a
+     * worker pool as soon as its boundary is known; records are delivered in
+     * stream order. The processor's own hasher is left untouched.
+     * @param input Input stream to read from
+     * @param chunker Boundary detector
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @param emit Called once per chunk, in order, on the calling thread
+     */
+    void processChunks(std::istream& input, const GearChunker& chunker, size_t threads,
+                       const std::function<void(const ChunkRecord&)>& emit);
+    
+    /**
+     * Hash every record of the stream and write one hex digest line per record
+     * Records are collected from a large read window, hashed together through
+     * the batch multi-buffer path and written in order through a buffered
+     * writer. A final delimited record without its delimiter still counts.
+     * A hasher that is not a plain HashFactory algorithm (HMAC, a custom
+     * implementation) is cloned once per record instead, so its key and state
+     * apply. The processor's own hasher is left untouched.
+     * @param input Input stream to read from
+     * @param format Record framing
+     * @param output Stream receiving the digest lines
+     * @throws std::runtime_error if a length-prefixed frame is truncated
+     */
+    void processRecords(std::istream& input, RecordFormat format, std::ostream& output);
+    
+    /**
+     * Parse a record format name (lines, nul, u32be-length)
+     * @throws std::invalid_argument for unknown names
+     */
+    static RecordFormat parseRecordFormat(const std::string& name);
+    
     /**
      * Get the final hash result
      * @return Hash as hexadecimal string
@@ -43,6 +100,9 @@ public:
 private:
     std::unique_ptr<HashInterface> hasher_;
     static const size_t BUFFER_SIZE = 32768; // 32KB buffer
+    static const size_t RECORD_WINDOW_SIZE = 4 * 1024 * 1024;   // Initial record read window
+    static const size_t RECORD_BATCH_SIZE = 1024;               // Records per hashBatch call
+    static const size_t OUTPUT_BUFFER_SIZE = 1024 * 1024;       // Digest lines per write
 };
 
 #endif // STREAM_PROCESSOR_H
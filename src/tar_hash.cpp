@@ -0,0 +1,320 @@
+#include "tar_hash.h"
+#include "hash_arena.h"
+#include "hash_factory.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+constexpr size_t TarHasher::BLOCK_SIZE;
+constexpr uint64_t TarHasher::MAX_EXTENDED_HEADER_SIZE;
+
+namespace {
+
+// ustar header field offsets and widths
+const size_t NAME_OFFSET = 0;
+const size_t NAME_LENGTH = 100;
+const size_t SIZE_OFFSET = 124;
+const size_t SIZE_LENGTH = 12;
+const size_t CHECKSUM_OFFSET = 148;
+const size_t CHECKSUM_LENGTH = 8;
+const size_t TYPE_OFFSET = 156;
+const size_t MAGIC_OFFSET = 257;
+const size_t PREFIX_OFFSET = 345;
+const size_t PREFIX_LENGTH = 155;
+
+const size_t READ_BUFFER_SIZE = 1024 * 1024;
+
+std::string fieldString(const uint8_t* field, size_t length) {
+    const char* text = reinterpret_cast<const char*>(field);
+    return std::string(text, std::find(text, text + length, '\0'));
+}
+
+// Octal, space/NUL terminated; or GNU base-256 when the high bit is set
+uint64_t parseNumber(const uint8_t* field, size_t length) {
+    uint64_t value = 0;
+    if (field[0] & 0x80) {
+        // Only non-negative values that fit in the low 64 bits are accepted
+        if ((field[0] & 0x7f) != 0 || std::any_of(field + 1, field + length - 8, [](uint8_t b) { return b != 0; })) {
+            throw std::runtime_error("Unsupported base-256 tar number");
+        }
+        for (size_t i = length - 8; i < length; ++i) {
+            value = (value << 8) | field[i];
+        }
+        return value;
+    }
+    size_t i = 0;
+    while (i < length && field[i] == ' ') {
+        ++i;
+    }
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = (value << 3) | static_cast<uint64_t>(field[i] - '0');
+    }
+    if (i < length && field[i] != ' ' && field[i] != '\0') {
+        throw std::runtime_error("Invalid tar header number");
+    }
+    return value;
+}
+
+bool isZeroBlock(const uint8_t* block) {
+    return std::all_of(block, block + TarHasher::BLOCK_SIZE, [](uint8_t b) { return b == 0; });
+}
+
+bool checksumMatches(const uint8_t* header) {
+    const uint64_t stored = parseNumber(header + CHECKSUM_OFFSET, CHECKSUM_LENGTH);
+    uint64_t unsignedSum = 0;
+    int64_t signedSum = 0;
+    for (size_t i = 0; i < TarHasher::BLOCK_SIZE; ++i) {
+        const bool inChecksum = i >= CHECKSUM_OFFSET && i < CHECKSUM_OFFSET + CHECKSUM_LENGTH;
+        const uint8_t byte = inChecksum ? ' ' : header[i];
+        unsignedSum += byte;
+        signedSum += static_cast<int8_t>(byte);
+    }
+    // Historic implementations summed signed chars
+    return stored == unsignedSum || static_cast<int64_t>(stored) == signedSum;
+}
+
+// Apply "length key=value\n" records of a pax extended header
+void parsePax(const std::string& data, std::string& path, uint64_t& size, bool& haveSize) {
+    size_t pos = 0;
+    while (pos < data.size()) {
+        const size_t space = data.find(' ', pos);
+        if (space == std::string::npos) {
+            break;
+        }
+        size_t length = 0;
+        try {
+            length = static_cast<size_t>(std::stoull(data.substr(pos, space - pos)));
+        } catch (const std::exception&) {
+            throw std::runtime_error("Invalid pax record length");
+        }
+        if (length == 0 || pos + length > data.size() || data[pos + length - 1] != '\n') {
+            throw std::runtime_error("Invalid pax record");
+        }
+        const std::string record = data.substr(space + 1, pos + length - space - 2);
+        const size_t equals = record.find('=');
+        if (equals != std::string::npos) {
+            const std::string key = record.substr(0, equals);
+            const std::string value = record.substr(equals + 1);
+            if (key == "path") {
+                path = value;
+            } else if (key == "size") {
+                try {
+                    size = std::stoull(value);
+                } catch (const std::exception&) {
+                    throw std::runtime_error("Invalid pax size: " + value);
+                }
+                haveSize = true;
+            }
+        }
+        pos += length;
+    }
+}
+
+// Buffered reader that feeds every consumed byte to the optional archive hasher
+class ArchiveReader {
+public:
+    ArchiveReader(std::istream& input, HashInterface* archive)
+        : input_(input), archive_(archive), buffer_(READ_BUFFER_SIZE), pos_(0), end_(0) {
+    }
+
+    // Up to max contiguous bytes; 0 only at end of input
+    size_t next(const uint8_t*& data, size_t max) {
+        if (pos_ == end_ && !refill()) {
+            return 0;
+        }
+        const size_t length = std::min(end_ - pos_, max);
+        data = buffer_.data() + pos_;
+        pos_ += length;
+        if (archive_) {
+            archive_->update(data, length);
+        }
+        return length;
+    }
+
+    size_t read(uint8_t* out, size_t length) {
+        size_t total = 0;
+        const uint8_t* data;
+        size_t got;
+        while (total < length && (got = next(data, length - total)) > 0) {
+            std::memcpy(out + total, data, got);
+            total += got;
+        }
+        return total;
+    }
+
+    // Consume length bytes; false if the input ends first
+    bool skip(uint64_t length) {
+        const uint8_t* data;
+        while (length > 0) {
+            const size_t got = next(data, static_cast<size_t>(std::min<uint64_t>(length, READ_BUFFER_SIZE)));
+            if (got == 0) {
+                return false;
+            }
+            length -= got;
+        }
+        return true;
+    }
+
+    void drain() {
+        const uint8_t* data;
+        while (next(data, READ_BUFFER_SIZE) > 0) {
+        }
+    }
+
+private:
+    bool refill() {
+        if (!input_.good()) {
+            return false;
+        }
+        input_.read(reinterpret_cast<char*>(buffer_.data()), static_cast<std::streamsize>(buffer_.size()));
+        pos_ = 0;
+        end_ = static_cast<size_t>(input_.gcount());
+        return end_ > 0;
+    }
+
+    std::istream& input_;
+    HashInterface* archive_;
+    std::vector<uint8_t> buffer_;
+    size_t pos_;
+    size_t end_;
+};
+
+uint64_t paddedSize(uint64_t size) {
+    return (size + TarHasher::BLOCK_SIZE - 1) / TarHasher::BLOCK_SIZE * TarHasher::BLOCK_SIZE;
+}
+
+} // namespace
+
+TarHasher::TarHasher(const std::string& algorithm, bool archiveDigest)
+    : algorithm_(algorithm), archiveDigest_(archiveDigest), memberCount_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+}
+
+void TarHasher::processStream(std::istream& input, const std::function<void(const TarMember&)>& emit) {
+    std::unique_ptr<HashInterface> archive;
+    if (archiveDigest_) {
+        archive = HashFactory::createHash(algorithm_);
+    }
+    ArchiveReader reader(input, archive.get());
+
+    // Members are hashed one at a time, so a single small slab serves the whole archive
+    HashArena arena(algorithm_, 4);
+    uint8_t header[BLOCK_SIZE];
+    std::string pendingPath;
+    uint64_t pendingSize = 0;
+    bool havePendingSize = false;
+    uint64_t offset = 0;
+    memberCount_ = 0;
+    archiveHash_.clear();
+
+    for (;;) {
+        const size_t got = reader.read(header, BLOCK_SIZE);
+        if (got == 0) {
+            break;      // Archive without end-of-archive blocks
+        }
+        if (got < BLOCK_SIZE) {
+            throw std::runtime_error("Truncated tar header at offset " + std::to_string(offset));
+        }
+        if (isZeroBlock(header)) {
+            break;
+        }
+        if (!checksumMatches(header)) {
+            throw std::runtime_error("Invalid tar header checksum at offset " + std::to_string(offset));
+        }
+        offset += BLOCK_SIZE;
+
+        const char type = static_cast<char>(header[TYPE_OFFSET]);
+        uint64_t size = parseNumber(header + SIZE_OFFSET, SIZE_LENGTH);
+
+        // Extended headers carry metadata for the entry that follows
+        if (type == 'x' || type == 'g' || type == 'L') {
+            // The size is untrusted; it must not decide how much is allocated
+            if (size > MAX_EXTENDED_HEADER_SIZE) {
+                throw std::runtime_error("Invalid tar extended header size at offset " + std::to_string(offset));
+            }
+            std::string data(static_cast<size_t>(size), '\0');
+            if (reader.read(reinterpret_cast<uint8_t*>(&data[0]), data.size()) != data.size() ||
+                !reader.skip(paddedSize(size) - size)) {
+                throw std::runtime_error("Truncated tar extended header at offset " + std::to_string(offset));
+            }
+            if (type == 'x') {
+                parsePax(data, pendingPath, pendingSize, havePendingSize);
+            } else if (type == 'L') {
+                pendingPath = data.substr(0, data.find('\0'));
+            }
+            // Global pax headers do not name a member; they are consumed and ignored
+            offset += paddedSize(size);
+            continue;
+        }
+
+        std::string path = fieldString(header + NAME_OFFSET, NAME_LENGTH);
+        if (std::memcmp(header + MAGIC_OFFSET, "ustar\0", 6) == 0) {
+            const std::string prefix = fieldString(header + PREFIX_OFFSET, PREFIX_LENGTH);
+            if (!prefix.empty()) {
+                path = prefix + "/" + path;
+            }
+        }
+        if (!pendingPath.empty()) {
+            path = pendingPath;
+        }
+        if (havePendingSize) {
+            size = pendingSize;
+        }
+        pendingPath.clear();
+        havePendingSize = false;
+
+        const bool regular = type == '0' || type == '\0' || type == '7';
+        if (!regular) {
+            // Links, directories and devices carry no data in practice; skip whatever they declare
+            if (!reader.skip(paddedSize(size))) {
+                throw std::runtime_error("Truncated tar entry: " + path);
+            }
+            offset += paddedSize(size);
+            continue;
+        }
+
+        HashArena::Context* context = arena.acquire();
+        uint64_t remaining = size;
+        const uint8_t* data;
+        while (remaining > 0) {
+            const size_t chunk = reader.next(data, static_cast<size_t>(std::min<uint64_t>(remaining, READ_BUFFER_SIZE)));
+            if (chunk == 0) {
+                arena.release(context);
+                throw std::runtime_error("Truncated tar member: " + path);
+            }
+            arena.update(context, data, chunk);
+            remaining -= chunk;
+        }
+
+        TarMember member;
+        member.path = path;
+        member.size = size;
+        member.digest.resize(arena.getHashSize());
+        arena.finalize(context, member.digest.data());
+        arena.release(context);
+
+        if (!reader.skip(paddedSize(size) - size)) {
+            throw std::runtime_error("Truncated tar member: " + path);
+        }
+        offset += paddedSize(size);
+        ++memberCount_;
+        emit(member);
+    }
+
+    if (archive) {
+        // Trailing zero blocks and record padding belong to the archive too
+        reader.drain();
+        archive->finalize();
+        archiveHash_ = archive->getHash();
+    }
+}
+
+std::string TarHasher::getArchiveHash() const {
+    if (archiveHash_.empty()) {
+        throw std::runtime_error("Cannot get archive hash: archive digest disabled or no stream processed");
+    }
+    return archiveHash_;
+}
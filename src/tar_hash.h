@@ -0,0 +1,69 @@
+#ifndef TAR_HASH_H
+#define TAR_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * One regular file inside a tar stream and its digest
+ */
+struct TarMember {
+    std::string path;
+    uint64_t size;
+    std::vector<uint8_t> digest;
+};
+
+/**
+ * Per-member digests of a tar stream in a single pass, without extraction
+ *
+ * A streaming header parser walks ustar headers, pax extended headers
+ * (path and size records) and GNU long names. The data of every regular file
+ * is fed to a fresh context taken from a HashArena, so contexts are recycled
+ * across members instead of allocated per file. Directories, links and other
+ * entries are skipped. Optionally the whole input is hashed in the same pass.
+ */
+class TarHasher {
+public:
+    static constexpr size_t BLOCK_SIZE = 512;
+    static constexpr uint64_t MAX_EXTENDED_HEADER_SIZE = 1024 * 1024;   // Pax and GNU long name data
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @param archiveDigest Also hash the whole input stream
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    explicit TarHasher(const std::string& algorithm, bool archiveDigest = false);
+
+    /**
+     * Hash every regular file member of a tar stream
+     * @param input Tar stream
+     * @param emit Called once per regular file, in archive order
+     * @throws std::runtime_error on malformed headers or truncated members
+     */
+    void processStream(std::istream& input, const std::function<void(const TarMember&)>& emit);
+
+    /**
+     * Get the digest of the whole input stream, including padding and
+     * trailing blocks (matches hashing the archive file itself)
+     * @throws std::runtime_error if archive digests are disabled or nothing was processed
+     */
+    std::string getArchiveHash() const;
+
+    /**
+     * Get the number of regular file members in the last stream
+     */
+    size_t getMemberCount() const { return memberCount_; }
+
+private:
+    std::string algorithm_;
+    bool archiveDigest_;
+    size_t memberCount_;
+    std::string archiveHash_;
+};
+
+#endif // TAR_HASH_H
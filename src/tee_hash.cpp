@@ -0,0 +1,99 @@
+#include "tee_hash.h"
+#include "file_io.h"
+#include "hash_factory.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+constexpr size_t TeeHasher::BUFFER_SIZE;
+
+namespace {
+
+#ifdef __linux__
+bool isPipe(int fd) {
+    struct stat info;
+    return ::fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+}
+
+// Duplicate each pipe buffer into the output with tee(2), then consume the same
+// bytes from the input for hashing. Returns false if tee is refused before any
+// data moved, leaving the caller to fall back to read/write.
+bool teePipes(int inFd, int outFd, HashInterface& hasher, std::vector<uint8_t>& buffer, uint64_t& forwarded) {
+    for (;;) {
+        ssize_t n = ::tee(inFd, outFd, TeeHasher::BUFFER_SIZE, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EINVAL && forwarded == 0) {
+                return false;
+            }
+            throw std::runtime_error(std::string("tee failed: ") + std::strerror(errno));
+        }
+        if (n == 0) {
+            return true;    // No writers left and the pipe is drained
+        }
+
+        // The duplicated bytes are already buffered in the input pipe
+        size_t remaining = static_cast<size_t>(n);
+        while (remaining > 0) {
+            const size_t got = FileIO::readSome(inFd, buffer.data(), std::min(remaining, buffer.size()));
+            if (got == 0) {
+                throw std::runtime_error("Input pipe ended inside a tee'd buffer");
+            }
+            hasher.update(buffer.data(), got);
+            remaining -= got;
+        }
+        forwarded += static_cast<uint64_t>(n);
+    }
+}
+#endif
+
+} // namespace
+
+TeeHasher::TeeHasher(const std::string& algorithm)
+    : algorithm_(algorithm), bytesForwarded_(0), zeroCopy_(false) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+}
+
+void TeeHasher::process(int inFd, int outFd) {
+    auto hasher = HashFactory::createHash(algorithm_);
+    std::vector<uint8_t> buffer(BUFFER_SIZE);
+    bytesForwarded_ = 0;
+    zeroCopy_ = false;
+
+#ifdef __linux__
+    if (isPipe(inFd) && isPipe(outFd)) {
+        zeroCopy_ = teePipes(inFd, outFd, *hasher, buffer, bytesForwarded_);
+    }
+#endif
+
+    if (!zeroCopy_) {
+        for (;;) {
+            const size_t got = FileIO::readSome(inFd, buffer.data(), buffer.size());
+            if (got == 0) {
+                break;
+            }
+            hasher->update(buffer.data(), got);
+            FileIO::writeAll(outFd, buffer.data(), got);
+            bytesForwarded_ += got;
+        }
+    }
+
+    hasher->finalize();
+    digest_ = hasher->getHash();
+}
+
+std::string TeeHasher::getHash() const {
+    if (digest_.empty()) {
+        throw std::runtime_error("Cannot get hash before processing a stream");
+    }
+    return digest_;
+}
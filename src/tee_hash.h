@@ -0,0 +1,59 @@
+#ifndef TEE_HASH_H
+#define TEE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Pass-through hashing: forwards an input descriptor to an output descriptor
+ * unchanged while the same bytes feed the hasher, so a pipeline stage can
+ * digest a stream in flight without a second read.
+ *
+ * When both descriptors are pipes (Linux), tee(2) duplicates the data
+ * straight from the input pipe into the output pipe inside the kernel; the
+ * bytes are then read once into userspace for hashing only. Otherwise each
+ * buffer is read, hashed and written.
+ */
+class TeeHasher {
+public:
+    // Bytes moved per tee(2) call or read/write round
+    static constexpr size_t BUFFER_SIZE = 256 * 1024;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm (any HashFactory name)
+     * @throws std::invalid_argument on unsupported algorithm
+     */
+    explicit TeeHasher(const std::string& algorithm);
+
+    /**
+     * Forward everything from inFd to outFd until end of input, hashing it
+     * @throws std::runtime_error on I/O errors
+     */
+    void process(int inFd, int outFd);
+
+    /**
+     * Get the digest of the forwarded bytes
+     * @throws std::runtime_error if nothing has been processed
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the number of bytes forwarded by the last run
+     */
+    uint64_t getBytesForwarded() const { return bytesForwarded_; }
+
+    /**
+     * Check whether the last run used the in-kernel tee(2) path
+     */
+    bool isZeroCopy() const { return zeroCopy_; }
+
+private:
+    std::string algorithm_;
+    uint64_t bytesForwarded_;
+    bool zeroCopy_;
+    std::string digest_;
+};
+
+#endif // TEE_HASH_H
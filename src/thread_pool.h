@@ -0,0 +1,68 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed-size worker pool for parallel hashing tasks
+ */
+class ThreadPool {
+public:
+    /**
+     * Constructor
+     * @param threads Number of worker threads (0 selects the hardware concurrency)
+     */
+    explicit ThreadPool(size_t threads = 0);
+
+    /**
+     * Destructor - drains the queue and joins all workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a task for execution
+     * @param task Callable with no arguments
+     * @return Future for the task's result (exceptions propagate through get())
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<decltype(task())> {
+        typedef decltype(task()) Result;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    /**
+     * Get the number of worker threads
+     */
+    size_t getThreadCount() const { return workers_.size(); }
+
+    /**
+     * Get the default worker count for this machine
+     */
+    static size_t defaultThreadCount();
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    bool stopping_;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,81 @@
+#include "tree_hash.h"
+#include "hash_factory.h"
+#include "hash_base.h"
+#include "chunk_hasher.h"
+#include <stdexcept>
+
+constexpr uint8_t TreeHasher::LEAF_PREFIX;
+constexpr uint8_t TreeHasher::NODE_PREFIX;
+
+TreeHasher::TreeHasher(const std::string& algorithm, size_t leafSize, size_t threads)
+    : algorithm_(algorithm), leafSize_(leafSize), threads_(threads), leafCount_(0) {
+    if (!HashFactory::isSupported(algorithm)) {
+        throw std::invalid_argument("Unsupported hash algorithm: " + algorithm);
+    }
+    if (leafSize == 0) {
+        throw std::invalid_argument("Tree leaf size must be greater than zero");
+    }
+}
+
+void TreeHasher::hashLeaf(const std::string& algorithm, const uint8_t* data, size_t length, uint8_t* digest) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(&LEAF_PREFIX, 1);
+    hasher->update(data, length);
+    hasher->finalize();
+    hasher->getDigest(digest);
+}
+
+std::vector<uint8_t> TreeHasher::combine(const std::string& algorithm,
+                                         std::vector<std::vector<uint8_t>> digests, size_t hashSize) {
+    if (digests.empty()) {
+        throw std::invalid_argument("Tree must contain at least one leaf");
+    }
+
+    auto hasher = HashFactory::createHash(algorithm);
+    while (digests.size() > 1) {
+        std::vector<std::vector<uint8_t>> parents;
+        parents.reserve((digests.size() + 1) / 2);
+
+        for (size_t i = 0; i + 1 < digests.size(); i += 2) {
+            std::vector<uint8_t> parent(hashSize);
+            hasher->reset();
+            hasher->update(&NODE_PREFIX, 1);
+            hasher->update(digests[i].data(), hashSize);
+            hasher->update(digests[i + 1].data(), hashSize);
+            hasher->finalize();
+            hasher->getDigest(parent.data());
+            parents.push_back(std::move(parent));
+        }
+
+        // Unpaired last node is promoted unchanged
+        if (digests.size() % 2 == 1) {
+            parents.push_back(std::move(digests.back()));
+        }
+        digests.swap(parents);
+    }
+
+    return digests.front();
+}
+
+void TreeHasher::processStream(std::istream& input) {
+    ParallelChunkHasher leaves(algorithm_, leafSize_, threads_);
+    const size_t hashSize = leaves.getHashSize();
+    std::vector<std::vector<uint8_t>> digests = leaves.hashStream(input, &LEAF_PREFIX, 1);
+
+    // Empty input is a single empty leaf
+    if (digests.empty()) {
+        std::vector<uint8_t> digest(hashSize);
+        hashLeaf(algorithm_, nullptr, 0, digest.data());
+        digests.push_back(std::move(digest));
+    }
+
+    leafCount_ = digests.size();
+    root_ = combine(algorithm_, std::move(digests), hashSize);
+}
+
+std::string TreeHasher::getHash() const {
+    if (root_.empty()) {
+        throw std::runtime_error("Cannot get tree hash before processing a stream");
+    }
+    return HashBase::toHex(root_.data(), root_.size());
+}
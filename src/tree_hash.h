@@ -0,0 +1,79 @@
+#ifndef TREE_HASH_H
+#define TREE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Merkle tree hashing of a single stream
+ *
+ * The input is split into fixed-size leaves that are hashed in parallel and
+ * combined into a root digest. The layout is:
+ *
+ *   leaf  = H(0x00 || leaf bytes)             every leaf is leafSize bytes except the last
+ *   node  = H(0x01 || left digest || right digest)
+ *   root  = the single node left after pairing levels bottom-up; an unpaired
+ *           last node is promoted to the next level unchanged
+ *
+ * Empty input is a single empty leaf, H(0x00). The 0x00/0x01 prefixes keep
+ * leaf and interior-node preimages distinct.
+ */
+class TreeHasher {
+public:
+    static constexpr uint8_t LEAF_PREFIX = 0x00;
+    static constexpr uint8_t NODE_PREFIX = 0x01;
+
+    /**
+     * Constructor
+     * @param algorithm Hash algorithm for leaves and nodes (any HashFactory name)
+     * @param leafSize Leaf size in bytes
+     * @param threads Worker threads (0 selects the hardware concurrency)
+     * @throws std::invalid_argument on unsupported algorithm or zero leaf size
+     */
+    TreeHasher(const std::string& algorithm, size_t leafSize, size_t threads = 0);
+
+    /**
+     * Hash an entire stream and compute the root
+     * @param input Input stream to read from
+     */
+    void processStream(std::istream& input);
+
+    /**
+     * Get the root digest
+     * @return Root as lowercase hex string
+     * @throws std::runtime_error if no stream has been processed
+     */
+    std::string getHash() const;
+
+    /**
+     * Get the number of leaves in the last processed stream
+     */
+    size_t getLeafCount() const { return leafCount_; }
+
+    /**
+     * Hash one leaf
+     * @param digest Output buffer of the algorithm's hash size
+     */
+    static void hashLeaf(const std::string& algorithm, const uint8_t* data, size_t length, uint8_t* digest);
+
+    /**
+     * Combine leaf digests into the root digest
+     * @param digests Leaf digests, each hashSize bytes, in stream order (modified in place)
+     * @param hashSize Digest size of the algorithm
+     * @return Root digest bytes
+     */
+    static std::vector<uint8_t> combine(const std::string& algorithm,
+                                        std::vector<std::vector<uint8_t>> digests, size_t hashSize);
+
+private:
+    std::string algorithm_;
+    size_t leafSize_;
+    size_t threads_;
+    size_t leafCount_;
+    std::vector<uint8_t> root_;
+};
+
+#endif // TREE_HASH_H
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "append_hash.h"
+#include "hash_factory.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+class AppendHasherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string base = ::testing::TempDir() + "append_hash_" + std::to_string(::getpid());
+        dataPath = base + ".log";
+        statePath = base + ".state";
+        std::remove(dataPath.c_str());
+        std::remove(statePath.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(dataPath.c_str());
+        std::remove(statePath.c_str());
+    }
+
+    void append(const std::string& text) {
+        std::ofstream out(dataPath, std::ios::binary | std::ios::app);
+        out << text;
+        contents += text;
+    }
+
+    void rewrite(size_t offset, const std::string& text) {
+        std::ofstream out(dataPath, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(offset));
+        out << text;
+        contents.replace(offset, text.size(), text);
+    }
+
+    std::string run(AppendHasher& hasher) {
+        int fd = ::open(dataPath.c_str(), O_RDONLY);
+        EXPECT_GE(fd, 0);
+        hasher.processFile(fd);
+        ::close(fd);
+        return hasher.getHash();
+    }
+
+    std::string expected(const std::string& algorithm) const {
+        auto hasher = HashFactory::createHash(algorithm);
+        hasher->update(reinterpret_cast<const uint8_t*>(contents.data()), contents.size());
+        hasher->finalize();
+        return hasher->getHash();
+    }
+
+    std::string dataPath;
+    std::string statePath;
+    std::string contents;
+};
+
+} // namespace
+
+TEST_F(AppendHasherTest, ResumesFromSavedState) {
+    AppendHasher hasher("SHA256", statePath);
+    append(std::string(10000, 'a'));
+    EXPECT_EQ(run(hasher), expected("SHA256"));
+    EXPECT_EQ(hasher.getResumedOffset(), 0u);
+    EXPECT_EQ(hasher.getBytesHashed(), 10000u);
+
+    append("second batch of log lines\n");
+    EXPECT_EQ(run(hasher), expected("SHA256"));
+    EXPECT_EQ(hasher.getResumedOffset(), 10000u);
+    EXPECT_EQ(hasher.getBytesHashed(), 26u);
+
+    // Nothing appended: nothing read
+    EXPECT_EQ(run(hasher), expected("SHA256"));
+    EXPECT_EQ(hasher.getBytesHashed(), 0u);
+}
+
+TEST_F(AppendHasherTest, RewrittenFileIsHashedFromStart) {
+    AppendHasher hasher("SHA512", statePath);
+    append(std::string(5000, 'x'));
+    run(hasher);
+
+    // In-place edits are detected within the anchor window before the saved offset
+    rewrite(4990, "changed");
+    append("more");
+    EXPECT_EQ(run(hasher), expected("SHA512"));
+    EXPECT_EQ(hasher.getResumedOffset(), 0u);
+    EXPECT_EQ(hasher.getBytesHashed(), 5004u);
+}
+
+TEST_F(AppendHasherTest, TruncatedFileIsHashedFromStart) {
+    AppendHasher hasher("MD5", statePath);
+    append(std::string(300, 'y'));
+    run(hasher);
+
+    ASSERT_EQ(::truncate(dataPath.c_str(), 100), 0);
+    contents.resize(100);
+    EXPECT_EQ(run(hasher), expected("MD5"));
+    EXPECT_EQ(hasher.getResumedOffset(), 0u);
+}
+
+TEST_F(AppendHasherTest, StateFromOtherAlgorithmIsIgnored) {
+    append("abc");
+    AppendHasher sha1("SHA1", statePath);
+    run(sha1);
+
+    AppendHasher sha256("SHA256", statePath);
+    EXPECT_EQ(run(sha256), expected("SHA256"));
+    EXPECT_EQ(sha256.getResumedOffset(), 0u);
+}
+
+TEST_F(AppendHasherTest, CorruptStateIsIgnored) {
+    append("abc");
+    {
+        std::ofstream out(statePath, std::ios::binary);
+        out << "garbage";
+    }
+    AppendHasher hasher("SHA256", statePath);
+    EXPECT_EQ(run(hasher), expected("SHA256"));
+}
+
+TEST_F(AppendHasherTest, InvalidArguments) {
+    EXPECT_THROW(AppendHasher("unknown", statePath), std::invalid_argument);
+    EXPECT_THROW(AppendHasher("SHA256", ""), std::invalid_argument);
+
+    AppendHasher hasher("SHA256", statePath);
+    EXPECT_THROW(hasher.getHash(), std::runtime_error);
+
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    EXPECT_THROW(hasher.processFile(fds[0]), std::runtime_error);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "batch_hash.h"
+#include "hash_factory.h"
+#include "hash_base.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string referenceHash(const std::string& algorithm, const std::vector<uint8_t>& message) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(message.data(), message.size());
+    hasher->finalize();
+    return hasher->getHash();
+}
+
+// Messages of varied lengths around the one- and two-block padding boundaries
+std::vector<std::vector<uint8_t>> makeMessages(size_t count) {
+    std::vector<std::vector<uint8_t>> messages;
+    for (size_t i = 0; i < count; ++i) {
+        size_t length = (i * 37 + 11) % 300;
+        std::vector<uint8_t> message(length);
+        for (size_t j = 0; j < length; ++j) {
+            message[j] = static_cast<uint8_t>(i * 7 + j);
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+void expectMatchesReference(const std::string& algorithm, const std::vector<std::vector<uint8_t>>& messages) {
+    std::vector<HashSpan> spans;
+    for (const auto& message : messages) {
+        spans.push_back(HashSpan{message.data(), message.size()});
+    }
+
+    const size_t hashSize = HashFactory::createHash(algorithm)->getHashSize();
+    std::vector<uint8_t> digests(messages.size() * hashSize);
+    hashBatch(algorithm, spans.data(), spans.size(), digests.data());
+
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(HashBase::toHex(digests.data() + i * hashSize, hashSize), referenceHash(algorithm, messages[i]))
+            << algorithm << " message " << i << " length " << messages[i].size();
+    }
+}
+
+} // namespace
+
+TEST(BatchHashTest, KnownVectors) {
+    const std::string abc = "abc";
+    HashSpan spans[2] = {
+        {reinterpret_cast<const uint8_t*>(abc.data()), abc.size()},
+        {nullptr, 0}
+    };
+    uint8_t digests[64];
+    hashBatch("SHA256", spans, 2, digests);
+
+    EXPECT_EQ(HashBase::toHex(digests, 32), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(HashBase::toHex(digests + 32, 32), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(BatchHashTest, MatchesSingleMessageHashing) {
+    // 150 messages spans several sort windows and a partial final lane group
+    auto messages = makeMessages(150);
+    for (const auto& algorithm : HashFactory::getSupportedAlgorithms()) {
+        expectMatchesReference(algorithm, messages);
+    }
+}
+
+TEST(BatchHashTest, PaddingBoundaries) {
+    std::vector<std::vector<uint8_t>> messages;
+    for (size_t length : {0, 55, 56, 63, 64, 111, 112, 127, 128, 129}) {
+        messages.push_back(std::vector<uint8_t>(length, 0x61));
+    }
+    expectMatchesReference("SHA256", messages);
+    expectMatchesReference("SHA512", messages);
+    expectMatchesReference("SHA384", messages);
+}
+
+TEST(BatchHashTest, EmptyBatch) {
+    EXPECT_NO_THROW(hashBatch("SHA256", nullptr, 0, nullptr));
+}
+
+TEST(BatchHashTest, InvalidArguments) {
+    uint8_t digest[32];
+    HashSpan span = {nullptr, 4};
+    EXPECT_THROW(hashBatch("SHA256", &span, 1, digest), std::invalid_argument);
+    EXPECT_THROW(hashBatch("SHA256", nullptr, 1, digest), std::invalid_argument);
+
+    HashSpan empty = {nullptr, 0};
+    EXPECT_THROW(hashBatch("unknown", &empty, 1, digest), std::invalid_argument);
+}
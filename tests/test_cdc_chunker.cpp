@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "cdc_chunker.h"
+#include "stream_processor.h"
+#include "hash_factory.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Deterministic pseudo-random bytes (xorshift), so chunk boundaries are reproducible
+std::string randomData(size_t length, uint64_t seed) {
+    std::string data(length, '\0');
+    uint64_t x = seed;
+    for (size_t i = 0; i < length; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        data[i] = static_cast<char>(x);
+    }
+    return data;
+}
+
+std::vector<ChunkRecord> chunkAll(const std::string& data, const GearChunker& chunker, size_t threads = 2) {
+    StreamProcessor processor(HashFactory::createHash("SHA256"));
+    std::istringstream input(data);
+    std::vector<ChunkRecord> records;
+    processor.processChunks(input, chunker, threads, [&](const ChunkRecord& record) {
+        records.push_back(record);
+    });
+    return records;
+}
+
+std::vector<uint8_t> digestOf(const std::string& data, uint64_t offset, size_t length) {
+    auto hasher = HashFactory::createHash("SHA256");
+    hasher->update(reinterpret_cast<const uint8_t*>(data.data()) + offset, length);
+    hasher->finalize();
+    std::vector<uint8_t> digest(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return digest;
+}
+
+} // namespace
+
+TEST(GearChunkerTest, RespectsSizeBounds) {
+    GearChunker chunker(1024, 4096, 16384);
+    std::string data = randomData(1 << 20, 1);
+    auto records = chunkAll(data, chunker);
+
+    uint64_t expectedOffset = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].offset, expectedOffset);
+        EXPECT_LE(records[i].length, 16384u);
+        if (i + 1 < records.size()) {
+            EXPECT_GE(records[i].length, 1024u);
+        }
+        expectedOffset += records[i].length;
+    }
+    EXPECT_EQ(expectedOffset, data.size());
+
+    // Normalized chunking keeps the mean near the target
+    double mean = static_cast<double>(data.size()) / records.size();
+    EXPECT_GT(mean, 2048.0);
+    EXPECT_LT(mean, 8192.0);
+}
+
+TEST(GearChunkerTest, DigestsMatchChunkContents) {
+    GearChunker chunker;
+    std::string data = randomData(300000, 2);
+    for (const auto& record : chunkAll(data, chunker, 4)) {
+        EXPECT_EQ(record.digest, digestOf(data, record.offset, record.length));
+    }
+}
+
+TEST(GearChunkerTest, BoundariesResynchronizeAfterInsertion) {
+    GearChunker chunker(512, 2048, 8192);
+    std::string original = randomData(200000, 3);
+    std::string edited = original;
+    edited.insert(1000, "inserted bytes shift every later offset");
+
+    auto before = chunkAll(original, chunker);
+    auto after = chunkAll(edited, chunker);
+
+    // Content after the edit produces the same chunks, so most digests are shared
+    size_t shared = 0;
+    for (const auto& a : after) {
+        for (const auto& b : before) {
+            if (a.digest == b.digest) {
+                ++shared;
+                break;
+            }
+        }
+    }
+    EXPECT_GE(shared + 3, before.size());
+}
+
+TEST(GearChunkerTest, IndependentOfThreadCount) {
+    GearChunker chunker;
+    std::string data = randomData(500000, 4);
+    auto one = chunkAll(data, chunker, 1);
+    auto many = chunkAll(data, chunker, 8);
+    ASSERT_EQ(one.size(), many.size());
+    for (size_t i = 0; i < one.size(); ++i) {
+        EXPECT_EQ(one[i].offset, many[i].offset);
+        EXPECT_EQ(one[i].digest, many[i].digest);
+    }
+}
+
+TEST(GearChunkerTest, SmallAndEmptyInput) {
+    GearChunker chunker;
+    EXPECT_TRUE(chunkAll("", chunker).empty());
+
+    auto records = chunkAll("abc", chunker);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].length, 3u);
+    EXPECT_EQ(records[0].digest, digestOf("abc", 0, 3));
+}
+
+TEST(GearChunkerTest, InvalidSizes) {
+    EXPECT_THROW(GearChunker(0, 4096, 8192), std::invalid_argument);
+    EXPECT_THROW(GearChunker(8192, 4096, 16384), std::invalid_argument);
+    EXPECT_THROW(GearChunker(1024, 4096, 2048), std::invalid_argument);
+    EXPECT_THROW(GearChunker(1024, 3000, 8192), std::invalid_argument);
+}
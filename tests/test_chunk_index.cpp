@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include "chunk_index.h"
+#include "tree_hash.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+class ChunkIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string base = ::testing::TempDir() + "chunk_index_" + std::to_string(::getpid());
+        dataPath = base + ".img";
+        indexPath = base + ".idx";
+        std::remove(dataPath.c_str());
+        std::remove(indexPath.c_str());
+    }
+
+    void TearDown() override {
+        std::remove(dataPath.c_str());
+        std::remove(indexPath.c_str());
+    }
+
+    void writeFile(const std::string& data) {
+        std::ofstream out(dataPath, std::ios::binary | std::ios::trunc);
+        out << data;
+        contents = data;
+    }
+
+    void patch(size_t offset, const std::string& text) {
+        std::fstream out(dataPath, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(offset));
+        out << text;
+        contents.replace(offset, text.size(), text);
+    }
+
+    std::string run(ChunkIndex& index) {
+        int fd = ::open(dataPath.c_str(), O_RDONLY);
+        EXPECT_GE(fd, 0);
+        index.processFile(fd);
+        ::close(fd);
+        return index.getHash();
+    }
+
+    std::string treeRoot(const std::string& algorithm, size_t leafSize) const {
+        TreeHasher tree(algorithm, leafSize, 2);
+        std::istringstream input(contents);
+        tree.processStream(input);
+        return tree.getHash();
+    }
+
+    std::string dataPath;
+    std::string indexPath;
+    std::string contents;
+};
+
+std::string pattern(size_t length, char seed) {
+    std::string data(length, '\0');
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = static_cast<char>(seed + i * 7);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_F(ChunkIndexTest, RootMatchesTreeMode) {
+    writeFile(pattern(10000, 'a'));
+    ChunkIndex index("SHA256", 1024, indexPath);
+    EXPECT_EQ(run(index), treeRoot("SHA256", 1024));
+    EXPECT_EQ(index.getChunkCount(), 10u);
+    EXPECT_EQ(index.getChangedChunks().size(), 10u);
+}
+
+TEST_F(ChunkIndexTest, UnchangedFileIsNotRead) {
+    writeFile(pattern(5000, 'b'));
+    ChunkIndex index("MD5", 1000, indexPath);
+    std::string first = run(index);
+
+    EXPECT_EQ(run(index), first);
+    EXPECT_EQ(index.getChunksRead(), 0u);
+    EXPECT_TRUE(index.getChangedChunks().empty());
+}
+
+TEST_F(ChunkIndexTest, ReportsModifiedChunks) {
+    writeFile(pattern(8192, 'c'));
+    ChunkIndex index("SHA512", 1024, indexPath);
+    run(index);
+
+    // Let the modification time move on filesystems with coarse timestamps
+    ::usleep(20000);
+    patch(3000, "changed");
+    patch(7000, "again");
+
+    EXPECT_EQ(run(index), treeRoot("SHA512", 1024));
+    ASSERT_EQ(index.getChangedChunks().size(), 2u);
+    EXPECT_EQ(index.getChangedChunks()[0], 2u);
+    EXPECT_EQ(index.getChangedChunks()[1], 6u);
+}
+
+TEST_F(ChunkIndexTest, RestoredMtimeStillDetected) {
+    writeFile(pattern(4096, 'r'));
+    struct stat before;
+    ASSERT_EQ(::stat(dataPath.c_str(), &before), 0);
+    ChunkIndex index("SHA256", 1024, indexPath, 2);
+    run(index);
+
+    // Same size, mtime put back: only the ctime gives the edit away
+    ::usleep(20000);
+    patch(1500, "edit");
+    const struct timespec times[2] = {before.st_atim, before.st_mtim};
+    ASSERT_EQ(::utimensat(AT_FDCWD, dataPath.c_str(), times, 0), 0);
+
+    EXPECT_EQ(run(index), treeRoot("SHA256", 1024));
+    ASSERT_EQ(index.getChangedChunks().size(), 1u);
+    EXPECT_EQ(index.getChangedChunks()[0], 1u);
+}
+
+TEST_F(ChunkIndexTest, ChangedStampRereadsEveryDataChunk) {
+    writeFile(pattern(6000, 'm'));
+    ChunkIndex index("SHA256", 1000, indexPath);
+    run(index);
+
+    // One chunk edited: the block mapping of the others proves nothing, so all are read
+    ::usleep(20000);
+    patch(2500, "x");
+    EXPECT_EQ(run(index), treeRoot("SHA256", 1000));
+    EXPECT_EQ(index.getChunksRead(), 6u);
+    ASSERT_EQ(index.getChangedChunks().size(), 1u);
+    EXPECT_EQ(index.getChangedChunks()[0], 2u);
+}
+
+TEST_F(ChunkIndexTest, GrowingAndShrinkingFile) {
+    writeFile(pattern(3000, 'd'));
+    ChunkIndex index("SHA1", 1024, indexPath);
+    run(index);
+
+    writeFile(pattern(3000, 'd') + "tail");
+    EXPECT_EQ(run(index), treeRoot("SHA1", 1024));
+    ASSERT_EQ(index.getChangedChunks().size(), 1u);
+    EXPECT_EQ(index.getChangedChunks()[0], 2u);
+
+    writeFile("");
+    EXPECT_EQ(run(index), treeRoot("SHA1", 1024));
+    EXPECT_EQ(index.getChunkCount(), 0u);
+}
+
+TEST_F(ChunkIndexTest, SparseHolesAreNotRead) {
+    const size_t chunk = 1 << 20;
+    {
+        std::ofstream out(dataPath, std::ios::binary | std::ios::trunc);
+    }
+    // Data only in the first chunk; the rest of the 8MiB file is a hole
+    patch(0, "header");
+    ASSERT_EQ(::truncate(dataPath.c_str(), 8 * chunk), 0);
+    contents.resize(8 * chunk, '\0');
+
+    ChunkIndex index("SHA256", chunk, indexPath);
+    EXPECT_EQ(run(index), treeRoot("SHA256", chunk));
+    EXPECT_EQ(index.getChunksRead() + index.getHoleChunks(), 8u);
+    // Filesystems without hole reporting read every chunk; the root is the same either way
+    if (index.getHoleChunks() > 0) {
+        EXPECT_EQ(index.getChunksRead(), 1u);
+    }
+}
+
+TEST_F(ChunkIndexTest, ChunkSizeChangeRebuildsIndex) {
+    writeFile(pattern(4096, 'e'));
+    ChunkIndex small("SHA256", 512, indexPath);
+    run(small);
+
+    ChunkIndex large("SHA256", 2048, indexPath);
+    EXPECT_EQ(run(large), treeRoot("SHA256", 2048));
+    EXPECT_EQ(large.getChunksRead(), 2u);
+}
+
+TEST_F(ChunkIndexTest, InvalidArguments) {
+    EXPECT_THROW(ChunkIndex("unknown", 1024, indexPath), std::invalid_argument);
+    EXPECT_THROW(ChunkIndex("SHA256", 0, indexPath), std::invalid_argument);
+    EXPECT_THROW(ChunkIndex("SHA256", 1024, ""), std::invalid_argument);
+
+    ChunkIndex index("SHA256", 1024, indexPath);
+    EXPECT_THROW(index.getHash(), std::runtime_error);
+}
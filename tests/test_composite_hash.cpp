@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "composite_hash.h"
+#include <sstream>
+#include <string>
+
+namespace {
+
+std::string testData() {
+    std::string data;
+    for (int i = 0; i < 10000; ++i) {
+        data += static_cast<char>((i * 7) % 251);
+    }
+    return data;
+}
+
+std::string composite(CompositeHasher::Format format, const std::string& data, size_t partSize, size_t threads = 3) {
+    CompositeHasher hasher(format, partSize, threads);
+    std::istringstream input(data);
+    hasher.processStream(input);
+    return hasher.getHash();
+}
+
+} // namespace
+
+TEST(CompositeHashTest, S3MultipartETag) {
+    EXPECT_EQ(composite(CompositeHasher::Format::S3_ETAG, testData(), 4096),
+              "899c4bf07cce9696eb36b56842d08877-3");
+}
+
+TEST(CompositeHashTest, S3EmptyObjectHasPlainMD5) {
+    EXPECT_EQ(composite(CompositeHasher::Format::S3_ETAG, "", 4096),
+              "d41d8cd98f00b204e9800998ecf8427e");
+}
+
+TEST(CompositeHashTest, DropboxContentHash) {
+    EXPECT_EQ(composite(CompositeHasher::Format::DROPBOX, testData(), 4096),
+              "d3ad6b3c114b89d2c20aeca2aeeadbee22d48f8855c4ae0be4101743dc2404e8");
+    // Empty file content hash is SHA256 of nothing
+    EXPECT_EQ(composite(CompositeHasher::Format::DROPBOX, "", 0),
+              "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(CompositeHashTest, BitTorrentPieces) {
+    CompositeHasher hasher(CompositeHasher::Format::BITTORRENT, 4096, 2);
+    std::istringstream input(testData());
+    hasher.processStream(input);
+    
+    auto parts = hasher.getPartHashes();
+    ASSERT_EQ(parts.size(), 3u);
+    EXPECT_EQ(parts[0], "5088e1f31b47dfafa599881edeb91fc1e0fe1c67");
+    EXPECT_EQ(parts[1], "f72b2a869f4616695b5e7142858f6950751095be");
+    EXPECT_EQ(parts[2], "97b02963ce215c232b325abbf29ab90da22d411d");
+    EXPECT_EQ(hasher.getHash(), parts[0] + parts[1] + parts[2]);
+}
+
+TEST(CompositeHashTest, ResultIndependentOfThreadCount) {
+    std::string data = testData();
+    EXPECT_EQ(composite(CompositeHasher::Format::S3_ETAG, data, 1000, 1),
+              composite(CompositeHasher::Format::S3_ETAG, data, 1000, 8));
+}
+
+TEST(CompositeHashTest, FormatsAndDefaults) {
+    EXPECT_EQ(CompositeHasher::parseFormat("S3-ETag"), CompositeHasher::Format::S3_ETAG);
+    EXPECT_EQ(CompositeHasher::parseFormat("dropbox"), CompositeHasher::Format::DROPBOX);
+    EXPECT_EQ(CompositeHasher::parseFormat("bittorrent"), CompositeHasher::Format::BITTORRENT);
+    EXPECT_THROW(CompositeHasher::parseFormat("zip"), std::invalid_argument);
+    EXPECT_EQ(CompositeHasher::getSupportedFormats().size(), 3u);
+    
+    EXPECT_EQ(CompositeHasher(CompositeHasher::Format::DROPBOX).getPartSize(), 4u * 1024 * 1024);
+    EXPECT_EQ(CompositeHasher(CompositeHasher::Format::S3_ETAG, 1234).getPartSize(), 1234u);
+    
+    CompositeHasher unprocessed(CompositeHasher::Format::S3_ETAG);
+    EXPECT_THROW(unprocessed.getHash(), std::runtime_error);
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include "coprocess.h"
+#include "file_io.h"
+#include "hash_protocol.h"
+#include "test_util.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using TestUtil::digestOf;
+using TestUtil::tempPath;
+using TestUtil::writeFile;
+
+std::string frame(const std::string& message) {
+    std::vector<uint8_t> header;
+    HashProtocol::putU32(header, static_cast<uint32_t>(message.size()));
+    return std::string(header.begin(), header.end()) + message;
+}
+
+// Runs the coprocess with input from a file and returns everything it wrote
+std::string runOn(CoprocessHasher& coprocess, CoprocessHasher::Format format, const std::string& input) {
+    const std::string inPath = tempPath("coprocess_in_");
+    const std::string outPath = tempPath("coprocess_out_");
+    writeFile(inPath, input);
+    const int inFd = ::open(inPath.c_str(), O_RDONLY);
+    const int outFd = ::open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    EXPECT_GE(inFd, 0);
+    EXPECT_GE(outFd, 0);
+    try {
+        coprocess.run(inFd, outFd, format);
+    } catch (...) {
+        ::close(inFd);
+        ::close(outFd);
+        std::remove(inPath.c_str());
+        std::remove(outPath.c_str());
+        throw;
+    }
+    ::close(inFd);
+    ::close(outFd);
+
+    std::vector<uint8_t> output;
+    EXPECT_TRUE(FileIO::readFile(outPath, output));
+    std::remove(inPath.c_str());
+    std::remove(outPath.c_str());
+    return std::string(output.begin(), output.end());
+}
+
+// Reads one framed response; the digest comes back as hex
+std::string readResponse(const std::string& output, size_t& offset) {
+    EXPECT_LE(offset + HashProtocol::RESPONSE_HEADER_SIZE, output.size());
+    const uint8_t* header = reinterpret_cast<const uint8_t*>(output.data() + offset);
+    EXPECT_EQ(header[0], HashProtocol::OK);
+    const size_t length = HashProtocol::getU32(header + 1);
+    offset += HashProtocol::RESPONSE_HEADER_SIZE;
+    const std::string hex = HashBase::toHex(reinterpret_cast<const uint8_t*>(output.data() + offset), length);
+    offset += length;
+    return hex;
+}
+
+} // namespace
+
+TEST(CoprocessTest, PathsAnsweredInOrder) {
+    const std::string a = tempPath("coprocess_a_");
+    const std::string b = tempPath("coprocess_b_");
+    const std::string missing = tempPath("coprocess_missing_");
+    writeFile(a, "hello");
+    writeFile(b, std::string(3 * CoprocessHasher::FILE_BUFFER_SIZE + 17, 'x'));
+
+    // The last path has no trailing newline
+    CoprocessHasher coprocess("SHA256", 1);
+    const std::string output = runOn(coprocess, CoprocessHasher::Format::PATHS, a + "\n" + missing + "\n" + b);
+    EXPECT_EQ(output, digestOf("SHA256", "hello") + "  " + a + "\n" +
+                      "error  " + missing + ": No such file or directory\n" +
+                      digestOf("SHA256", std::string(3 * CoprocessHasher::FILE_BUFFER_SIZE + 17, 'x')) +
+                      "  " + b + "\n");
+    EXPECT_EQ(coprocess.getRequestCount(), 3u);
+
+    std::remove(a.c_str());
+    std::remove(b.c_str());
+}
+
+TEST(CoprocessTest, PathsHashedOnWorkerPool) {
+    std::vector<std::string> paths;
+    std::string input;
+    std::string expected;
+    for (size_t i = 0; i < 40; ++i) {
+        paths.push_back(tempPath("coprocess_pool_" + std::to_string(i) + "_"));
+        const std::string content(i * 1000, static_cast<char>('a' + i % 26));
+        writeFile(paths.back(), content);
+        input += paths.back() + "\n";
+        expected += digestOf("MD5", content) + "  " + paths.back() + "\n";
+    }
+
+    CoprocessHasher coprocess("md5", 4);
+    EXPECT_EQ(runOn(coprocess, CoprocessHasher::Format::PATHS, input), expected);
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+    }
+}
+
+TEST(CoprocessTest, FramesMatchDigests) {
+    const std::vector<std::string> messages = {
+        "",
+        "abc",
+        std::string(1000, 'q'),
+        std::string(CoprocessHasher::INPUT_BUFFER_SIZE * 2 + 5, 'z'),   // Larger than the read window
+        "tail"
+    };
+    std::string input;
+    for (const auto& message : messages) {
+        input += frame(message);
+    }
+
+    CoprocessHasher coprocess("SHA1", 1);
+    const std::string output = runOn(coprocess, CoprocessHasher::Format::FRAMES, input);
+    size_t offset = 0;
+    for (const auto& message : messages) {
+        EXPECT_EQ(readResponse(output, offset), digestOf("SHA1", message));
+    }
+    EXPECT_EQ(offset, output.size());
+    EXPECT_EQ(coprocess.getRequestCount(), messages.size());
+}
+
+TEST(CoprocessTest, MalformedFramesThrow) {
+    CoprocessHasher coprocess("SHA256", 1);
+    EXPECT_THROW(runOn(coprocess, CoprocessHasher::Format::FRAMES, frame("abc").substr(0, 5)), std::runtime_error);
+
+    std::vector<uint8_t> header;
+    HashProtocol::putU32(header, static_cast<uint32_t>(CoprocessHasher::MAX_REQUEST_SIZE + 1));
+    EXPECT_THROW(runOn(coprocess, CoprocessHasher::Format::FRAMES, std::string(header.begin(), header.end())),
+                 std::runtime_error);
+}
+
+TEST(CoprocessTest, PipelinedRequestsShareOneWrite) {
+    std::string input;
+    for (size_t i = 0; i < 500; ++i) {
+        input += frame("message " + std::to_string(i));
+    }
+    CoprocessHasher coprocess("SHA256", 1);
+    const std::string output = runOn(coprocess, CoprocessHasher::Format::FRAMES, input);
+    EXPECT_EQ(coprocess.getRequestCount(), 500u);
+    EXPECT_EQ(coprocess.getFlushCount(), 1u);
+    size_t offset = 0;
+    EXPECT_EQ(readResponse(output, offset), digestOf("SHA256", "message 0"));
+}
+
+TEST(CoprocessTest, WaitingCallerIsAnswered) {
+    int requests[2];
+    int responses[2];
+    ASSERT_EQ(::pipe(requests), 0);
+    ASSERT_EQ(::pipe(responses), 0);
+
+    CoprocessHasher coprocess("SHA256", 1);
+    std::thread worker([&]() { coprocess.run(requests[0], responses[1], CoprocessHasher::Format::FRAMES); });
+
+    // Each request waits for its answer, which only arrives if the coprocess flushes while idle
+    for (size_t i = 0; i < 3; ++i) {
+        const std::string message = "request " + std::to_string(i);
+        const std::string request = frame(message);
+        FileIO::writeAll(requests[1], reinterpret_cast<const uint8_t*>(request.data()), request.size());
+
+        std::string response(HashProtocol::RESPONSE_HEADER_SIZE + 32, '\0');
+        size_t got = 0;
+        while (got < response.size()) {
+            const size_t n = FileIO::readSome(responses[0], reinterpret_cast<uint8_t*>(&response[got]),
+                                              response.size() - got);
+            ASSERT_GT(n, 0u);
+            got += n;
+        }
+        size_t offset = 0;
+        EXPECT_EQ(readResponse(response, offset), digestOf("SHA256", message));
+    }
+
+    ::close(requests[1]);
+    worker.join();
+    EXPECT_EQ(coprocess.getFlushCount(), 3u);
+    ::close(requests[0]);
+    ::close(responses[0]);
+    ::close(responses[1]);
+}
+
+TEST(CoprocessTest, RejectsBadArguments) {
+    EXPECT_THROW(CoprocessHasher("NOPE"), std::invalid_argument);
+    EXPECT_THROW(CoprocessHasher::parseFormat("json"), std::invalid_argument);
+    EXPECT_EQ(CoprocessHasher::parseFormat("FRAMES"), CoprocessHasher::Format::FRAMES);
+}
+
+TEST(CoprocessTest, FilterDropsPaths) {
+    const std::string kept = tempPath("coprocess_kept_");
+    const std::string dropped = tempPath("coprocess_dropped_");
+    const std::string missing = tempPath("coprocess_filter_missing_");
+    writeFile(kept, "keep me");
+    writeFile(dropped, "drop me");
+
+    // Keep only digests whose first byte matches the kept file's
+    const std::string keptDigest = digestOf("SHA256", "keep me");
+    const uint8_t firstByte = static_cast<uint8_t>(std::stoul(keptDigest.substr(0, 2), nullptr, 16));
+    CoprocessHasher coprocess("SHA256", 2);
+    coprocess.setFilter([firstByte](const uint8_t* digest) { return digest[0] == firstByte; });
+    const std::string output =
+        runOn(coprocess, CoprocessHasher::Format::PATHS, kept + "\n" + dropped + "\n" + missing + "\n");
+    EXPECT_EQ(output, keptDigest + "  " + kept + "\n" + "error  " + missing + ": No such file or directory\n");
+    EXPECT_THROW(runOn(coprocess, CoprocessHasher::Format::FRAMES, frame("x")), std::invalid_argument);
+
+    std::remove(kept.c_str());
+    std::remove(dropped.c_str());
+}
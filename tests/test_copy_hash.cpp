@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "copy_hash.h"
+#include "test_util.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using TestUtil::digestOf;
+using TestUtil::patternData;
+
+class CopyHasherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const std::string base = TestUtil::tempPath("copy_hash_");
+        sourcePath = base + ".src";
+        destinationPath = base + ".dst";
+    }
+
+    void TearDown() override {
+        std::remove(sourcePath.c_str());
+        std::remove(destinationPath.c_str());
+    }
+
+    void writeSource(const std::string& data) {
+        TestUtil::writeFile(sourcePath, data);
+    }
+
+    std::string readDestination() {
+        return TestUtil::readFile(destinationPath);
+    }
+
+    std::string sourcePath;
+    std::string destinationPath;
+};
+
+} // namespace
+
+TEST_F(CopyHasherTest, CopiesAndHashes) {
+    // Several full buffers plus an unaligned tail
+    const std::string data = patternData(2 * CopyHasher::BUFFER_SIZE + 12345);
+    writeSource(data);
+    CopyHasher copier("SHA256");
+    copier.copy(sourcePath, destinationPath);
+    EXPECT_EQ(readDestination(), data);
+    EXPECT_EQ(copier.getHash(), digestOf("SHA256", data));
+    EXPECT_EQ(copier.getBytesCopied(), data.size());
+}
+
+TEST_F(CopyHasherTest, ExactBufferMultipleAndEmpty) {
+    const std::string data = patternData(CopyHasher::BUFFER_SIZE);
+    writeSource(data);
+    CopyHasher copier("MD5", false, true);
+    copier.copy(sourcePath, destinationPath);
+    EXPECT_EQ(readDestination(), data);
+    EXPECT_EQ(copier.getHash(), digestOf("MD5", data));
+
+    writeSource("");
+    copier.copy(sourcePath, destinationPath);
+    EXPECT_EQ(readDestination(), "");
+    EXPECT_EQ(copier.getHash(), "d41d8cd98f00b204e9800998ecf8427e");
+}
+
+TEST_F(CopyHasherTest, DirectWithVerify) {
+    // O_DIRECT may be refused by the temp file system; the copy must succeed either way
+    const std::string data = patternData(CopyHasher::BUFFER_SIZE + 4096 * 3 + 17);
+    writeSource(data);
+    CopyHasher copier("SHA512", true, true);
+    copier.copy(sourcePath, destinationPath);
+    EXPECT_EQ(readDestination(), data);
+    EXPECT_EQ(copier.getHash(), digestOf("SHA512", data));
+}
+
+TEST_F(CopyHasherTest, KeepsPermissionBits) {
+    writeSource("abc");
+    ASSERT_EQ(::chmod(sourcePath.c_str(), 0640), 0);
+    CopyHasher copier("SHA1");
+    copier.copy(sourcePath, destinationPath);
+    struct stat info;
+    ASSERT_EQ(::stat(destinationPath.c_str(), &info), 0);
+    EXPECT_EQ(info.st_mode & 0777, 0640u);
+}
+
+TEST_F(CopyHasherTest, Errors) {
+    EXPECT_THROW(CopyHasher("NOPE"), std::invalid_argument);
+    CopyHasher copier("SHA256");
+    EXPECT_THROW(copier.getHash(), std::runtime_error);
+    EXPECT_THROW(copier.copy(sourcePath + ".missing", destinationPath), std::runtime_error);
+    EXPECT_THROW(copier.copy(::testing::TempDir(), destinationPath), std::runtime_error);
+}
+
+TEST_F(CopyHasherTest, RefusesToCopyOntoItself) {
+    const std::string data = patternData(5000);
+    writeSource(data);
+    ASSERT_EQ(::link(sourcePath.c_str(), destinationPath.c_str()), 0);
+
+    CopyHasher copier("SHA256");
+    EXPECT_THROW(copier.copy(sourcePath, sourcePath), std::runtime_error);
+    EXPECT_THROW(copier.copy(sourcePath, destinationPath), std::runtime_error);   // Hard link
+
+    // The source is left intact
+    EXPECT_EQ(TestUtil::readFile(sourcePath), data);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include "digest_index.h"
+#include "test_util.h"
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+using TestUtil::digestBytes;
+using TestUtil::hexOf;
+using TestUtil::tempPath;
+
+TEST(DigestIndexTest, MembersFoundAndOthersRejected) {
+    for (size_t bloomBits : {size_t(0), DigestIndex::DEFAULT_BLOOM_BITS}) {
+        for (const std::string algorithm : {"MD5", "SHA1", "SHA256", "SHA512"}) {
+            std::stringstream list;
+            for (size_t i = 0; i < 5000; ++i) {
+                list << hexOf(digestBytes(algorithm, "member " + std::to_string(i))) << "  file" << i << "\n";
+            }
+            const std::string path = tempPath("digest_index_");
+            EXPECT_EQ(DigestIndex::build(path, algorithm, list, bloomBits), 5000u);
+
+            DigestIndex index(path);
+            EXPECT_EQ(index.getCount(), 5000u);
+            EXPECT_EQ(index.getDigestSize(), HashFactory::createHash(algorithm)->getHashSize());
+            EXPECT_EQ(index.getAlgorithm(), HashFactory::createHash(algorithm)->getAlgorithmName());
+            EXPECT_EQ(index.hasBloomFilter(), bloomBits > 0);
+            for (size_t i = 0; i < 5000; ++i) {
+                ASSERT_TRUE(index.contains(digestBytes(algorithm, "member " + std::to_string(i)).data()))
+                    << algorithm << " " << i;
+                ASSERT_FALSE(index.contains(digestBytes(algorithm, "other " + std::to_string(i)).data()))
+                    << algorithm << " " << i;
+            }
+            std::remove(path.c_str());
+        }
+    }
+}
+
+TEST(DigestIndexTest, ExtremeDigests) {
+    const std::string low(64, '0');
+    const std::string high(64, 'f');
+    std::stringstream list(low + "\n" + high + "\n");
+    const std::string path = tempPath("digest_index_edges_");
+    DigestIndex::build(path, "SHA256", list);
+
+    DigestIndex index(path);
+    std::vector<uint8_t> digest(32, 0x00);
+    EXPECT_TRUE(index.contains(digest.data()));
+    digest.assign(32, 0xff);
+    EXPECT_TRUE(index.contains(digest.data()));
+    digest.assign(32, 0x7f);
+    EXPECT_FALSE(index.contains(digest.data()));
+    digest.assign(32, 0x00);
+    digest[31] = 1;
+    EXPECT_FALSE(index.contains(digest.data()));
+    std::remove(path.c_str());
+}
+
+TEST(DigestIndexTest, InputFormats) {
+    const std::string a = hexOf(digestBytes("SHA1", "a"));
+    const std::string b = hexOf(digestBytes("SHA1", "b"));
+    std::string upper = b;
+    for (auto& c : upper) {
+        c = static_cast<char>(::toupper(c));
+    }
+    std::stringstream list("# known files\n\n" + a + "  a.txt\n\"" + upper + "\",\"B1\",\"b.txt\"\n" + a + "\n");
+    const std::string path = tempPath("digest_index_formats_");
+    EXPECT_EQ(DigestIndex::build(path, "sha1", list), 2u);
+
+    DigestIndex index(path);
+    EXPECT_TRUE(index.contains(digestBytes("SHA1", "a").data()));
+    EXPECT_TRUE(index.contains(digestBytes("SHA1", "b").data()));
+    std::remove(path.c_str());
+}
+
+TEST(DigestIndexTest, EmptyIndex) {
+    std::stringstream list("");
+    const std::string path = tempPath("digest_index_empty_");
+    EXPECT_EQ(DigestIndex::build(path, "MD5", list), 0u);
+    EXPECT_NE(::access((path + ".tmp").c_str(), F_OK), 0);     // Renamed into place
+    DigestIndex index(path);
+    EXPECT_EQ(index.getCount(), 0u);
+    EXPECT_FALSE(index.hasBloomFilter());
+    EXPECT_FALSE(index.contains(digestBytes("MD5", "").data()));
+    std::remove(path.c_str());
+}
+
+TEST(DigestIndexTest, RejectsBadInput) {
+    const std::string path = tempPath("digest_index_bad_");
+    std::stringstream shortDigest("abcd\n");
+    EXPECT_THROW(DigestIndex::build(path, "SHA256", shortDigest), std::runtime_error);
+    std::stringstream notHex(std::string(32, 'z') + "\n");
+    EXPECT_THROW(DigestIndex::build(path, "MD5", notHex), std::runtime_error);
+    std::stringstream empty("");
+    EXPECT_THROW(DigestIndex::build(path, "NOPE", empty), std::invalid_argument);
+
+    EXPECT_THROW(DigestIndex(tempPath("digest_index_missing_")), std::runtime_error);
+
+    // A truncated index is refused rather than read past its end
+    std::stringstream list(hexOf(digestBytes("SHA256", "x")) + "\n");
+    DigestIndex::build(path, "SHA256", list);
+    const std::string contents = TestUtil::readFile(path);
+    TestUtil::writeFile(path, contents.substr(0, contents.size() - 1));
+    EXPECT_THROW(DigestIndex index(path), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "dir_digest.h"
+#include "hash_protocol.h"
+#include "test_util.h"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using TestUtil::hexOf;
+using TestUtil::ScratchTree;
+
+std::vector<uint8_t> digestOf(const std::string& data) {
+    return TestUtil::digestBytes("SHA256", data);
+}
+
+// One directory entry in the documented encoding
+std::string record(char type, uint32_t mode, uint64_t size, const std::string& name, const std::vector<uint8_t>& digest) {
+    std::vector<uint8_t> out(1, static_cast<uint8_t>(type));
+    HashProtocol::putU32(out, mode);
+    HashProtocol::putU32(out, static_cast<uint32_t>(size >> 32));
+    HashProtocol::putU32(out, static_cast<uint32_t>(size));
+    HashProtocol::putU32(out, static_cast<uint32_t>(name.size()));
+    out.insert(out.end(), name.begin(), name.end());
+    out.insert(out.end(), digest.begin(), digest.end());
+    return std::string(out.begin(), out.end());
+}
+
+} // namespace
+
+TEST(DirectoryDigestTest, MatchesDocumentedEncoding) {
+    ScratchTree tree("dir_digest_encoding_");
+    tree.write("b.txt", "bravo");
+    tree.write("a.sh", "#!/bin/sh\n", 0755);
+    tree.makeDirectory("sub", 0700);
+    tree.write("sub/inner", "");
+    tree.symlink("b.txt", "link");
+
+    const std::vector<uint8_t> sub = digestOf(record('f', 0644, 0, "inner", digestOf("")));
+    const std::string expected = record('f', 0755, 10, "a.sh", digestOf("#!/bin/sh\n")) +
+                                 record('f', 0644, 5, "b.txt", digestOf("bravo")) +
+                                 record('l', 0777, 5, "link", digestOf("b.txt")) +
+                                 record('d', 0700, 0, "sub", sub);
+
+    DirectoryDigest digest("SHA256", 2);
+    EXPECT_EQ(digest.hashTree(tree.root()), hexOf(digestOf(expected)));
+    EXPECT_EQ(digest.getFileCount(), 3u);
+    EXPECT_EQ(digest.getFilesHashed(), 3u);
+    EXPECT_EQ(digest.getBytesRead(), 15u);
+}
+
+TEST(DirectoryDigestTest, DependsOnlyOnNamesModesAndContents) {
+    ScratchTree first("dir_digest_first_");
+    first.makeDirectory("x");
+    first.write("x/one", "1");
+    first.write("two", std::string(3 * DirectoryDigest::READ_BUFFER_SIZE + 1, 't'));
+    first.write("x/three", "3");
+
+    // Same tree, created in another order
+    ScratchTree second("dir_digest_second_");
+    second.write("x_", "placeholder");
+    std::remove((second.root() + "/x_").c_str());
+    second.write("two", std::string(3 * DirectoryDigest::READ_BUFFER_SIZE + 1, 't'));
+    second.makeDirectory("x");
+    second.write("x/three", "3");
+    second.write("x/one", "1");
+
+    DirectoryDigest digest("SHA256", 4);
+    const std::string original = digest.hashTree(first.root());
+    EXPECT_EQ(digest.hashTree(second.root()), original);
+
+    second.write("x/one", "!");
+    const std::string changedContent = digest.hashTree(second.root());
+    EXPECT_NE(changedContent, original);
+
+    second.write("x/one", "1", 0600);
+    const std::string changedMode = digest.hashTree(second.root());
+    EXPECT_NE(changedMode, original);
+    EXPECT_NE(changedMode, changedContent);
+
+    second.write("x/one", "1");
+    EXPECT_EQ(digest.hashTree(second.root()), original);
+}
+
+TEST(DirectoryDigestTest, CacheReusesUnchangedSubtrees) {
+    ScratchTree tree("dir_digest_cache_");
+    tree.makeDirectory("kept");
+    tree.write("kept/a", "alpha");
+    tree.write("kept/b", "beta");
+    tree.makeDirectory("edited");
+    tree.write("edited/c", "gamma");
+    tree.write("edited/d", "delta");
+    const std::string cachePath = TestUtil::tempPath("dir_digest_cache_file_");
+
+    // Only entries older than the settle window are stored
+    DirectoryDigest cold("SHA256", 2, cachePath);
+    const std::string fresh = cold.hashTree(tree.root());
+    EXPECT_EQ(cold.hashTree(tree.root()), fresh);
+    EXPECT_EQ(cold.getFilesHashed(), 4u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000 * (DirectoryDigest::CACHE_SETTLE_SECONDS + 1) + 100));
+
+    DirectoryDigest cached("SHA256", 2, cachePath);
+    EXPECT_EQ(cached.hashTree(tree.root()), fresh);
+    EXPECT_EQ(cached.getFilesHashed(), 4u);
+    EXPECT_EQ(cached.hashTree(tree.root()), fresh);
+    EXPECT_EQ(cached.getFilesHashed(), 0u);
+    EXPECT_EQ(cached.getDirectoriesReused(), 1u);  // The root covers everything
+
+    tree.write("edited/c", "GAMMA");
+    DirectoryDigest uncached("SHA256", 2);
+    const std::string expected = uncached.hashTree(tree.root());
+    EXPECT_NE(expected, fresh);
+    EXPECT_EQ(cached.hashTree(tree.root()), expected);
+    EXPECT_EQ(cached.getFilesHashed(), 1u);
+    EXPECT_EQ(cached.getDirectoriesReused(), 1u);  // kept/
+    EXPECT_EQ(cached.getFileCount(), 4u);
+
+    std::remove(cachePath.c_str());
+}
+
+TEST(DirectoryDigestTest, RejectsBadArguments) {
+    EXPECT_THROW(DirectoryDigest("NOPE"), std::invalid_argument);
+    DirectoryDigest digest("SHA1");
+    EXPECT_THROW(digest.hashTree(TestUtil::tempPath("dir_digest_missing_")), std::runtime_error);
+}
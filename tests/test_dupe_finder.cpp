@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "dupe_finder.h"
+#include "hash_base.h"
+#include "test_util.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using TestUtil::digestOf;
+using TestUtil::patternData;
+using TestUtil::ScratchTree;
+
+TEST(DuplicateFinderTest, StagesReadOnlyWhatTheyMust) {
+    ScratchTree tree("dupe_finder_");
+    tree.makeDirectory("a");
+    tree.makeDirectory("a/deep");
+    tree.makeDirectory("b");
+
+    const size_t large = 100000;
+    const std::string content = patternData(large, 1);
+    std::string middleDiffers = content;
+    middleDiffers[large / 2] ^= 1;
+    std::string headDiffers = content;
+    headDiffers[0] ^= 1;
+
+    const std::string x = tree.write("a/x", content);
+    const std::string y = tree.write("b/y", content);
+    const std::string z = tree.write("a/deep/z", content);
+    tree.write("a/middle", middleDiffers);                  // Sample collides, full hash differs
+    tree.write("b/head", headDiffers);                      // Sample differs
+    tree.write("unique", patternData(3 * large, 2));        // Unique size: never opened
+    const std::string small1 = tree.write("small1", "tiny duplicate");
+    const std::string small2 = tree.write("b/small2", "tiny duplicate");
+    tree.write("empty1", "");
+    tree.write("empty2", "");
+    tree.symlink(x, "symlink");
+    const std::string hardlink = tree.link(y, "hardlink");
+
+    DuplicateFinder finder("SHA256", 3);
+    const std::vector<DuplicateGroup> groups = finder.find(tree.root());
+    ASSERT_EQ(groups.size(), 2u);
+
+    EXPECT_EQ(groups[0].size, large);
+    EXPECT_EQ(HashBase::toHex(groups[0].digest.data(), groups[0].digest.size()), digestOf("SHA256", content));
+    // Whichever name of the hard-linked file is met first stands for it
+    const std::vector<std::string>& paths = groups[0].paths;
+    EXPECT_EQ(paths.size(), 3u);
+    EXPECT_NE(std::find(paths.begin(), paths.end(), x), paths.end());
+    EXPECT_NE(std::find(paths.begin(), paths.end(), z), paths.end());
+    EXPECT_NE(std::find(paths.begin(), paths.end(), y) == paths.end(),
+              std::find(paths.begin(), paths.end(), hardlink) == paths.end());
+    EXPECT_EQ(groups[1].paths, (std::vector<std::string>{tree.root() + "/b/small2", tree.root() + "/small1"}));
+    EXPECT_EQ(HashBase::toHex(groups[1].digest.data(), groups[1].digest.size()),
+              digestOf("SHA256", "tiny duplicate"));
+
+    // Five same-size samples, two small files whole, then four full reads
+    const uint64_t sampled = 5 * 2 * DuplicateFinder::SAMPLE_SIZE + 2 * 14;
+    EXPECT_EQ(finder.getBytesRead(), sampled + 4 * large);
+    EXPECT_EQ(finder.getFilesScanned(), 8u);
+    EXPECT_EQ(finder.getBytesScanned(), 5 * large + 3 * large + 2 * 14);
+    EXPECT_TRUE(finder.getErrors().empty());
+}
+
+TEST(DuplicateFinderTest, NoDuplicates) {
+    ScratchTree tree("dupe_finder_");
+    tree.write("one", patternData(5000, 1));
+    tree.write("two", patternData(5000, 2));
+    DuplicateFinder finder("MD5");
+    EXPECT_TRUE(finder.find(tree.root()).empty());
+    EXPECT_EQ(finder.getBytesRead(), 10000u);
+}
+
+TEST(DuplicateFinderTest, RejectsBadArguments) {
+    EXPECT_THROW(DuplicateFinder("NOPE"), std::invalid_argument);
+    DuplicateFinder finder("SHA1");
+    EXPECT_THROW(finder.find(TestUtil::tempPath("dupe_finder_missing_")),
+                 std::runtime_error);
+}
@@ -38,6 +38,27 @@ TEST_F(HashTest, HashFactory_CreateSHA1) {
     EXPECT_EQ(hasher->getHashSize(), 20);
 }
 
+TEST_F(HashTest, HashFactory_CreateSHA2Variants) {
+    const struct { const char* name; size_t blockSize; size_t hashSize; } variants[] = {
+        {"SHA224", 64, 28},
+        {"SHA384", 128, 48},
+        {"SHA512/224", 128, 28},
+        {"SHA512/256", 128, 32}
+    };
+    
+    for (const auto& variant : variants) {
+        EXPECT_TRUE(HashFactory::isSupported(variant.name));
+        auto hasher = HashFactory::createHash(variant.name);
+        ASSERT_NE(hasher, nullptr);
+        EXPECT_EQ(hasher->getAlgorithmName(), variant.name);
+        EXPECT_EQ(hasher->getBlockSize(), variant.blockSize);
+        EXPECT_EQ(hasher->getHashSize(), variant.hashSize);
+        
+        hasher->finalize();
+        EXPECT_EQ(hasher->getHash().length(), variant.hashSize * 2);
+    }
+}
+
 TEST_F(HashTest, HashFactory_UnsupportedAlgorithm) {
     EXPECT_THROW(HashFactory::createHash("UNKNOWN"), std::invalid_argument);
 }
@@ -190,3 +211,100 @@ TEST_F(HashTest, BinaryData) {
     processor2.processStream(input2);
     EXPECT_EQ(processor2.getHash(), hash);
 }
+
+// Test record mode
+namespace {
+
+std::string digestLine(const std::string& algorithm, const std::string& record) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(reinterpret_cast<const uint8_t*>(record.data()), record.size());
+    hasher->finalize();
+    return hasher->getHash() + "\n";
+}
+
+std::string hashRecords(const std::string& algorithm, const std::string& data,
+                        StreamProcessor::RecordFormat format) {
+    StreamProcessor processor(HashFactory::createHash(algorithm));
+    std::istringstream input(data);
+    std::ostringstream output;
+    processor.processRecords(input, format, output);
+    return output.str();
+}
+
+std::string frame(const std::string& payload) {
+    const uint32_t length = static_cast<uint32_t>(payload.size());
+    std::string header;
+    header += static_cast<char>(length >> 24);
+    header += static_cast<char>(length >> 16);
+    header += static_cast<char>(length >> 8);
+    header += static_cast<char>(length);
+    return header + payload;
+}
+
+} // namespace
+
+TEST_F(HashTest, Records_Lines) {
+    const std::string expected = digestLine("SHA256", "abc") + digestLine("SHA256", "") +
+                                 digestLine("SHA256", "last");
+    EXPECT_EQ(hashRecords("SHA256", "abc\n\nlast\n", StreamProcessor::RecordFormat::LINES), expected);
+    // The final record does not need its delimiter
+    EXPECT_EQ(hashRecords("SHA256", "abc\n\nlast", StreamProcessor::RecordFormat::LINES), expected);
+    EXPECT_EQ(hashRecords("SHA256", "", StreamProcessor::RecordFormat::LINES), "");
+}
+
+TEST_F(HashTest, Records_Nul) {
+    const std::string data("one\0two\nlines\0", 14);
+    EXPECT_EQ(hashRecords("MD5", data, StreamProcessor::RecordFormat::NUL),
+              digestLine("MD5", "one") + digestLine("MD5", "two\nlines"));
+}
+
+TEST_F(HashTest, Records_LengthPrefixed) {
+    const std::string data = frame("abc") + frame("") + frame(std::string(1000, 'x'));
+    EXPECT_EQ(hashRecords("SHA512", data, StreamProcessor::RecordFormat::U32BE_LENGTH),
+              digestLine("SHA512", "abc") + digestLine("SHA512", "") +
+              digestLine("SHA512", std::string(1000, 'x')));
+
+    EXPECT_THROW(hashRecords("SHA512", frame("abc").substr(0, 5), StreamProcessor::RecordFormat::U32BE_LENGTH),
+                 std::runtime_error);
+}
+
+TEST_F(HashTest, Records_KeyedHasher) {
+    const uint8_t key[] = {'k', 'e', 'y'};
+    auto keyed = [&](const std::string& record) {
+        auto hmac = HashFactory::createHMAC("SHA256", key, sizeof(key));
+        hmac->update(reinterpret_cast<const uint8_t*>(record.data()), record.size());
+        hmac->finalize();
+        return hmac->getHash() + "\n";
+    };
+
+    StreamProcessor processor(HashFactory::createHMAC("SHA256", key, sizeof(key)));
+    std::istringstream input("abc\n\nlast\n");
+    std::ostringstream output;
+    processor.processRecords(input, StreamProcessor::RecordFormat::LINES, output);
+    EXPECT_EQ(output.str(), keyed("abc") + keyed("") + keyed("last"));
+    EXPECT_NE(output.str(), hashRecords("SHA256", "abc\n\nlast\n", StreamProcessor::RecordFormat::LINES));
+}
+
+TEST_F(HashTest, Records_SpanReadWindows) {
+    // Enough records to cross several batches and window refills, plus one
+    // record larger than the initial window
+    std::string data;
+    std::string expected;
+    for (int i = 0; i < 3000; ++i) {
+        std::string record(1000 + i % 700, static_cast<char>('a' + i % 26));
+        data += record + "\n";
+        expected += digestLine("SHA1", record);
+    }
+    std::string large(5 * 1024 * 1024, 'z');
+    data += large + "\n";
+    expected += digestLine("SHA1", large);
+
+    EXPECT_EQ(hashRecords("SHA1", data, StreamProcessor::RecordFormat::LINES), expected);
+}
+
+TEST_F(HashTest, Records_ParseFormat) {
+    EXPECT_EQ(StreamProcessor::parseRecordFormat("lines"), StreamProcessor::RecordFormat::LINES);
+    EXPECT_EQ(StreamProcessor::parseRecordFormat("NUL"), StreamProcessor::RecordFormat::NUL);
+    EXPECT_EQ(StreamProcessor::parseRecordFormat("u32be-length"), StreamProcessor::RecordFormat::U32BE_LENGTH);
+    EXPECT_THROW(StreamProcessor::parseRecordFormat("csv"), std::invalid_argument);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "hash_arena.h"
+#include "hash_factory.h"
+#include "hash_base.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> makeMessage(size_t seed, size_t length) {
+    std::vector<uint8_t> message(length);
+    for (size_t i = 0; i < length; ++i) {
+        message[i] = static_cast<uint8_t>(seed * 13 + i * 7);
+    }
+    return message;
+}
+
+std::string referenceHash(const std::string& algorithm, const std::vector<uint8_t>& message) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(message.data(), message.size());
+    hasher->finalize();
+    return hasher->getHash();
+}
+
+std::string finalizeHex(HashArena& arena, HashArena::Context* context) {
+    std::vector<uint8_t> digest(arena.getHashSize());
+    arena.finalize(context, digest.data());
+    return HashBase::toHex(digest.data(), digest.size());
+}
+
+} // namespace
+
+TEST(HashArenaTest, KnownVectors) {
+    const std::string abc = "abc";
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(abc.data());
+
+    HashArena md5("MD5");
+    auto context = md5.acquire();
+    md5.update(context, data, abc.size());
+    EXPECT_EQ(finalizeHex(md5, context), "900150983cd24fb0d6963f7d28e17f72");
+
+    HashArena sha1("SHA1");
+    context = sha1.acquire();
+    sha1.update(context, data, abc.size());
+    EXPECT_EQ(finalizeHex(sha1, context), "a9993e364706816aba3e25717850c26c9cd0d89d");
+}
+
+TEST(HashArenaTest, MatchesReferenceForAllAlgorithms) {
+    for (const auto& algorithm : HashFactory::getSupportedAlgorithms()) {
+        HashArena arena(algorithm, 4);
+        std::vector<HashArena::Context*> contexts;
+        std::vector<std::vector<uint8_t>> messages;
+        for (size_t i = 0; i < 10; ++i) {
+            contexts.push_back(arena.acquire());
+            messages.push_back(makeMessage(i, i * 53 + 1));
+        }
+
+        // Single update per context; split updates are covered below
+        for (size_t i = 0; i < contexts.size(); ++i) {
+            arena.update(contexts[i], messages[i].data(), messages[i].size());
+            EXPECT_EQ(finalizeHex(arena, contexts[i]), referenceHash(algorithm, messages[i]))
+                << algorithm << " message " << i;
+        }
+    }
+}
+
+TEST(HashArenaTest, SplitUpdatesAndReuse) {
+    for (const std::string algorithm : {"MD5", "SHA1", "SHA256", "SHA384", "SHA512"}) {
+        HashArena arena(algorithm);
+        auto context = arena.acquire();
+        for (size_t length : {0, 55, 56, 64, 111, 112, 128, 1000}) {
+            auto message = makeMessage(length, length);
+            size_t offset = 0;
+            for (size_t step = 1; offset < message.size(); step += 17) {
+                size_t chunk = std::min(step, message.size() - offset);
+                arena.update(context, message.data() + offset, chunk);
+                offset += chunk;
+            }
+            // finalize() resets the context, so it hashes the next message from scratch
+            EXPECT_EQ(finalizeHex(arena, context), referenceHash(algorithm, message))
+                << algorithm << " length " << length;
+        }
+    }
+}
+
+TEST(HashArenaTest, CompactCacheAlignedContexts) {
+    HashArena md5("MD5");
+    HashArena sha256("SHA256");
+    HashArena sha512("SHA512");
+    EXPECT_EQ(md5.getContextSize(), 128u);
+    EXPECT_EQ(sha256.getContextSize(), 128u);
+    EXPECT_EQ(sha512.getContextSize(), 256u);
+
+    auto first = sha256.acquire();
+    auto second = sha256.acquire();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % HashArena::CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ(reinterpret_cast<uint8_t*>(second) - reinterpret_cast<uint8_t*>(first), 128);
+}
+
+TEST(HashArenaTest, FreeListReuse) {
+    HashArena arena("SHA256", 2);
+    auto a = arena.acquire();
+    auto b = arena.acquire();
+    EXPECT_EQ(arena.getCapacity(), 2u);
+    EXPECT_EQ(arena.getLiveCount(), 2u);
+
+    arena.release(a);
+    EXPECT_EQ(arena.getLiveCount(), 1u);
+    auto c = arena.acquire();
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(arena.getCapacity(), 2u);
+
+    // A reused context starts from the initial state
+    EXPECT_EQ(finalizeHex(arena, c), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+
+    arena.acquire();
+    EXPECT_EQ(arena.getCapacity(), 4u);
+    arena.release(b);
+}
+
+TEST(HashArenaTest, InvalidArguments) {
+    EXPECT_THROW(HashArena("unknown"), std::invalid_argument);
+    EXPECT_THROW(HashArena("SHA256", 0), std::invalid_argument);
+
+    HashArena arena("SHA256");
+    uint8_t digest[32];
+    EXPECT_THROW(arena.release(nullptr), std::invalid_argument);
+    EXPECT_THROW(arena.finalize(nullptr, digest), std::invalid_argument);
+}
@@ -0,0 +1,404 @@
+#include <gtest/gtest.h>
+#include "hash_server.h"
+#include "hash_client.h"
+#include "hash_factory.h"
+#include "hash_protocol.h"
+#include "hash_ring.h"
+#include "file_io.h"
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+std::vector<uint8_t> digestOf(const std::string& algorithm, const std::string& data) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    hasher->finalize();
+    std::vector<uint8_t> digest(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return digest;
+}
+
+const uint8_t* bytes(const std::string& text) {
+    return reinterpret_cast<const uint8_t*>(text.data());
+}
+
+int connectTo(const std::string& path) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_GE(fd, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    EXPECT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    return fd;
+}
+
+void sendRequest(int fd, uint8_t opcode, uint32_t stream, const std::string& payload) {
+    std::vector<uint8_t> frame(1, opcode);
+    HashProtocol::putU32(frame, stream);
+    HashProtocol::putU32(frame, static_cast<uint32_t>(payload.size()));
+    frame.insert(frame.end(), payload.begin(), payload.end());
+    FileIO::writeAll(fd, frame.data(), frame.size());
+}
+
+bool readExactly(int fd, uint8_t* data, size_t length) {
+    for (size_t read = 0; read < length;) {
+        const size_t n = FileIO::readSome(fd, data + read, length - read);
+        if (n == 0) {
+            return false;
+        }
+        read += n;
+    }
+    return true;
+}
+
+// Status byte and payload of the next response
+std::pair<uint8_t, std::vector<uint8_t>> receiveResponse(int fd) {
+    uint8_t header[HashProtocol::RESPONSE_HEADER_SIZE] = {HashProtocol::ERROR};
+    if (!readExactly(fd, header, sizeof(header))) {
+        ADD_FAILURE() << "Connection closed before the response";
+        return std::make_pair(header[0], std::vector<uint8_t>());
+    }
+    std::vector<uint8_t> payload(HashProtocol::getU32(header + 1));
+    EXPECT_TRUE(readExactly(fd, payload.data(), payload.size()));
+    return std::make_pair(header[0], payload);
+}
+
+class HashServerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        socketPath = ::testing::TempDir() + "hash_server_" + std::to_string(::getpid()) + ".sock";
+        server.reset(new HashServer(socketPath, 4));
+        loop = std::thread([this]() { server->run(); });
+    }
+
+    void TearDown() override {
+        server->stop();
+        loop.join();
+        server.reset();
+        EXPECT_NE(::access(socketPath.c_str(), F_OK), 0);
+    }
+
+    std::string socketPath;
+    std::unique_ptr<HashServer> server;
+    std::thread loop;
+};
+
+} // namespace
+
+TEST_F(HashServerTest, OneShotHash) {
+    HashClient client(socketPath);
+    EXPECT_EQ(client.hash("SHA256", bytes("abc"), 3), digestOf("SHA256", "abc"));
+    EXPECT_EQ(client.hash("md5", nullptr, 0), digestOf("MD5", ""));
+    EXPECT_EQ(client.hash("BLAKE512", bytes("abc"), 3), digestOf("BLAKE512", "abc"));
+}
+
+TEST_F(HashServerTest, StreamsAreIndependentAndReused) {
+    HashClient client(socketPath);
+    const std::string text = "The quick brown fox jumps over the lazy dog";
+
+    const uint32_t a = client.open("SHA512");
+    const uint32_t b = client.open("SHA1");
+    EXPECT_NE(a, b);
+    for (size_t i = 0; i < text.size(); i += 5) {
+        const size_t length = std::min<size_t>(5, text.size() - i);
+        client.update(a, bytes(text) + i, length);
+        client.update(b, bytes(text) + i, length);
+    }
+    EXPECT_EQ(client.finalize(a), digestOf("SHA512", text));
+    EXPECT_EQ(client.finalize(b), digestOf("SHA1", text));
+
+    // The finalized hasher is reset before it serves the next stream
+    const uint32_t c = client.open("sha512");
+    client.update(c, bytes("abc"), 3);
+    EXPECT_EQ(client.finalize(c), digestOf("SHA512", "abc"));
+}
+
+TEST_F(HashServerTest, BatchRequest) {
+    HashClient client(socketPath);
+    std::vector<std::string> messages;
+    for (int i = 0; i < 300; ++i) {
+        messages.push_back(std::string(static_cast<size_t>(i), static_cast<char>('a' + i % 26)));
+    }
+    std::vector<HashSpan> spans;
+    for (const auto& message : messages) {
+        spans.push_back(HashSpan{bytes(message), message.size()});
+    }
+    auto digests = client.hashBatch("SHA256", spans.data(), spans.size());
+    ASSERT_EQ(digests.size(), messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(digests[i], digestOf("SHA256", messages[i])) << i;
+    }
+}
+
+TEST_F(HashServerTest, ConcurrentClients) {
+    std::vector<std::thread> clients;
+    std::vector<int> failures(8, 0);
+    for (int c = 0; c < 8; ++c) {
+        clients.emplace_back([&, c]() {
+            HashClient client(socketPath);
+            for (int r = 0; r < 200; ++r) {
+                const std::string message = std::to_string(c) + ":" + std::to_string(r);
+                if (r % 2 == 0) {
+                    if (client.hash("SHA256", bytes(message), message.size()) != digestOf("SHA256", message)) {
+                        ++failures[c];
+                    }
+                } else {
+                    const uint32_t stream = client.open("SHA256");
+                    client.update(stream, bytes(message), message.size());
+                    if (client.finalize(stream) != digestOf("SHA256", message)) {
+                        ++failures[c];
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : clients) {
+        thread.join();
+    }
+    for (int c = 0; c < 8; ++c) {
+        EXPECT_EQ(failures[c], 0) << "client " << c;
+    }
+}
+
+TEST_F(HashServerTest, ErrorsKeepTheConnectionUsable) {
+    HashClient client(socketPath);
+    EXPECT_THROW(client.open("NOPE"), std::runtime_error);
+    EXPECT_THROW(client.hash("NOPE", bytes("x"), 1), std::runtime_error);
+    EXPECT_THROW(client.finalize(12345), std::runtime_error);
+
+    // A pipelined update to an unknown stream surfaces on the next call
+    client.update(999, bytes("x"), 1);
+    EXPECT_THROW(client.hash("SHA1", bytes("x"), 1), std::runtime_error);
+
+    EXPECT_EQ(client.hash("SHA1", bytes("abc"), 3), digestOf("SHA1", "abc"));
+}
+
+TEST_F(HashServerTest, OversizedFrameClosesConnection) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+    std::vector<uint8_t> header;
+    header.push_back(HashProtocol::UPDATE);
+    HashProtocol::putU32(header, 1);
+    HashProtocol::putU32(header, HashProtocol::MAX_PAYLOAD_SIZE + 1);
+    FileIO::writeAll(fd, header.data(), header.size());
+
+    uint8_t byte;
+    EXPECT_EQ(FileIO::readSome(fd, &byte, 1), 0u);
+    ::close(fd);
+
+    // Other clients are unaffected
+    HashClient client(socketPath);
+    EXPECT_EQ(client.hash("MD5", bytes("abc"), 3), digestOf("MD5", "abc"));
+}
+
+TEST_F(HashServerTest, RingRoundTrip) {
+    HashClient client(socketPath);
+    client.attachRing(64, 1 << 16);
+    ASSERT_NE(client.getRingData(), nullptr);
+    EXPECT_EQ(client.getRingDataSize(), 1u << 16);
+
+    std::vector<std::string> messages;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < 40; ++i) {
+        messages.push_back(std::string(i * 37, static_cast<char>('a' + i % 26)));
+        std::memcpy(client.getRingData() + offset, messages.back().data(), messages.back().size());
+        ASSERT_TRUE(client.submit(i % 2 ? "sha256" : "MD5", offset, messages.back().size(), i));
+        offset += messages.back().size();
+    }
+    EXPECT_EQ(client.enter(), 40u);
+
+    HashRing::Completion completion;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        ASSERT_TRUE(client.reap(completion));
+        ASSERT_EQ(completion.userData, i);
+        EXPECT_EQ(completion.status, 0);
+        const std::vector<uint8_t> expected = digestOf(i % 2 ? "SHA256" : "MD5", messages[i]);
+        EXPECT_EQ(std::vector<uint8_t>(completion.digest, completion.digest + completion.digestLength), expected);
+    }
+    EXPECT_FALSE(client.reap(completion));
+
+    // Socket requests still work alongside the ring
+    EXPECT_EQ(client.hash("SHA1", bytes("abc"), 3), digestOf("SHA1", "abc"));
+}
+
+TEST_F(HashServerTest, RingBackpressure) {
+    HashClient client(socketPath);
+    client.attachRing(4, 4096);
+    std::memcpy(client.getRingData(), "abc", 3);
+
+    for (uint64_t i = 0; i < 4; ++i) {
+        ASSERT_TRUE(client.submit("SHA1", 0, 3, i));
+    }
+    EXPECT_FALSE(client.submit("SHA1", 0, 3, 4));
+    EXPECT_EQ(client.enter(), 4u);
+
+    // With the completion ring full the daemon leaves new submissions queued
+    for (uint64_t i = 4; i < 8; ++i) {
+        ASSERT_TRUE(client.submit("SHA1", 0, 3, i));
+    }
+    EXPECT_EQ(client.enter(), 0u);
+
+    HashRing::Completion completion;
+    ASSERT_TRUE(client.reap(completion));
+    ASSERT_TRUE(client.reap(completion));
+    EXPECT_EQ(client.enter(), 2u);
+
+    std::vector<uint64_t> seen;
+    while (client.reap(completion)) {
+        EXPECT_EQ(completion.status, 0);
+        seen.push_back(completion.userData);
+    }
+    EXPECT_EQ(seen, (std::vector<uint64_t>{2, 3, 4, 5}));
+    EXPECT_EQ(client.enter(), 2u);
+}
+
+TEST_F(HashServerTest, RingRejectsInvalidSubmissions) {
+    HashClient client(socketPath);
+    EXPECT_THROW(client.enter(), std::runtime_error);
+    EXPECT_THROW(client.attachRing(3, 4096), std::invalid_argument);
+
+    client.attachRing(8, 4096);
+    ASSERT_TRUE(client.submit("SHA256", 4000, 200, 1));
+    ASSERT_TRUE(client.submit("NOPE", 0, 1, 2));
+    ASSERT_TRUE(client.submit("SHA256", ~0ull, 2, 3));
+    ASSERT_TRUE(client.submit("SHA256", 4096, 0, 4));
+    EXPECT_EQ(client.enter(), 4u);
+
+    HashRing::Completion completion;
+    for (int32_t status : {-1, -1, -1, 0}) {
+        ASSERT_TRUE(client.reap(completion));
+        EXPECT_EQ(completion.status, status) << completion.userData;
+    }
+    EXPECT_EQ(std::vector<uint8_t>(completion.digest, completion.digest + completion.digestLength),
+              digestOf("SHA256", ""));
+}
+
+TEST_F(HashServerTest, AttachRequiresSealedDescriptor) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+    std::vector<uint8_t> header;
+    header.push_back(HashProtocol::ATTACH);
+    HashProtocol::putU32(header, 0);
+    HashProtocol::putU32(header, 0);
+    auto expectError = [fd]() {
+        uint8_t response[HashProtocol::RESPONSE_HEADER_SIZE];
+        size_t total = 0;
+        while (total < sizeof(response)) {
+            const size_t got = FileIO::readSome(fd, response + total, sizeof(response) - total);
+            ASSERT_GT(got, 0u);
+            total += got;
+        }
+        EXPECT_EQ(response[0], HashProtocol::ERROR);
+        std::vector<uint8_t> message(HashProtocol::getU32(response + 1));
+        for (size_t read = 0; read < message.size();) {
+            read += FileIO::readSome(fd, message.data() + read, message.size() - read);
+        }
+    };
+
+    // No descriptor at all
+    FileIO::writeAll(fd, header.data(), header.size());
+    expectError();
+
+    // A descriptor that is not a sealed memory file
+    const int unsealed = ::memfd_create("unsealed", MFD_CLOEXEC);
+    ASSERT_GE(unsealed, 0);
+    ASSERT_EQ(::ftruncate(unsealed, 1 << 16), 0);
+    iovec vector = {header.data(), header.size()};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message = {};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* rights = CMSG_FIRSTHDR(&message);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(rights), &unsealed, sizeof(int));
+    ASSERT_EQ(::sendmsg(fd, &message, 0), static_cast<ssize_t>(header.size()));
+    ::close(unsealed);
+    expectError();
+    ::close(fd);
+}
+
+TEST_F(HashServerTest, HalfClosedClientReceivesEveryResponse) {
+    const int fd = connectTo(socketPath);
+    ASSERT_GE(fd, 0);
+
+    // Far more response bytes than the socket buffers hold, then EOF
+    const size_t requests = 20000;
+    const std::string payload = std::string(1, '\6') + "sha512" + "x";
+    for (size_t i = 0; i < requests; ++i) {
+        sendRequest(fd, HashProtocol::HASH, 0, payload);
+    }
+    ASSERT_EQ(::shutdown(fd, SHUT_WR), 0);
+
+    const std::vector<uint8_t> expected = digestOf("SHA512", "x");
+    for (size_t i = 0; i < requests; ++i) {
+        const auto response = receiveResponse(fd);
+        ASSERT_EQ(response.first, HashProtocol::OK) << i;
+        ASSERT_EQ(response.second, expected) << i;
+    }
+    uint8_t byte;
+    EXPECT_EQ(FileIO::readSome(fd, &byte, 1), 0u);
+    ::close(fd);
+}
+
+TEST_F(HashServerTest, LongRequestsDoNotStallOtherClients) {
+    const int fd = connectTo(socketPath);
+    ASSERT_GE(fd, 0);
+    sendRequest(fd, HashProtocol::OPEN, 0, "sha512");
+    const auto opened = receiveResponse(fd);
+    ASSERT_EQ(opened.first, HashProtocol::OK);
+    const uint32_t stream = HashProtocol::getU32(opened.second.data());
+
+    // Hundreds of megabytes on one stream, then its digest
+    const std::string block(32 * 1024 * 1024, 'b');
+    const size_t blocks = 8;
+    std::thread writer([&]() {
+        for (size_t i = 0; i < blocks; ++i) {
+            sendRequest(fd, HashProtocol::UPDATE, stream, block);
+        }
+        sendRequest(fd, HashProtocol::FINALIZE, stream, "");
+    });
+
+    // Another client is served while that stream is being hashed
+    HashClient other(socketPath);
+    for (int i = 0; i < 20; ++i) {
+        const std::string message = std::to_string(i);
+        EXPECT_EQ(other.hash("SHA256", bytes(message), message.size()), digestOf("SHA256", message));
+    }
+    for (size_t i = 0; i < blocks; ++i) {
+        EXPECT_EQ(receiveResponse(fd).first, HashProtocol::OK);
+    }
+    auto hasher = HashFactory::createHash("SHA512");
+    for (size_t i = 0; i < blocks; ++i) {
+        hasher->update(bytes(block), block.size());
+    }
+    hasher->finalize();
+    std::vector<uint8_t> expected(hasher->getHashSize());
+    hasher->getDigest(expected.data());
+    EXPECT_EQ(receiveResponse(fd).second, expected);
+    writer.join();
+    ::close(fd);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "hash_factory.h"
+#include "prefix_cache.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> makeMessage(size_t seed, size_t length) {
+    std::vector<uint8_t> message(length);
+    for (size_t i = 0; i < length; ++i) {
+        message[i] = static_cast<uint8_t>(seed + i * 11);
+    }
+    return message;
+}
+
+std::string finish(HashInterface& hasher) {
+    hasher.finalize();
+    return hasher.getHash();
+}
+
+std::string oneShot(const std::string& algorithm, const std::vector<uint8_t>& message) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(message.data(), message.size());
+    return finish(*hasher);
+}
+
+} // namespace
+
+TEST(HashStateTest, CloneForksInProgressState) {
+    auto message = makeMessage(1, 300);
+    for (const auto& algorithm : HashFactory::getSupportedAlgorithms()) {
+        auto original = HashFactory::createHash(algorithm);
+        original->update(message.data(), 150);
+
+        auto copy = original->clone();
+        EXPECT_EQ(copy->getAlgorithmName(), original->getAlgorithmName());
+        copy->update(message.data() + 150, 150);
+        original->update(message.data() + 150, 150);
+
+        EXPECT_EQ(finish(*copy), finish(*original)) << algorithm;
+    }
+}
+
+TEST(HashStateTest, ExportImportRoundTrip) {
+    auto message = makeMessage(2, 500);
+    for (const auto& algorithm : HashFactory::getSupportedAlgorithms()) {
+        // Split points cover empty, partial-block and block-aligned states
+        for (size_t split : {0, 1, 64, 100, 128, 250}) {
+            auto source = HashFactory::createHash(algorithm);
+            source->update(message.data(), split);
+            std::vector<uint8_t> state = source->exportState();
+
+            auto restored = HashFactory::createHash(algorithm);
+            restored->update(message.data(), 7);   // Overwritten by the import
+            restored->importState(state.data(), state.size());
+            restored->update(message.data() + split, message.size() - split);
+            source->update(message.data() + split, message.size() - split);
+
+            EXPECT_EQ(finish(*restored), finish(*source)) << algorithm << " split " << split;
+        }
+    }
+}
+
+TEST(HashStateTest, StateIsStable) {
+    const std::string abc = "abc";
+    auto hasher = HashFactory::createHash("SHA256");
+    hasher->update(reinterpret_cast<const uint8_t*>(abc.data()), abc.size());
+    std::vector<uint8_t> state = hasher->exportState();
+
+    // Header, finalized flag, length, buffered tail, then eight chaining words
+    const size_t expectedSize = 4 + 1 + 1 + 6 + 1 + 8 + 4 + 3 + 8 * 4;
+    ASSERT_EQ(state.size(), expectedSize);
+    EXPECT_EQ(std::string(state.begin(), state.begin() + 4), "HGST");
+    EXPECT_EQ(std::string(state.begin() + 6, state.begin() + 12), "SHA256");
+    EXPECT_EQ(state[12], 0);    // Not finalized
+    EXPECT_EQ(state[20], 3);    // Total length
+    EXPECT_EQ(state[24], 3);    // Buffered length
+    EXPECT_EQ(std::string(state.begin() + 25, state.begin() + 28), "abc");
+    EXPECT_EQ(state[28], 0x6a); // SHA256 IV word 0, no block compressed yet
+}
+
+TEST(HashStateTest, FinalizedStateKeepsDigest) {
+    auto message = makeMessage(3, 40);
+    auto hasher = HashFactory::createHash("BLAKE512");
+    hasher->update(message.data(), message.size());
+    hasher->finalize();
+    std::vector<uint8_t> state = hasher->exportState();
+
+    auto restored = HashFactory::createHash("BLAKE512");
+    restored->importState(state.data(), state.size());
+    EXPECT_TRUE(restored->isFinalized());
+    EXPECT_EQ(restored->getHash(), hasher->getHash());
+}
+
+TEST(HashStateTest, HMACStateRoundTrip) {
+    const std::string key = "key";
+    auto message = makeMessage(4, 200);
+    auto mac = HashFactory::createHMAC("SHA512", reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    mac->update(message.data(), 77);
+    std::vector<uint8_t> state = mac->exportState();
+
+    auto other = HashFactory::createHMAC("SHA512", nullptr, 0);
+    other->importState(state.data(), state.size());
+    other->update(message.data() + 77, message.size() - 77);
+    auto copy = mac->clone();
+    copy->update(message.data() + 77, message.size() - 77);
+    mac->update(message.data() + 77, message.size() - 77);
+
+    std::string expected = finish(*mac);
+    EXPECT_EQ(finish(*other), expected);
+    EXPECT_EQ(finish(*copy), expected);
+}
+
+TEST(HashStateTest, RejectsInvalidStates) {
+    auto sha256 = HashFactory::createHash("SHA256");
+    std::vector<uint8_t> state = sha256->exportState();
+
+    auto sha224 = HashFactory::createHash("SHA224");
+    EXPECT_THROW(sha224->importState(state.data(), state.size()), std::invalid_argument);
+
+    auto target = HashFactory::createHash("SHA256");
+    EXPECT_THROW(target->importState(state.data(), state.size() - 1), std::invalid_argument);
+    state.push_back(0);
+    EXPECT_THROW(target->importState(state.data(), state.size()), std::invalid_argument);
+    state.pop_back();
+    state[0] = 'X';
+    EXPECT_THROW(target->importState(state.data(), state.size()), std::invalid_argument);
+    EXPECT_THROW(target->importState(nullptr, 10), std::invalid_argument);
+
+    // A failed import leaves a freshly reset hasher
+    EXPECT_EQ(finish(*target), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(PrefixStateCacheTest, ForksMatchFullHash) {
+    PrefixStateCache cache;
+    auto prefix = makeMessage(5, 1000);
+    for (size_t i = 0; i < 3; ++i) {
+        auto suffix = makeMessage(10 + i, 50 * i);
+        auto hasher = cache.fork("SHA256", prefix.data(), prefix.size());
+        hasher->update(suffix.data(), suffix.size());
+
+        std::vector<uint8_t> full(prefix);
+        full.insert(full.end(), suffix.begin(), suffix.end());
+        EXPECT_EQ(finish(*hasher), oneShot("SHA256", full));
+    }
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(PrefixStateCacheTest, KeyedByAlgorithmAndEvictsLeastRecentlyUsed) {
+    PrefixStateCache cache(2);
+    auto a = makeMessage(6, 10);
+    auto b = makeMessage(7, 10);
+
+    cache.fork("SHA256", a.data(), a.size());
+    cache.fork("MD5", a.data(), a.size());
+    EXPECT_EQ(cache.size(), 2u);
+
+    cache.fork("SHA256", a.data(), a.size());   // Refresh, MD5 is now least recent
+    cache.fork("SHA256", b.data(), b.size());   // Evicts MD5
+    EXPECT_EQ(cache.size(), 2u);
+
+    auto md5 = cache.fork("MD5", a.data(), a.size());
+    EXPECT_EQ(finish(*md5), oneShot("MD5", a));
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_THROW(PrefixStateCache(0), std::invalid_argument);
+    EXPECT_THROW(cache.fork("unknown", a.data(), a.size()), std::invalid_argument);
+}
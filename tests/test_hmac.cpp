@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include "hmac.h"
+#include "hash_factory.h"
+#include "md5.h"
+#include "sha1.h"
+#include "sha256.h"
+#include "sha512.h"
+#include "blake256.h"
+#include "blake512.h"
+#include "stream_processor.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+// Reference HMAC built from two plain hash passes, used to cross-check the midstate path
+template <typename H>
+std::string referenceHMAC(const std::string& key, const std::string& message) {
+    H probe;
+    std::string keyBlock = key;
+    if (keyBlock.size() > probe.getBlockSize()) {
+        H keyHasher;
+        keyHasher.update(bytes(keyBlock), keyBlock.size());
+        keyHasher.finalize();
+        std::vector<uint8_t> digest(keyHasher.getHashSize());
+        keyHasher.getDigest(digest.data());
+        keyBlock.assign(digest.begin(), digest.end());
+    }
+    keyBlock.resize(probe.getBlockSize(), '\0');
+
+    std::string ipad = keyBlock, opad = keyBlock;
+    for (size_t i = 0; i < keyBlock.size(); ++i) {
+        ipad[i] = static_cast<char>(keyBlock[i] ^ 0x36);
+        opad[i] = static_cast<char>(keyBlock[i] ^ 0x5c);
+    }
+
+    H inner;
+    std::string innerInput = ipad + message;
+    inner.update(bytes(innerInput), innerInput.size());
+    inner.finalize();
+    std::vector<uint8_t> innerDigest(inner.getHashSize());
+    inner.getDigest(innerDigest.data());
+
+    H outer;
+    std::string outerInput = opad + std::string(innerDigest.begin(), innerDigest.end());
+    outer.update(bytes(outerInput), outerInput.size());
+    outer.finalize();
+    return outer.getHash();
+}
+
+} // namespace
+
+class HMACTest : public ::testing::Test {
+protected:
+    const std::string fox = "The quick brown fox jumps over the lazy dog";
+};
+
+TEST_F(HMACTest, MD5_KnownVector) {
+    HMAC<MD5> hmac(bytes("key"), 3);
+    hmac.update(bytes(fox), fox.size());
+    hmac.finalize();
+    EXPECT_EQ(hmac.getHash(), "80070713463e7749b90c2dc24911e275");
+    EXPECT_EQ(hmac.getAlgorithmName(), "HMAC-MD5");
+}
+
+TEST_F(HMACTest, SHA1_KnownVector) {
+    HMAC<SHA1> hmac(bytes("key"), 3);
+    hmac.update(bytes(fox), fox.size());
+    hmac.finalize();
+    EXPECT_EQ(hmac.getHash(), "de7c9b85b8b78aa6bc8a7a36f70a90701c9db4d9");
+}
+
+// RFC 4231 test case 1
+TEST_F(HMACTest, SHA256_RFC4231_Case1) {
+    std::string key(20, '\x0b');
+    HMAC<SHA256> hmac(bytes(key), key.size());
+    hmac.update(bytes("Hi There"), 8);
+    hmac.finalize();
+    EXPECT_EQ(hmac.getHash(), "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7");
+}
+
+TEST_F(HMACTest, SHA512_RFC4231_Case1) {
+    std::string key(20, '\x0b');
+    HMAC<SHA512> hmac(bytes(key), key.size());
+    hmac.update(bytes("Hi There"), 8);
+    hmac.finalize();
+    EXPECT_EQ(hmac.getHash(), "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cdedaa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854");
+}
+
+// RFC 4231 test case 2 (short key)
+TEST_F(HMACTest, SHA224_RFC4231_Case2) {
+    std::string message = "what do ya want for nothing?";
+    HMAC<SHA224> hmac(bytes("Jefe"), 4);
+    hmac.update(bytes(message), message.size());
+    hmac.finalize();
+    EXPECT_EQ(hmac.getHash(), "a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44");
+}
+
+// RFC 4231 test case 6 (key longer than the block size is hashed first)
+TEST_F(HMACTest, LongKeyIsHashed) {
+    std::string key(131, '\xaa');
+    std::string message = "Test Using Larger Than Block-Size Key - Hash Key First";
+    
+    HMAC<SHA256> hmac256(bytes(key), key.size());
+    hmac256.update(bytes(message), message.size());
+    hmac256.finalize();
+    EXPECT_EQ(hmac256.getHash(), "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54");
+    
+    HMAC<SHA384> hmac384(bytes(key), key.size());
+    hmac384.update(bytes(message), message.size());
+    hmac384.finalize();
+    EXPECT_EQ(hmac384.getHash(), "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c60c2ef6ab4030fe8296248df163f44952");
+}
+
+TEST_F(HMACTest, BLAKE_MatchesReferenceConstruction) {
+    HMAC<BLAKE256> hmac256(bytes("secret"), 6);
+    hmac256.update(bytes(fox), fox.size());
+    hmac256.finalize();
+    EXPECT_EQ(hmac256.getHash(), referenceHMAC<BLAKE256>("secret", fox));
+    
+    HMAC<BLAKE512> hmac512(bytes("secret"), 6);
+    hmac512.update(bytes(fox), fox.size());
+    hmac512.finalize();
+    EXPECT_EQ(hmac512.getHash(), referenceHMAC<BLAKE512>("secret", fox));
+}
+
+TEST_F(HMACTest, ResetReusesKeyMidstates) {
+    HMAC<SHA256> hmac(bytes("key"), 3);
+    hmac.update(bytes("first message"), 13);
+    hmac.finalize();
+    EXPECT_TRUE(hmac.isFinalized());
+    
+    hmac.reset();
+    EXPECT_FALSE(hmac.isFinalized());
+    hmac.update(bytes(fox), fox.size());
+    hmac.finalize();
+    EXPECT_EQ(hmac.getHash(), referenceHMAC<SHA256>("key", fox));
+}
+
+TEST_F(HMACTest, BatchMatchesOneShot) {
+    HMAC<SHA256> hmac(bytes("batch-key"), 9);
+    
+    std::vector<std::string> messages;
+    for (int i = 0; i < 20; ++i) {
+        messages.push_back(std::string(static_cast<size_t>(i * 13), static_cast<char>('a' + i)));
+    }
+    std::vector<const uint8_t*> pointers;
+    std::vector<size_t> lengths;
+    for (const auto& message : messages) {
+        pointers.push_back(bytes(message));
+        lengths.push_back(message.size());
+    }
+    
+    std::vector<uint8_t> digests(messages.size() * hmac.getHashSize());
+    hmac.computeBatch(pointers.data(), lengths.data(), messages.size(), digests.data());
+    
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(HashBase::toHex(digests.data() + i * hmac.getHashSize(), hmac.getHashSize()),
+                  referenceHMAC<SHA256>("batch-key", messages[i]));
+    }
+}
+
+namespace {
+
+// Lengths around one and two blocks exercise one- and two-block padding in every lane
+template <typename H>
+void expectBatchMatchesReference() {
+    const std::string key(200, 'k');   // Longer than a SHA-256 block, so it is hashed first
+    HMAC<H> hmac(bytes(key), key.size());
+    std::vector<std::string> messages;
+    for (size_t length : {0, 1, 55, 56, 63, 64, 65, 111, 112, 127, 128, 129, 300, 1000}) {
+        messages.push_back(std::string(length, static_cast<char>('a' + length % 26)));
+    }
+    std::vector<const uint8_t*> pointers;
+    std::vector<size_t> lengths;
+    for (const auto& message : messages) {
+        pointers.push_back(bytes(message));
+        lengths.push_back(message.size());
+    }
+
+    std::vector<uint8_t> digests(messages.size() * hmac.getHashSize());
+    hmac.computeBatch(pointers.data(), lengths.data(), messages.size(), digests.data());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        EXPECT_EQ(HashBase::toHex(digests.data() + i * hmac.getHashSize(), hmac.getHashSize()),
+                  referenceHMAC<H>(key, messages[i])) << hmac.getAlgorithmName() << " length " << lengths[i];
+    }
+}
+
+} // namespace
+
+TEST_F(HMACTest, BatchLanesMatchReference) {
+    expectBatchMatchesReference<SHA224>();
+    expectBatchMatchesReference<SHA256>();
+    expectBatchMatchesReference<SHA384>();
+    expectBatchMatchesReference<SHA512>();
+    expectBatchMatchesReference<SHA512_256>();
+    expectBatchMatchesReference<MD5>();      // Generic fallback
+}
+
+TEST_F(HMACTest, FactoryCreatesEveryAlgorithm) {
+    for (const auto& algorithm : HashFactory::getSupportedAlgorithms()) {
+        auto hmac = HashFactory::createHMAC(algorithm, bytes("key"), 3);
+        ASSERT_NE(hmac, nullptr);
+        EXPECT_EQ(hmac->getAlgorithmName(), "HMAC-" + algorithm);
+        
+        StreamProcessor processor(std::move(hmac));
+        std::istringstream input(fox);
+        processor.processStream(input);
+        EXPECT_FALSE(processor.getHash().empty());
+    }
+    
+    EXPECT_THROW(HashFactory::createHMAC("UNKNOWN", bytes("key"), 3), std::invalid_argument);
+}
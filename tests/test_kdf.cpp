@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "kdf.h"
+#include "hash_base.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+const uint8_t* bytes(const std::string& s) {
+    return reinterpret_cast<const uint8_t*>(s.data());
+}
+
+std::string pbkdf2Hex(const std::string& algorithm, const std::string& password,
+                      const std::string& salt, uint32_t iterations, size_t length) {
+    std::vector<uint8_t> key(length);
+    PBKDF2::derive(algorithm, bytes(password), password.size(), bytes(salt), salt.size(),
+                   iterations, key.data(), key.size());
+    return HashBase::toHex(key.data(), key.size());
+}
+
+std::vector<uint8_t> fromHex(const std::string& hex) {
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return out;
+}
+
+} // namespace
+
+TEST(PBKDF2Test, SHA256_KnownVectors) {
+    EXPECT_EQ(pbkdf2Hex("sha256", "password", "salt", 1, 32),
+              "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b");
+    EXPECT_EQ(pbkdf2Hex("sha256", "password", "salt", 4096, 32),
+              "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a");
+}
+
+TEST(PBKDF2Test, SHA256_MultipleOutputBlocks) {
+    // 40 bytes spans two output blocks, which run in separate lanes
+    EXPECT_EQ(pbkdf2Hex("SHA256", "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 40),
+              "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c4e2a1fb8dd53e1c635518c7dac47e9");
+}
+
+TEST(PBKDF2Test, SHA512Family) {
+    EXPECT_EQ(pbkdf2Hex("sha512", "password", "salt", 2, 64),
+              "e1d9c16aa681708a45f5c7c4e215ceb66e011a2e9f0040713f18aefdb866d53cf76cab2868a39b9f7840edce4fef5a82be67335c77a6068e04112754f27ccf4e");
+    EXPECT_EQ(pbkdf2Hex("sha384", "password", "salt", 100, 100),
+              "fd59f4c5847bbcf1ca33174a7d63ae50c5adeef45d94a36f730b13ebe352ae801b7e6bca0e71eb404026da914f0e689e28c163d7419002d0e22400aa87190eba5f068223ad00fde5b686a4b22b281af4906c27bea657d6a4325b58abd6ebca2a1286f2e3");
+}
+
+TEST(PBKDF2Test, TruncatedVariantWithLongPassword) {
+    // Password longer than the block size is hashed before use as the HMAC key
+    EXPECT_EQ(pbkdf2Hex("sha224", std::string(100, 'x'), "salt", 50, 70),
+              "56b4362a3e055cbd58268b66fcfa0b6f8d1ce0472330f53ecf20b2d5ec6c260491f27a516f8cdd59dfd2e918bf62be0b42fac66a842aedd116e76c9344f11fd60b03de7956ca");
+}
+
+TEST(PBKDF2Test, GenericPathForOtherAlgorithms) {
+    EXPECT_EQ(pbkdf2Hex("sha1", "password", "salt", 2, 20),
+              "ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957");
+}
+
+TEST(PBKDF2Test, BatchMatchesIndividualDerivation) {
+    std::vector<std::string> passwords, salts;
+    for (int i = 0; i < 11; ++i) {
+        passwords.push_back("password-" + std::to_string(i));
+        salts.push_back("salt-" + std::to_string(i * 7));
+    }
+    
+    std::vector<PBKDF2Input> inputs;
+    for (size_t i = 0; i < passwords.size(); ++i) {
+        PBKDF2Input input = {bytes(passwords[i]), passwords[i].size(), bytes(salts[i]), salts[i].size()};
+        inputs.push_back(input);
+    }
+    
+    for (const char* algorithm : {"sha256", "sha512", "md5"}) {
+        const size_t length = 48;
+        std::vector<uint8_t> keys(inputs.size() * length);
+        PBKDF2::deriveBatch(algorithm, inputs.data(), inputs.size(), 25, keys.data(), length);
+        
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            EXPECT_EQ(HashBase::toHex(keys.data() + i * length, length),
+                      pbkdf2Hex(algorithm, passwords[i], salts[i], 25, length))
+                << algorithm << " input " << i;
+        }
+    }
+}
+
+TEST(PBKDF2Test, InvalidParameters) {
+    uint8_t key[32];
+    EXPECT_THROW(PBKDF2::derive("sha256", bytes("p"), 1, bytes("s"), 1, 0, key, sizeof(key)), std::invalid_argument);
+    EXPECT_THROW(PBKDF2::derive("unknown", bytes("p"), 1, bytes("s"), 1, 1, key, sizeof(key)), std::invalid_argument);
+}
+
+// RFC 5869 test case 1
+TEST(HKDFTest, SHA256_RFC5869_Case1) {
+    std::vector<uint8_t> ikm(22, 0x0b);
+    std::vector<uint8_t> salt = fromHex("000102030405060708090a0b0c");
+    std::vector<uint8_t> info = fromHex("f0f1f2f3f4f5f6f7f8f9");
+    
+    uint8_t prk[32];
+    HKDF::extract("sha256", salt.data(), salt.size(), ikm.data(), ikm.size(), prk);
+    EXPECT_EQ(HashBase::toHex(prk, sizeof(prk)),
+              "077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5");
+    
+    uint8_t okm[42];
+    HKDF::expand("sha256", prk, sizeof(prk), info.data(), info.size(), okm, sizeof(okm));
+    EXPECT_EQ(HashBase::toHex(okm, sizeof(okm)),
+              "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865");
+}
+
+// RFC 5869 test case 3 (no salt, no info)
+TEST(HKDFTest, SHA256_RFC5869_Case3) {
+    std::vector<uint8_t> ikm(22, 0x0b);
+    uint8_t okm[42];
+    HKDF::derive("sha256", ikm.data(), ikm.size(), nullptr, 0, nullptr, 0, okm, sizeof(okm));
+    EXPECT_EQ(HashBase::toHex(okm, sizeof(okm)),
+              "8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8");
+}
+
+TEST(HKDFTest, OutputLengthLimit) {
+    uint8_t prk[32] = {0};
+    std::vector<uint8_t> okm(255 * 32 + 1);
+    EXPECT_THROW(HKDF::expand("sha256", prk, sizeof(prk), nullptr, 0, okm.data(), okm.size()), std::invalid_argument);
+    EXPECT_NO_THROW(HKDF::expand("sha256", prk, sizeof(prk), nullptr, 0, okm.data(), okm.size() - 1));
+}
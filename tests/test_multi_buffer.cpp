@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "multi_buffer.h"
+#include "sha256.h"
+#include "sha512.h"
+#include <cstring>
+#include <vector>
+
+// Each lane must match an independent scalar compression of its own state and block
+TEST(MultiBufferTest, SHA256LanesMatchScalar) {
+    for (size_t lanes = 1; lanes <= MultiBuffer::SHA256_LANES; ++lanes) {
+        uint32_t states[MultiBuffer::SHA256_LANES][8];
+        uint32_t expected[MultiBuffer::SHA256_LANES][8];
+        std::vector<std::vector<uint8_t>> blocks(lanes, std::vector<uint8_t>(64));
+        const uint8_t* pointers[MultiBuffer::SHA256_LANES];
+        
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            for (size_t i = 0; i < 64; ++i) {
+                blocks[lane][i] = static_cast<uint8_t>(lane * 31 + i * 7);
+            }
+            for (int j = 0; j < 8; ++j) {
+                states[lane][j] = static_cast<uint32_t>(0x01234567u * (lane + 1) + j);
+            }
+            std::memcpy(expected[lane], states[lane], sizeof(states[lane]));
+            SHA256::compress(expected[lane], blocks[lane].data());
+            pointers[lane] = blocks[lane].data();
+        }
+        
+        MultiBuffer::sha256Compress(states, pointers, lanes);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            EXPECT_EQ(0, std::memcmp(states[lane], expected[lane], sizeof(states[lane]))) << "lanes=" << lanes;
+        }
+    }
+}
+
+TEST(MultiBufferTest, SHA512LanesMatchScalar) {
+    for (size_t lanes = 1; lanes <= MultiBuffer::SHA512_LANES; ++lanes) {
+        uint64_t states[MultiBuffer::SHA512_LANES][8];
+        uint64_t expected[MultiBuffer::SHA512_LANES][8];
+        std::vector<std::vector<uint8_t>> blocks(lanes, std::vector<uint8_t>(128));
+        const uint8_t* pointers[MultiBuffer::SHA512_LANES];
+        
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            for (size_t i = 0; i < 128; ++i) {
+                blocks[lane][i] = static_cast<uint8_t>(lane * 13 + i * 3);
+            }
+            for (int j = 0; j < 8; ++j) {
+                states[lane][j] = 0x0123456789abcdefULL * (lane + 1) + j;
+            }
+            std::memcpy(expected[lane], states[lane], sizeof(states[lane]));
+            SHA512::compress(expected[lane], blocks[lane].data());
+            pointers[lane] = blocks[lane].data();
+        }
+        
+        MultiBuffer::sha512Compress(states, pointers, lanes);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            EXPECT_EQ(0, std::memcmp(states[lane], expected[lane], sizeof(states[lane]))) << "lanes=" << lanes;
+        }
+    }
+}
+
+TEST(MultiBufferTest, RejectsInvalidLaneCount) {
+    uint32_t states[MultiBuffer::SHA256_LANES][8] = {};
+    const uint8_t* pointers[MultiBuffer::SHA256_LANES] = {};
+    EXPECT_THROW(MultiBuffer::sha256Compress(states, pointers, 0), std::invalid_argument);
+    EXPECT_THROW(MultiBuffer::sha256Compress(states, pointers, MultiBuffer::SHA256_LANES + 1), std::invalid_argument);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "multi_input.h"
+#include "file_io.h"
+#include "hash_base.h"
+#include "test_util.h"
+#include <cstdio>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using TestUtil::digestOf;
+using TestUtil::patternData;
+using TestUtil::tempPath;
+
+// Writes data to fd in small pieces, then closes it
+void feed(int fd, const std::string& data) {
+    const size_t piece = 4093;
+    for (size_t offset = 0; offset < data.size(); offset += piece) {
+        const size_t length = std::min(piece, data.size() - offset);
+        FileIO::writeAll(fd, reinterpret_cast<const uint8_t*>(data.data() + offset), length);
+    }
+    ::close(fd);
+}
+
+} // namespace
+
+TEST(MultiInputTest, ManyPipesHashedConcurrently) {
+    for (const std::string algorithm : {"SHA256", "SHA512", "MD5"}) {
+        MultiInputHasher hasher(algorithm, 3);
+        std::vector<std::string> data;
+        std::vector<std::string> names;
+        std::vector<std::thread> writers;
+        for (size_t i = 0; i < 24; ++i) {
+            // Includes an empty input and ones larger than the per-turn quota
+            data.push_back(patternData(i == 0 ? 0 : i * 37 + (i % 5 == 0 ? 3 * MultiInputHasher::READ_QUOTA : 0), i));
+            int pipeFds[2];
+            ASSERT_EQ(::pipe(pipeFds), 0);
+            hasher.addDescriptor(pipeFds[0]);
+            names.push_back("fd:" + std::to_string(pipeFds[0]));
+            writers.emplace_back(feed, pipeFds[1], data.back());
+        }
+        EXPECT_EQ(hasher.getInputCount(), data.size());
+
+        std::map<std::string, InputDigest> results;
+        hasher.run([&results](const InputDigest& input) { results[input.name] = input; });
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        ASSERT_EQ(results.size(), data.size());
+        for (size_t i = 0; i < data.size(); ++i) {
+            const InputDigest& result = results[names[i]];
+            EXPECT_TRUE(result.error.empty()) << result.name;
+            EXPECT_EQ(result.bytes, data[i].size());
+            EXPECT_EQ(HashBase::toHex(result.digest.data(), result.digest.size()), digestOf(algorithm, data[i]))
+                << algorithm << " " << result.name;
+        }
+    }
+}
+
+TEST(MultiInputTest, FifosAndRegularFiles) {
+    const std::string fifo = tempPath("multi_input_fifo_");
+    const std::string file = tempPath("multi_input_file_");
+    ASSERT_EQ(::mkfifo(fifo.c_str(), 0600), 0);
+    const std::string fifoData = patternData(300000, 1);
+    const std::string fileData = patternData(2 * MultiInputHasher::READ_QUOTA + 11, 2);
+    TestUtil::writeFile(file, fileData);
+
+    // The reader opens first, so the FIFO has no writer until this thread connects
+    MultiInputHasher hasher("SHA1", 2);
+    hasher.addPath(fifo);
+    hasher.addPath(file);
+    std::thread writer([&]() {
+        const int fd = ::open(fifo.c_str(), O_WRONLY);
+        ASSERT_GE(fd, 0);
+        feed(fd, fifoData);
+    });
+
+    std::map<std::string, std::string> results;
+    hasher.run([&results](const InputDigest& input) {
+        results[input.name] = HashBase::toHex(input.digest.data(), input.digest.size());
+    });
+    writer.join();
+
+    EXPECT_EQ(results[fifo], digestOf("SHA1", fifoData));
+    EXPECT_EQ(results[file], digestOf("SHA1", fileData));
+    std::remove(fifo.c_str());
+    std::remove(file.c_str());
+}
+
+TEST(MultiInputTest, ReportedInCompletionOrder) {
+    int first[2];
+    int second[2];
+    ASSERT_EQ(::pipe(first), 0);
+    ASSERT_EQ(::pipe(second), 0);
+    MultiInputHasher hasher("SHA256", 2);
+    hasher.addDescriptor(first[0]);
+    hasher.addDescriptor(second[0]);
+
+    // The first input stays open until the second has been reported
+    FileIO::writeAll(first[1], reinterpret_cast<const uint8_t*>("abc"), 3);
+    ::close(second[1]);
+    std::vector<std::string> order;
+    hasher.run([&](const InputDigest& input) {
+        order.push_back(input.name);
+        if (order.size() == 1) {
+            ::close(first[1]);
+        }
+    });
+    EXPECT_EQ(order, (std::vector<std::string>{"fd:" + std::to_string(second[0]), "fd:" + std::to_string(first[0])}));
+}
+
+TEST(MultiInputTest, RejectsBadInputs) {
+    EXPECT_THROW(MultiInputHasher("NOPE"), std::invalid_argument);
+    MultiInputHasher hasher("SHA256");
+    EXPECT_THROW(hasher.addPath(tempPath("multi_input_missing_")), std::runtime_error);
+    EXPECT_THROW(hasher.addDescriptor(-1), std::runtime_error);
+    EXPECT_EQ(hasher.getInputCount(), 0u);
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "rsync_delta.h"
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Deterministic pseudo-random bytes (xorshift)
+std::string randomData(size_t length, uint64_t seed) {
+    std::string data(length, '\0');
+    uint64_t x = seed;
+    for (size_t i = 0; i < length; ++i) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        data[i] = static_cast<char>(x);
+    }
+    return data;
+}
+
+BlockSignature signatureOf(const std::string& basis, size_t blockSize, const std::string& algorithm = "SHA256") {
+    BlockSignature signature(algorithm, blockSize);
+    std::istringstream input(basis);
+    signature.generate(input);
+    return signature;
+}
+
+std::vector<DeltaOp> deltaOf(const BlockSignature& signature, const std::string& data) {
+    DeltaMatcher matcher(signature);
+    std::istringstream input(data);
+    std::vector<DeltaOp> ops;
+    matcher.process(input, [&](const DeltaOp& op) { ops.push_back(op); });
+    return ops;
+}
+
+// Rebuild the new file from the basis and the literal ranges of the new file
+std::string applyDelta(const std::vector<DeltaOp>& ops, const std::string& basis,
+                       const std::string& data, size_t blockSize) {
+    std::string result;
+    for (const auto& op : ops) {
+        EXPECT_EQ(op.offset, result.size());
+        if (op.type == DeltaOp::COPY) {
+            result += basis.substr(op.block * blockSize, op.length);
+        } else {
+            result += data.substr(op.offset, op.length);
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(RollingChecksumTest, RollMatchesInit) {
+    const std::string data = randomData(4096, 1);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data());
+    const size_t window = 517;
+
+    RollingChecksum rolling;
+    rolling.init(bytes, window);
+    for (size_t offset = 1; offset + window <= data.size(); ++offset) {
+        rolling.roll(bytes[offset - 1], bytes[offset + window - 1]);
+        RollingChecksum fresh;
+        fresh.init(bytes + offset, window);
+        ASSERT_EQ(rolling.value(), fresh.value()) << "offset " << offset;
+    }
+}
+
+TEST(RollingChecksumTest, KnownValue) {
+    const uint8_t data[] = {1, 2, 3};
+    RollingChecksum checksum;
+    checksum.init(data, sizeof(data));
+    // a = 6, b = 3*1 + 2*2 + 1*3 = 10
+    EXPECT_EQ(checksum.value(), 6u | (10u << 16));
+}
+
+TEST(BlockSignatureTest, RoundTrip) {
+    const std::string basis = randomData(10000, 2);
+    BlockSignature signature = signatureOf(basis, 1024, "MD5");
+    EXPECT_EQ(signature.getFileLength(), 10000u);
+    ASSERT_EQ(signature.getBlocks().size(), 10u);
+    EXPECT_EQ(signature.blockLength(9), 784u);
+
+    std::stringstream text;
+    signature.write(text);
+    BlockSignature parsed = BlockSignature::read(text);
+    EXPECT_EQ(parsed.getAlgorithm(), "MD5");
+    EXPECT_EQ(parsed.getBlockSize(), 1024u);
+    EXPECT_EQ(parsed.getFileLength(), 10000u);
+    ASSERT_EQ(parsed.getBlocks().size(), signature.getBlocks().size());
+    for (size_t i = 0; i < parsed.getBlocks().size(); ++i) {
+        EXPECT_EQ(parsed.getBlocks()[i].weak, signature.getBlocks()[i].weak);
+        EXPECT_EQ(parsed.getBlocks()[i].strong, signature.getBlocks()[i].strong);
+    }
+}
+
+TEST(BlockSignatureTest, RejectsInvalidInput) {
+    EXPECT_THROW(BlockSignature("NOPE", 1024), std::invalid_argument);
+    EXPECT_THROW(BlockSignature("SHA256", 0), std::invalid_argument);
+
+    std::istringstream badHeader("not-a-signature 1 SHA256 1024 0\n");
+    EXPECT_THROW(BlockSignature::read(badHeader), std::invalid_argument);
+
+    std::istringstream truncated("hashgen-signature 1 SHA256 1024 2048\n0000abcd 00\n");
+    EXPECT_THROW(BlockSignature::read(truncated), std::invalid_argument);
+}
+
+TEST(DeltaMatcherTest, IdenticalFileIsOneCopy) {
+    const std::string basis = randomData(64 * 1024 + 123, 3);
+    auto ops = deltaOf(signatureOf(basis, 2048), basis);
+    ASSERT_EQ(ops.size(), 1u);
+    EXPECT_EQ(ops[0].type, DeltaOp::COPY);
+    EXPECT_EQ(ops[0].offset, 0u);
+    EXPECT_EQ(ops[0].length, basis.size());
+    EXPECT_EQ(ops[0].block, 0u);
+}
+
+TEST(DeltaMatcherTest, InsertionBecomesLiteral) {
+    const size_t blockSize = 1024;
+    const std::string basis = randomData(32 * 1024, 4);
+    const std::string inserted = randomData(100, 5);
+    const std::string data = basis.substr(0, 5000) + inserted + basis.substr(5000);
+
+    BlockSignature signature = signatureOf(basis, blockSize);
+    DeltaMatcher matcher(signature);
+    std::istringstream input(data);
+    std::vector<DeltaOp> ops;
+    matcher.process(input, [&](const DeltaOp& op) { ops.push_back(op); });
+
+    EXPECT_EQ(applyDelta(ops, basis, data, blockSize), data);
+    // Only the block containing the insertion point is lost
+    EXPECT_EQ(matcher.getLiteralBytes(), blockSize + inserted.size());
+    EXPECT_EQ(matcher.getMatchedBytes() + matcher.getLiteralBytes(), data.size());
+}
+
+TEST(DeltaMatcherTest, ShiftedAndReorderedBlocks) {
+    const size_t blockSize = 512;
+    const std::string basis = randomData(8 * blockSize + 200, 6);
+    // Short last block first, then the rest shifted by 7 bytes
+    const std::string data = basis.substr(8 * blockSize) + "1234567" + basis.substr(0, 8 * blockSize);
+
+    auto ops = deltaOf(signatureOf(basis, blockSize), data);
+    EXPECT_EQ(applyDelta(ops, basis, data, blockSize), data);
+    uint64_t copied = 0;
+    for (const auto& op : ops) {
+        if (op.type == DeltaOp::COPY) {
+            copied += op.length;
+        }
+    }
+    // The short tail block only matches at end of input
+    EXPECT_EQ(copied, 8 * blockSize);
+}
+
+TEST(DeltaMatcherTest, ShortLastBlockMatchesAtEnd) {
+    const size_t blockSize = 1000;
+    const std::string basis = randomData(3500, 7);
+    auto ops = deltaOf(signatureOf(basis, blockSize), basis);
+    ASSERT_EQ(ops.size(), 1u);
+    EXPECT_EQ(ops[0].length, 3500u);
+}
+
+TEST(DeltaMatcherTest, EmptyInputs) {
+    EXPECT_TRUE(deltaOf(signatureOf("", 1024), "").empty());
+
+    const std::string data = randomData(3000, 8);
+    auto ops = deltaOf(signatureOf("", 1024), data);
+    ASSERT_EQ(ops.size(), 1u);
+    EXPECT_EQ(ops[0].type, DeltaOp::LITERAL);
+    EXPECT_EQ(ops[0].length, data.size());
+}
+
+TEST(DeltaMatcherTest, RepeatedBlocksKeepRunsConsecutive) {
+    const size_t blockSize = 256;
+    const std::string block = randomData(blockSize, 9);
+    const std::string basis = block + block + block + block;
+    auto ops = deltaOf(signatureOf(basis, blockSize), basis);
+    ASSERT_EQ(ops.size(), 1u);
+    EXPECT_EQ(ops[0].block, 0u);
+    EXPECT_EQ(ops[0].length, basis.size());
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "sampled_fingerprint.h"
+#include "test_util.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using TestUtil::patternData;
+using TestUtil::tempPath;
+using TestUtil::writeFile;
+
+std::string fingerprintOf(SampledFingerprint& sample, const std::string& path, size_t ioSize = 0) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    EXPECT_GE(fd, 0);
+    sample.processFile(fd, ioSize);
+    ::close(fd);
+    return sample.getHash();
+}
+
+} // namespace
+
+TEST(SampledFingerprintTest, SelectsHeadTailAndDistinctChunks) {
+    const std::vector<uint64_t> chunks = SampledFingerprint::selectChunks(1000, 50, 42);
+    ASSERT_EQ(chunks.size(), 50u);
+    EXPECT_EQ(chunks.front(), 0u);
+    EXPECT_EQ(chunks.back(), 999u);
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        EXPECT_LT(chunks[i - 1], chunks[i]);
+    }
+    EXPECT_EQ(SampledFingerprint::selectChunks(1000, 50, 42), chunks);
+    EXPECT_NE(SampledFingerprint::selectChunks(1000, 50, 43), chunks);
+
+    // Small inputs are read whole
+    EXPECT_EQ(SampledFingerprint::selectChunks(3, 50, 42), (std::vector<uint64_t>{0, 1, 2}));
+    EXPECT_TRUE(SampledFingerprint::selectChunks(0, 2, 0).empty());
+}
+
+TEST(SampledFingerprintTest, ReadsOnlyTheSample) {
+    const std::string path = tempPath("sampled_fingerprint_");
+    const std::string data = patternData(1000 * 4096 + 123);
+    writeFile(path, data);
+
+    SampledFingerprint sample("SHA256", 4096, 16, 1, 4);
+    const std::string fingerprint = fingerprintOf(sample, path);
+    EXPECT_EQ(fingerprint.size(), 64u);
+    EXPECT_EQ(sample.getFileSize(), data.size());
+    EXPECT_EQ(sample.getChunkSize(), 4096u);
+    EXPECT_EQ(sample.getChunksRead(), 16u);
+    EXPECT_LE(sample.getBytesRead(), 16 * 3 * sample.getChunkSize());
+    EXPECT_LT(sample.getBytesRead(), data.size() / 10);
+
+    // Same input, same seed: same fingerprint whatever the thread count
+    SampledFingerprint single("SHA256", 4096, 16, 1, 1);
+    EXPECT_EQ(fingerprintOf(single, path), fingerprint);
+    SampledFingerprint reseeded("SHA256", 4096, 16, 2, 4);
+    EXPECT_NE(fingerprintOf(reseeded, path), fingerprint);
+
+    std::remove(path.c_str());
+}
+
+TEST(SampledFingerprintTest, FingerprintDoesNotDependOnIoSize) {
+    const std::string path = tempPath("sampled_fingerprint_io_");
+    const std::string data = patternData(3000 * 1000 + 77);
+    writeFile(path, data);
+
+    SampledFingerprint sample("SHA256", 1000, 64, 5, 3);
+    const std::string fingerprint = fingerprintOf(sample, path, 1);
+    EXPECT_EQ(sample.getChunkSize(), 1000u);
+    EXPECT_GT(sample.getBytesRead(), 63 * 1000u);
+    EXPECT_LE(sample.getBytesRead(), 64 * 1000u);   // The tail may overlap the chunk before it
+    for (size_t ioSize : {512, 4096, 65536, 1 << 20}) {
+        EXPECT_EQ(fingerprintOf(sample, path, ioSize), fingerprint) << ioSize;
+        EXPECT_EQ(sample.getChunkSize(), 1000u);
+        EXPECT_EQ(sample.getChunksRead(), 64u);
+        EXPECT_GT(sample.getBytesRead(), 63 * 1000u);
+    }
+    EXPECT_EQ(fingerprintOf(sample, path), fingerprint);
+
+    // Every chunk of a small input coalesces into one read
+    SampledFingerprint whole("SHA256", 1000, 64, 5, 3);
+    const std::string small = path + "_small";
+    writeFile(small, data.substr(0, 20 * 1000 + 1));
+    EXPECT_EQ(fingerprintOf(whole, small, 1), fingerprintOf(whole, small, 4096));
+    EXPECT_EQ(whole.getBytesRead(), 20 * 1000u + 1);
+
+    std::remove(small.c_str());
+    std::remove(path.c_str());
+}
+
+TEST(SampledFingerprintTest, SeesHeadTailAndSizeChanges) {
+    const std::string path = tempPath("sampled_fingerprint_changes_");
+    const std::string data = patternData(500 * 4096 + 9);
+    writeFile(path, data);
+    SampledFingerprint sample("SHA1", 4096, 8, 0, 2);
+    const std::string original = fingerprintOf(sample, path);
+
+    std::string head = data;
+    head[0] ^= 1;
+    writeFile(path, head);
+    EXPECT_NE(fingerprintOf(sample, path), original);
+
+    std::string tail = data;
+    tail.back() ^= 1;
+    writeFile(path, tail);
+    EXPECT_NE(fingerprintOf(sample, path), original);
+
+    writeFile(path, data + "x");
+    EXPECT_NE(fingerprintOf(sample, path), original);
+
+    writeFile(path, data);
+    EXPECT_EQ(fingerprintOf(sample, path), original);
+    std::remove(path.c_str());
+}
+
+TEST(SampledFingerprintTest, TailCoversTheFinalSampleSize) {
+    const std::string path = tempPath("sampled_fingerprint_tail_");
+    const size_t sampleSize = 4096;
+    const std::string data = patternData(1000 * sampleSize + 1);
+    writeFile(path, data);
+    SampledFingerprint sample("SHA256", sampleSize, 4, 7, 2);
+    const std::string original = fingerprintOf(sample, path);
+
+    // The last chunk is one byte; the edit lies in the chunk before it
+    std::string edited = data;
+    edited[data.size() - sampleSize / 2] ^= 1;
+    writeFile(path, edited);
+    EXPECT_NE(fingerprintOf(sample, path), original);
+
+    std::remove(path.c_str());
+}
+
+TEST(SampledFingerprintTest, RejectsBadArguments) {
+    EXPECT_THROW(SampledFingerprint("NOPE"), std::invalid_argument);
+    EXPECT_THROW(SampledFingerprint("SHA256", 0), std::invalid_argument);
+    EXPECT_THROW(SampledFingerprint("SHA256", 4096, 1), std::invalid_argument);
+
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    SampledFingerprint sample("SHA256");
+    EXPECT_THROW(sample.processFile(fds[0]), std::runtime_error);
+    EXPECT_THROW(sample.getHash(), std::runtime_error);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
@@ -232,3 +232,33 @@ TEST_F(SHA256Test, PaddingEdgeCases) {
     EXPECT_EQ(hash56.length(), 64);
     EXPECT_NE(hash55, hash56);
 }
+
+// SHA224 shares the SHA256 compression function with a distinct IV and truncated output
+TEST_F(SHA256Test, SHA224_KnownVectors) {
+    const struct { const char* input; const char* expected; } vectors[] = {
+        {"", "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f"},
+        {"abc", "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+         "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525"}
+    };
+    
+    for (const auto& vector : vectors) {
+        StreamProcessor processor(std::make_unique<SHA224>());
+        std::istringstream input(vector.input);
+        processor.processStream(input);
+        EXPECT_EQ(processor.getHash(), vector.expected) << "input: " << vector.input;
+    }
+}
+
+TEST_F(SHA256Test, SHA224_AlgorithmProperties) {
+    SHA224 sha224;
+    EXPECT_EQ(sha224.getBlockSize(), 64);
+    EXPECT_EQ(sha224.getHashSize(), 28);
+    EXPECT_EQ(sha224.getAlgorithmName(), "SHA224");
+    
+    // Reset must restore the SHA224 IV, not the SHA256 one
+    sha224.update(reinterpret_cast<const uint8_t*>("test"), 4);
+    sha224.reset();
+    sha224.finalize();
+    EXPECT_EQ(sha224.getHash(), "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f");
+}
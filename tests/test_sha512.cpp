@@ -75,6 +75,48 @@ TEST_F(SHA512Test, ErrorHandling) {
     EXPECT_THROW(sha512.update(reinterpret_cast<const uint8_t*>("test"), 4), std::runtime_error);
 }
 
+// Truncated SHA-2 variants built on the SHA512 compression function
+TEST(SHA512VariantsTest, SHA384) {
+    SHA384 sha384;
+    sha384.finalize();
+    EXPECT_EQ(sha384.getHash(), "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b");
+    
+    sha384.reset();
+    sha384.update(reinterpret_cast<const uint8_t*>("abc"), 3);
+    sha384.finalize();
+    EXPECT_EQ(sha384.getHash(), "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7");
+    EXPECT_EQ(sha384.getHashSize(), 48);
+    EXPECT_EQ(sha384.getAlgorithmName(), "SHA384");
+}
+
+TEST(SHA512VariantsTest, SHA512_224) {
+    SHA512_224 sha512_224;
+    sha512_224.finalize();
+    EXPECT_EQ(sha512_224.getHash(), "6ed0dd02806fa89e25de060c19d3ac86cabb87d6a0ddd05c333b84f4");
+    
+    sha512_224.reset();
+    sha512_224.update(reinterpret_cast<const uint8_t*>("abc"), 3);
+    sha512_224.finalize();
+    EXPECT_EQ(sha512_224.getHash(), "4634270f707b6a54daae7530460842e20e37ed265ceee9a43e8924aa");
+    EXPECT_EQ(sha512_224.getBlockSize(), 128);
+    EXPECT_EQ(sha512_224.getHashSize(), 28);
+    EXPECT_EQ(sha512_224.getAlgorithmName(), "SHA512/224");
+}
+
+TEST(SHA512VariantsTest, SHA512_256) {
+    SHA512_256 sha512_256;
+    sha512_256.finalize();
+    EXPECT_EQ(sha512_256.getHash(), "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a");
+    
+    std::string input = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    sha512_256.reset();
+    sha512_256.update(reinterpret_cast<const uint8_t*>(input.c_str()), input.length());
+    sha512_256.finalize();
+    EXPECT_EQ(sha512_256.getHash(), "bde8e1f9f19bb9fd3406c90ec6bc47bd36d8ada9f11880dbc8a22a7078b6a461");
+    EXPECT_EQ(sha512_256.getHashSize(), 32);
+    EXPECT_EQ(sha512_256.getAlgorithmName(), "SHA512/256");
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include "stream_multiplexer.h"
+#include "hash_factory.h"
+#include "hash_base.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> makeMessage(size_t seed, size_t length) {
+    std::vector<uint8_t> message(length);
+    for (size_t i = 0; i < length; ++i) {
+        message[i] = static_cast<uint8_t>(seed * 31 + i);
+    }
+    return message;
+}
+
+std::string referenceHash(const std::string& algorithm, const std::vector<uint8_t>& message) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(message.data(), message.size());
+    hasher->finalize();
+    return hasher->getHash();
+}
+
+std::string finalizeHex(StreamMultiplexer& mux, StreamMultiplexer::StreamId id) {
+    std::vector<uint8_t> digest(mux.getHashSize());
+    mux.finalize(id, digest.data());
+    return HashBase::toHex(digest.data(), digest.size());
+}
+
+} // namespace
+
+TEST(StreamMultiplexerTest, SingleStream) {
+    StreamMultiplexer mux("SHA256");
+    auto id = mux.open();
+    const std::string abc = "abc";
+    mux.update(id, reinterpret_cast<const uint8_t*>(abc.data()), abc.size());
+    EXPECT_EQ(finalizeHex(mux, id), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(mux.getStreamCount(), 0u);
+}
+
+TEST(StreamMultiplexerTest, InterleavedStreamsMatchReference) {
+    // Lane-kernel algorithms plus the scalar path
+    for (const std::string algorithm : {"SHA256", "SHA224", "SHA512", "SHA384", "SHA512/256", "MD5", "SHA1"}) {
+        StreamMultiplexer mux(algorithm);
+        const size_t streamCount = 21;
+        std::vector<std::vector<uint8_t>> messages;
+        std::vector<StreamMultiplexer::StreamId> ids;
+        for (size_t s = 0; s < streamCount; ++s) {
+            messages.push_back(makeMessage(s, 50 + s * 97));
+            ids.push_back(mux.open());
+        }
+
+        // Feed every stream in uneven chunks, round-robin
+        std::vector<size_t> offsets(streamCount, 0);
+        bool remaining = true;
+        for (size_t round = 0; remaining; ++round) {
+            remaining = false;
+            for (size_t s = 0; s < streamCount; ++s) {
+                size_t chunk = std::min((s + round) % 7 * 23 + 1, messages[s].size() - offsets[s]);
+                mux.update(ids[s], messages[s].data() + offsets[s], chunk);
+                offsets[s] += chunk;
+                remaining = remaining || offsets[s] < messages[s].size();
+            }
+        }
+
+        // Finalize in reverse order, some while others still have queued blocks
+        for (size_t s = streamCount; s-- > 0;) {
+            EXPECT_EQ(finalizeHex(mux, ids[s]), referenceHash(algorithm, messages[s]))
+                << algorithm << " stream " << s;
+        }
+    }
+}
+
+TEST(StreamMultiplexerTest, FlushKeepsStreamsOpen) {
+    StreamMultiplexer mux("SHA512");
+    auto first = mux.open();
+    auto second = mux.open();
+    auto message = makeMessage(3, 1000);
+
+    mux.update(first, message.data(), 500);
+    mux.update(second, message.data(), message.size());
+    mux.flush();
+    mux.update(first, message.data() + 500, 500);
+
+    EXPECT_EQ(mux.getStreamCount(), 2u);
+    EXPECT_EQ(finalizeHex(mux, first), referenceHash("SHA512", message));
+    EXPECT_EQ(finalizeHex(mux, second), referenceHash("SHA512", message));
+}
+
+TEST(StreamMultiplexerTest, LargeSingleUpdate) {
+    StreamMultiplexer mux("SHA256");
+    auto id = mux.open();
+    auto message = makeMessage(9, 100000);
+    mux.update(id, message.data(), message.size());
+    EXPECT_EQ(finalizeHex(mux, id), referenceHash("SHA256", message));
+}
+
+TEST(StreamMultiplexerTest, ConcurrentUpdates) {
+    StreamMultiplexer mux("SHA256");
+    const size_t threadCount = 4;
+    const size_t streamsPerThread = 16;
+    std::vector<std::vector<std::string>> results(threadCount);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&mux, &results, t]() {
+            std::vector<StreamMultiplexer::StreamId> ids;
+            std::vector<std::vector<uint8_t>> messages;
+            for (size_t s = 0; s < streamsPerThread; ++s) {
+                ids.push_back(mux.open());
+                messages.push_back(makeMessage(t * 100 + s, 3000));
+            }
+            for (size_t offset = 0; offset < 3000; offset += 100) {
+                for (size_t s = 0; s < streamsPerThread; ++s) {
+                    mux.update(ids[s], messages[s].data() + offset, 100);
+                }
+            }
+            for (size_t s = 0; s < streamsPerThread; ++s) {
+                results[t].push_back(finalizeHex(mux, ids[s]));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t t = 0; t < threadCount; ++t) {
+        for (size_t s = 0; s < streamsPerThread; ++s) {
+            EXPECT_EQ(results[t][s], referenceHash("SHA256", makeMessage(t * 100 + s, 3000)));
+        }
+    }
+}
+
+TEST(StreamMultiplexerTest, ConcurrentLargeUpdatesAndFinalize) {
+    // One stream per thread, large enough to force drains while other threads finalize
+    for (const std::string algorithm : {"SHA256", "SHA512", "MD5"}) {
+        StreamMultiplexer mux(algorithm);
+        const size_t threadCount = 8;
+        std::vector<std::string> results(threadCount);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&mux, &results, t]() {
+                const std::vector<uint8_t> message = makeMessage(t, 200000 + t * 4099);
+                for (size_t round = 0; round < 3; ++round) {
+                    const auto id = mux.open();
+                    for (size_t offset = 0; offset < message.size(); offset += 65536) {
+                        mux.update(id, message.data() + offset, std::min<size_t>(65536, message.size() - offset));
+                    }
+                    results[t] = finalizeHex(mux, id);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (size_t t = 0; t < threadCount; ++t) {
+            EXPECT_EQ(results[t], referenceHash(algorithm, makeMessage(t, 200000 + t * 4099))) << algorithm << " " << t;
+        }
+        EXPECT_EQ(mux.getStreamCount(), 0u);
+    }
+}
+
+TEST(StreamMultiplexerTest, UnknownStream) {
+    StreamMultiplexer mux("SHA256");
+    uint8_t digest[32];
+    uint8_t byte = 0;
+    EXPECT_THROW(mux.update(42, &byte, 1), std::invalid_argument);
+    EXPECT_THROW(mux.finalize(42, digest), std::invalid_argument);
+
+    auto id = mux.open();
+    mux.finalize(id, digest);
+    EXPECT_THROW(mux.finalize(id, digest), std::invalid_argument);
+    EXPECT_THROW(StreamMultiplexer("unknown"), std::invalid_argument);
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+#include "tar_hash.h"
+#include "hash_base.h"
+#include "hash_factory.h"
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string digestOf(const std::string& algorithm, const std::string& data) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    hasher->finalize();
+    return hasher->getHash();
+}
+
+// Builds ustar archives in memory
+class TarBuilder {
+public:
+    void add(const std::string& name, const std::string& data, char type = '0',
+             const std::string& prefix = "") {
+        addHeader(name, data.size(), type, prefix);
+        archive_ += data;
+        archive_.append((TarHasher::BLOCK_SIZE - data.size() % TarHasher::BLOCK_SIZE) % TarHasher::BLOCK_SIZE, '\0');
+    }
+
+    // A header alone, declaring size bytes of data that the caller may or may not append
+    void addHeader(const std::string& name, uint64_t size, char type = '0', const std::string& prefix = "") {
+        std::string header(TarHasher::BLOCK_SIZE, '\0');
+        std::memcpy(&header[0], name.data(), std::min<size_t>(name.size(), 100));
+        std::snprintf(&header[100], 8, "%07o", 0644);
+        std::snprintf(&header[124], 12, "%011llo", static_cast<unsigned long long>(size));
+        header[156] = type;
+        std::memcpy(&header[257], "ustar\0" "00", 8);
+        std::memcpy(&header[345], prefix.data(), std::min<size_t>(prefix.size(), 155));
+        std::memset(&header[148], ' ', 8);
+        unsigned sum = 0;
+        for (unsigned char c : header) {
+            sum += c;
+        }
+        std::snprintf(&header[148], 8, "%06o", sum);
+        archive_ += header;
+    }
+
+    void addPax(const std::string& key, const std::string& value) {
+        // The length prefix counts its own digits
+        std::string body = " " + key + "=" + value + "\n";
+        size_t length = body.size() + 1;
+        while (std::to_string(length).size() + body.size() != length) {
+            ++length;
+        }
+        add("PaxHeader", std::to_string(length) + body, 'x');
+    }
+
+    std::string finish() {
+        return archive_ + std::string(TarHasher::BLOCK_SIZE * 2, '\0');
+    }
+
+private:
+    std::string archive_;
+};
+
+std::vector<TarMember> hashTar(const std::string& archive, TarHasher& hasher) {
+    std::istringstream input(archive);
+    std::vector<TarMember> members;
+    hasher.processStream(input, [&](const TarMember& member) { members.push_back(member); });
+    return members;
+}
+
+std::string hex(const TarMember& member) {
+    return HashBase::toHex(member.digest.data(), member.digest.size());
+}
+
+} // namespace
+
+TEST(TarHasherTest, RegularMembers) {
+    TarBuilder builder;
+    const std::string big(100000, 'q');
+    builder.add("dir/", "", '5');
+    builder.add("dir/a.txt", "hello\n");
+    builder.add("dir/empty", "");
+    builder.add("dir/big.bin", big);
+    builder.add("dir/link", "", '2');
+
+    TarHasher hasher("SHA256");
+    auto members = hashTar(builder.finish(), hasher);
+    ASSERT_EQ(members.size(), 3u);
+    EXPECT_EQ(members[0].path, "dir/a.txt");
+    EXPECT_EQ(hex(members[0]), digestOf("SHA256", "hello\n"));
+    EXPECT_EQ(members[1].path, "dir/empty");
+    EXPECT_EQ(hex(members[1]), digestOf("SHA256", ""));
+    EXPECT_EQ(members[2].size, big.size());
+    EXPECT_EQ(hex(members[2]), digestOf("SHA256", big));
+    EXPECT_EQ(hasher.getMemberCount(), 3u);
+}
+
+TEST(TarHasherTest, LongNames) {
+    const std::string longPath = std::string(120, 'p') + "/file";
+    TarBuilder builder;
+    builder.add("file1", "one", '0', "some/prefix");
+    builder.addPax("path", longPath);
+    builder.add("truncated-name", "two");
+    builder.add("././@LongLink", "gnu/long/name\0", 'L');
+    builder.add("ignored", "three");
+
+    TarHasher hasher("MD5");
+    auto members = hashTar(builder.finish(), hasher);
+    ASSERT_EQ(members.size(), 3u);
+    EXPECT_EQ(members[0].path, "some/prefix/file1");
+    EXPECT_EQ(members[1].path, longPath);
+    EXPECT_EQ(hex(members[1]), digestOf("MD5", "two"));
+    EXPECT_EQ(members[2].path, "gnu/long/name");
+    EXPECT_EQ(hex(members[2]), digestOf("MD5", "three"));
+}
+
+TEST(TarHasherTest, ArchiveDigestCoversWholeStream) {
+    TarBuilder builder;
+    builder.add("a", "alpha");
+    builder.add("b", std::string(3000, 'b'));
+    const std::string archive = builder.finish() + std::string(4096, '\0');
+
+    TarHasher hasher("SHA1", true);
+    auto members = hashTar(archive, hasher);
+    EXPECT_EQ(members.size(), 2u);
+    EXPECT_EQ(hasher.getArchiveHash(), digestOf("SHA1", archive));
+
+    TarHasher plain("SHA1");
+    hashTar(archive, plain);
+    EXPECT_THROW(plain.getArchiveHash(), std::runtime_error);
+}
+
+TEST(TarHasherTest, RejectsCorruptArchives) {
+    TarBuilder builder;
+    builder.add("a", std::string(2000, 'a'));
+    const std::string archive = builder.finish();
+
+    TarHasher hasher("SHA256");
+    // Truncated member data
+    EXPECT_THROW(hashTar(archive.substr(0, 1024), hasher), std::runtime_error);
+
+    // Corrupted header checksum
+    std::string corrupt = archive;
+    corrupt[0] = 'X';
+    EXPECT_THROW(hashTar(corrupt, hasher), std::runtime_error);
+
+    // An extended header declaring 8GiB is refused before anything is allocated
+    TarBuilder huge;
+    huge.addHeader("PaxHeader", 077777777777ULL, 'x');
+    try {
+        hashTar(huge.finish(), hasher);
+        ADD_FAILURE() << "Oversized extended header accepted";
+    } catch (const std::runtime_error& e) {
+        EXPECT_TRUE(std::string(e.what()).find("extended header size") != std::string::npos);
+    }
+    TarBuilder longName;
+    longName.addHeader("././@LongLink", TarHasher::MAX_EXTENDED_HEADER_SIZE + 1, 'L');
+    EXPECT_THROW(hashTar(longName.finish(), hasher), std::runtime_error);
+
+    EXPECT_THROW(TarHasher("NOPE"), std::invalid_argument);
+}
+
+TEST(TarHasherTest, EmptyInput) {
+    TarHasher hasher("SHA256", true);
+    EXPECT_TRUE(hashTar("", hasher).empty());
+    EXPECT_EQ(hasher.getArchiveHash(), digestOf("SHA256", ""));
+}
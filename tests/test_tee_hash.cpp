@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "tee_hash.h"
+#include "file_io.h"
+#include "test_util.h"
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using TestUtil::digestOf;
+using TestUtil::patternData;
+
+// Feeds data into a pipe on one thread and drains another pipe on a second
+class PipeHarness {
+public:
+    explicit PipeHarness(const std::string& data) : data_(data) {
+        EXPECT_EQ(::pipe(input_), 0);
+        EXPECT_EQ(::pipe(output_), 0);
+        writer_ = std::thread([this]() {
+            FileIO::writeAll(input_[1], reinterpret_cast<const uint8_t*>(data_.data()), data_.size());
+            ::close(input_[1]);
+        });
+        reader_ = std::thread([this]() {
+            uint8_t buffer[65536];
+            size_t got;
+            while ((got = FileIO::readSome(output_[0], buffer, sizeof(buffer))) > 0) {
+                received_.append(reinterpret_cast<const char*>(buffer), got);
+            }
+        });
+    }
+
+    int in() const { return input_[0]; }
+    int out() const { return output_[1]; }
+
+    // Close our ends and wait for both threads
+    std::string finish() {
+        ::close(output_[1]);
+        writer_.join();
+        reader_.join();
+        ::close(input_[0]);
+        ::close(output_[0]);
+        return received_;
+    }
+
+private:
+    std::string data_;
+    std::string received_;
+    int input_[2];
+    int output_[2];
+    std::thread writer_;
+    std::thread reader_;
+};
+
+} // namespace
+
+TEST(TeeHasherTest, PipeToPipe) {
+    const std::string data = patternData(3 * TeeHasher::BUFFER_SIZE + 12345);
+    PipeHarness pipes(data);
+    TeeHasher tee("SHA256");
+    tee.process(pipes.in(), pipes.out());
+    EXPECT_EQ(pipes.finish(), data);
+    EXPECT_EQ(tee.getHash(), digestOf("SHA256", data));
+    EXPECT_EQ(tee.getBytesForwarded(), data.size());
+#ifdef __linux__
+    EXPECT_TRUE(tee.isZeroCopy());
+#endif
+}
+
+TEST(TeeHasherTest, EmptyInput) {
+    PipeHarness pipes("");
+    TeeHasher tee("MD5");
+    tee.process(pipes.in(), pipes.out());
+    EXPECT_EQ(pipes.finish(), "");
+    EXPECT_EQ(tee.getHash(), "d41d8cd98f00b204e9800998ecf8427e");
+}
+
+TEST(TeeHasherTest, RegularFilesUseReadWrite) {
+    const std::string base = TestUtil::tempPath("tee_hash_");
+    const std::string inPath = base + ".in";
+    const std::string outPath = base + ".out";
+    const std::string data = patternData(700000);
+    TestUtil::writeFile(inPath, data);
+
+    int inFd = ::open(inPath.c_str(), O_RDONLY);
+    int outFd = ::open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    ASSERT_GE(inFd, 0);
+    ASSERT_GE(outFd, 0);
+    TeeHasher tee("SHA1");
+    tee.process(inFd, outFd);
+    ::close(inFd);
+    ::close(outFd);
+
+    EXPECT_EQ(TestUtil::readFile(outPath), data);
+    EXPECT_EQ(tee.getHash(), digestOf("SHA1", data));
+    EXPECT_FALSE(tee.isZeroCopy());
+
+    std::remove(inPath.c_str());
+    std::remove(outPath.c_str());
+}
+
+TEST(TeeHasherTest, InvalidUse) {
+    EXPECT_THROW(TeeHasher("NOPE"), std::invalid_argument);
+    TeeHasher tee("SHA256");
+    EXPECT_THROW(tee.getHash(), std::runtime_error);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "tree_hash.h"
+#include "hash_factory.h"
+#include "hash_base.h"
+#include "thread_pool.h"
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> digestOf(const std::string& algorithm, const std::string& data) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    hasher->finalize();
+    std::vector<uint8_t> digest(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return digest;
+}
+
+std::string leaf(const std::string& algorithm, const std::string& data) {
+    std::vector<uint8_t> d = digestOf(algorithm, std::string(1, '\x00') + data);
+    return std::string(d.begin(), d.end());
+}
+
+std::string node(const std::string& algorithm, const std::string& left, const std::string& right) {
+    std::vector<uint8_t> d = digestOf(algorithm, std::string(1, '\x01') + left + right);
+    return std::string(d.begin(), d.end());
+}
+
+std::string hex(const std::string& raw) {
+    return HashBase::toHex(reinterpret_cast<const uint8_t*>(raw.data()), raw.size());
+}
+
+std::string treeHash(const std::string& algorithm, const std::string& data, size_t leafSize, size_t threads) {
+    TreeHasher tree(algorithm, leafSize, threads);
+    std::istringstream input(data);
+    tree.processStream(input);
+    return tree.getHash();
+}
+
+} // namespace
+
+TEST(TreeHashTest, EmptyInputIsSingleEmptyLeaf) {
+    TreeHasher tree("sha256", 4, 2);
+    std::istringstream input("");
+    tree.processStream(input);
+    EXPECT_EQ(tree.getLeafCount(), 1u);
+    EXPECT_EQ(tree.getHash(), hex(leaf("sha256", "")));
+}
+
+TEST(TreeHashTest, SingleLeafIsRoot) {
+    EXPECT_EQ(treeHash("sha256", "abc", 4, 2), hex(leaf("sha256", "abc")));
+}
+
+// Documented layout: pairs combined bottom-up, unpaired node promoted unchanged
+TEST(TreeHashTest, MatchesDocumentedLayout) {
+    const std::string data = "aaaabbbbccccdddde";  // 5 leaves of 4 bytes, last one short
+    std::string a = leaf("sha256", "aaaa"), b = leaf("sha256", "bbbb"),
+                c = leaf("sha256", "cccc"), d = leaf("sha256", "dddd"), e = leaf("sha256", "e");
+    std::string expected = node("sha256", node("sha256", node("sha256", a, b), node("sha256", c, d)), e);
+    
+    TreeHasher tree("sha256", 4, 3);
+    std::istringstream input(data);
+    tree.processStream(input);
+    EXPECT_EQ(tree.getLeafCount(), 5u);
+    EXPECT_EQ(tree.getHash(), hex(expected));
+}
+
+TEST(TreeHashTest, LeafAndNodeDomainsAreSeparated) {
+    // A plain hash of the input must not equal the single-leaf root
+    std::vector<uint8_t> plain = digestOf("sha256", "abc");
+    EXPECT_NE(treeHash("sha256", "abc", 1024, 1), HashBase::toHex(plain.data(), plain.size()));
+}
+
+TEST(TreeHashTest, IndependentOfThreadCount) {
+    std::string data;
+    for (int i = 0; i < 100000; ++i) {
+        data += static_cast<char>(i * 31);
+    }
+    
+    for (const auto& algorithm : {"md5", "sha512/256", "blake512"}) {
+        std::string reference = treeHash(algorithm, data, 4096, 1);
+        EXPECT_EQ(treeHash(algorithm, data, 4096, 4), reference) << algorithm;
+        EXPECT_EQ(treeHash(algorithm, data, 4096, 7), reference) << algorithm;
+        EXPECT_NE(treeHash(algorithm, data, 8192, 4), reference) << algorithm;
+    }
+}
+
+TEST(TreeHashTest, InvalidParameters) {
+    EXPECT_THROW(TreeHasher("unknown", 1024), std::invalid_argument);
+    EXPECT_THROW(TreeHasher("sha256", 0), std::invalid_argument);
+    TreeHasher tree("sha256", 1024);
+    EXPECT_THROW(tree.getHash(), std::runtime_error);
+}
+
+TEST(ThreadPoolTest, RunsTasksAndPropagatesExceptions) {
+    ThreadPool pool(3);
+    EXPECT_EQ(pool.getThreadCount(), 3u);
+    
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 50; ++i) {
+        results.push_back(pool.submit([i]() { return i * i; }));
+    }
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(results[i].get(), i * i);
+    }
+    
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(failing.get(), std::runtime_error);
+}
@@ -0,0 +1,117 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <gtest/gtest.h>
+#include "hash_base.h"
+#include "hash_factory.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * Helpers shared by the test suites
+ */
+namespace TestUtil {
+
+// Per-process scratch path under the gtest temporary directory
+inline std::string tempPath(const std::string& name) {
+    return ::testing::TempDir() + name + std::to_string(::getpid());
+}
+
+// Deterministic, non-repeating bytes; different seeds give different data
+inline std::string patternData(size_t length, size_t seed = 0) {
+    std::string data(length, '\0');
+    for (size_t i = 0; i < length; ++i) {
+        data[i] = static_cast<char>(seed * 31 + i * 7 + (i >> 11));
+    }
+    return data;
+}
+
+inline void writeFile(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << data;
+}
+
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+inline std::vector<uint8_t> digestBytes(const std::string& algorithm, const std::string& data) {
+    auto hasher = HashFactory::createHash(algorithm);
+    hasher->update(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    hasher->finalize();
+    std::vector<uint8_t> digest(hasher->getHashSize());
+    hasher->getDigest(digest.data());
+    return digest;
+}
+
+inline std::string hexOf(const std::vector<uint8_t>& digest) {
+    return HashBase::toHex(digest.data(), digest.size());
+}
+
+// Hex digest of data
+inline std::string digestOf(const std::string& algorithm, const std::string& data) {
+    return hexOf(digestBytes(algorithm, data));
+}
+
+// A scratch directory tree removed in reverse creation order
+class ScratchTree {
+public:
+    explicit ScratchTree(const std::string& name) : root_(tempPath(name)) {
+        makeDirectory("");
+    }
+
+    ~ScratchTree() {
+        for (auto it = created_.rbegin(); it != created_.rend(); ++it) {
+            std::remove(it->c_str());
+        }
+    }
+
+    ScratchTree(const ScratchTree&) = delete;
+    ScratchTree& operator=(const ScratchTree&) = delete;
+
+    void makeDirectory(const std::string& name, mode_t mode = 0755) {
+        const std::string path = name.empty() ? root_ : root_ + "/" + name;
+        EXPECT_EQ(::mkdir(path.c_str(), mode), 0);
+        EXPECT_EQ(::chmod(path.c_str(), mode), 0);   // Regardless of the umask
+        created_.push_back(path);
+    }
+
+    std::string write(const std::string& name, const std::string& data, mode_t mode = 0644) {
+        const std::string path = root_ + "/" + name;
+        writeFile(path, data);
+        EXPECT_EQ(::chmod(path.c_str(), mode), 0);
+        created_.push_back(path);
+        return path;
+    }
+
+    std::string symlink(const std::string& target, const std::string& name) {
+        const std::string path = root_ + "/" + name;
+        EXPECT_EQ(::symlink(target.c_str(), path.c_str()), 0);
+        created_.push_back(path);
+        return path;
+    }
+
+    std::string link(const std::string& target, const std::string& name) {
+        const std::string path = root_ + "/" + name;
+        EXPECT_EQ(::link(target.c_str(), path.c_str()), 0);
+        created_.push_back(path);
+        return path;
+    }
+
+    const std::string& root() const { return root_; }
+
+private:
+    std::string root_;
+    std::vector<std::string> created_;
+};
+
+} // namespace TestUtil
+
+#endif // TEST_UTIL_H